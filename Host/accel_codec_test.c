@@ -0,0 +1,437 @@
+/* Test vectors, round trip and speed of Src/accel_codec.c, the delta and packed formats of the
+ * accelerometer notifications, and of the host unpacker of accel_unpack.c.
+ *
+ *   make -C Host codec
+ *
+ * The motion data is made in integers so the sample counts do not depend on the host: gravity turning
+ * slowly through the axes at 4096 counts per g, sensor noise of a few counts, and now and then a
+ * tap. Raw frames hold ACEL_SAMPLE_LEN bytes per sample; the delta frames must hold at least twice
+ * as many samples at the same length. Exits non-zero on any failure.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "accel_codec.h"
+#include "accel_unpack.h"
+
+#define TEST_FRAME_LEN      240                             // ACEL_VALUE_CHAR_MAX_LEN in Inc/ble_cus.h
+#define TEST_SAMPLE_LEN     6                               // ACEL_SAMPLE_LEN, raw
+#define TEST_RATE           400                             // GESTURE_SAMPLE_RATE, Hz
+#define TEST_SAMPLES        (TEST_RATE * 60)
+#define TEST_RUNS           20
+
+typedef struct
+{
+	char const *  name;
+	int16_t       samples[4][3];
+	uint8_t       count;
+	uint8_t       frame[16];
+	uint8_t       length;
+} test_vector_t;
+
+static const test_vector_t m_vectors[] =
+{
+	{
+		"small deltas",
+		{ { 100, -200, 4096 }, { 101, -200, 4094 }, { 99, -199, 4094 }, { 99, -199, 4094 } }, 4,
+		{ 0x64, 0x00, 0x38, 0xFF, 0x00, 0x10, 0x22, 0x22, 0xF2, 0x02, 0x00 }, 11,
+	},
+	{
+		"16-bit wrap",
+		{ { 32767, -32768, 0 }, { -32768, 32767, 0 } }, 2,
+		{ 0xFF, 0x7F, 0x00, 0x80, 0x00, 0x00, 0x12, 0x00, 0x06 }, 9,
+	},
+	{
+		"16-bit width",
+		{ { 0, 0, 0 }, { 16384, -16385, 1 } }, 2,
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x02, 0x00, 0x80, 0x01, 0x80, 0x02 }, 13,
+	},
+};
+
+static const test_vector_t m_packed_vectors[] =
+{
+	{
+		"packed 14",
+		{ { 1, -1, 8191 }, { -8192, 0, 4096 } }, 2,
+		{ 0x01, 0xC0, 0xFF, 0xFF, 0xFF, 0x01, 0x80, 0x00, 0x00, 0x00, 0x04 }, 11,
+	},
+	{
+		"packed 12",
+		{ { 1, -1, 8191 }, { -8192, 0, 4096 } }, 2,
+		{ 0x00, 0xF0, 0xFF, 0xFF, 0x07, 0x80, 0x00, 0x00, 0x40 }, 9,
+	},
+};
+
+static int16_t  m_samples[TEST_SAMPLES][3];
+static int16_t  m_decoded[TEST_SAMPLES][3];
+static uint32_t m_seed = 1;
+
+static int32_t noise(int32_t range)
+{
+	m_seed = m_seed * 1664525 + 1013904223;
+	return (int32_t)((m_seed >> 16) % (2 * range + 1)) - range;
+}
+
+/*@brief Integer cosine, 4096 at 0, one turn in 1024 steps, by the parabola approximation
+*/
+static int32_t icos(uint32_t phase)
+{
+	int32_t x = (int32_t)((phase + 256) & 1023) - 512;     // sine of phase + 90 degrees
+	int32_t y = (x * (512 - (x < 0 ? -x : x))) >> 4;       // 4 * x * (512 - |x|) / 512^2 * 4096
+
+	return -y;
+}
+
+static void motion_make(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < TEST_SAMPLES; i++)
+	{
+		// gravity turns through x and z once every 20 s
+		uint32_t phase = (uint32_t)((uint64_t)i * 1024 / (TEST_RATE * 20));
+		int32_t  tap   = ((i % (TEST_RATE * 3)) < 8) ? ((i % 2) ? -1500 : 2500) : 0;
+
+		m_samples[i][0] = (int16_t)(icos(phase) + noise(3) + tap);
+		m_samples[i][1] = (int16_t)(noise(3) - 20);
+		m_samples[i][2] = (int16_t)(icos(phase + 768) + noise(4));
+	}
+}
+
+static void full_range_make(int32_t range)
+{
+	uint32_t i;
+
+	for (i = 0; i < TEST_SAMPLES; i++)
+	{
+		m_samples[i][0] = (int16_t)noise(range);
+		m_samples[i][1] = (int16_t)noise(range);
+		m_samples[i][2] = (int16_t)noise(range);
+	}
+}
+
+static int vectors_check(void)
+{
+	int      failed = 0;
+	uint32_t v;
+
+	for (v = 0; v < sizeof(m_vectors) / sizeof(m_vectors[0]); v++)
+	{
+		test_vector_t const * p_vector = &m_vectors[v];
+		accel_codec_t codec;
+		uint8_t       frame[TEST_FRAME_LEN];
+		int16_t       decoded[4][3];
+		uint16_t      length;
+		uint8_t       i;
+
+		accel_codec_init(&codec, frame, sizeof(frame));
+		for (i = 0; i < p_vector->count; i++)
+		{
+			(void)accel_codec_put(&codec, p_vector->samples[i]);
+		}
+		length = accel_codec_flush(&codec);
+
+		if ((length != p_vector->length) || (memcmp(frame, p_vector->frame, length) != 0))
+		{
+			printf("vector %-14s encode FAILED:", p_vector->name);
+			for (i = 0; i < length; i++)
+			{
+				printf(" %02X", frame[i]);
+			}
+			printf("\n");
+			failed = 1;
+			continue;
+		}
+
+		if ((accel_codec_decode(p_vector->frame, p_vector->length, decoded, 4) != p_vector->count) ||
+		    (memcmp(decoded, p_vector->samples, p_vector->count * sizeof(decoded[0])) != 0))
+		{
+			printf("vector %-14s decode FAILED\n", p_vector->name);
+			failed = 1;
+			continue;
+		}
+		printf("vector %-14s ok\n", p_vector->name);
+	}
+	return failed;
+}
+
+static int packed_vectors_check(void)
+{
+	int      failed = 0;
+	uint32_t v;
+
+	for (v = 0; v < sizeof(m_packed_vectors) / sizeof(m_packed_vectors[0]); v++)
+	{
+		test_vector_t const * p_vector = &m_packed_vectors[v];
+		uint8_t       bits = (v == 0) ? 14 : 12;
+		uint8_t       frame[TEST_FRAME_LEN];
+		int16_t       unpacked[4][3];
+		uint16_t      length = 0;
+		int           wrong  = 0;
+		uint8_t       i, axis;
+
+		for (i = 0; i < p_vector->count; i++)
+		{
+			length = accel_codec_pack(p_vector->samples[i], bits, frame, i);
+		}
+
+		if ((length != p_vector->length) || (memcmp(frame, p_vector->frame, length) != 0))
+		{
+			printf("vector %-14s pack FAILED\n", p_vector->name);
+			failed = 1;
+			continue;
+		}
+
+		if (accel_codec_unpack(p_vector->frame, p_vector->length, bits, unpacked, 4) != p_vector->count)
+		{
+			printf("vector %-14s unpack FAILED\n", p_vector->name);
+			failed = 1;
+			continue;
+		}
+		for (i = 0; i < p_vector->count; i++)
+		{
+			for (axis = 0; axis < 3; axis++)
+			{
+				// the low bits a lower resolution drops come back as zeros
+				if (unpacked[i][axis] != (int16_t)(p_vector->samples[i][axis] & ~((1 << (14 - bits)) - 1)))
+				{
+					wrong = 1;
+				}
+			}
+		}
+		printf("vector %-14s %s\n", p_vector->name, wrong ? "unpack FAILED" : "ok");
+		failed |= wrong;
+	}
+	return failed;
+}
+
+/*@brief Pack every sample in frames of size bytes, unpack them with the firmware and the host code
+ *
+ * @return Samples per frame, 0 on a mismatch.
+*/
+static double packed_round_trip(uint16_t size, uint8_t bits, double * p_ns_ref, double * p_ns_word, double * p_ns_simd)
+{
+	static uint8_t  frames[TEST_SAMPLES][TEST_FRAME_LEN];
+	static uint16_t lengths[TEST_SAMPLES];
+	static int16_t  fast[TEST_SAMPLES][3];
+	uint16_t        per_frame = (uint16_t)((size * 8) / (3 * bits));
+	uint32_t        frame_count = (TEST_SAMPLES + per_frame - 1) / per_frame;
+	uint32_t        f, i, run;
+	int             path;
+	struct timespec t0, t1;
+
+	for (i = 0; i < TEST_SAMPLES; i++)
+	{
+		lengths[i / per_frame] = accel_codec_pack(m_samples[i], bits, frames[i / per_frame], (uint16_t)(i % per_frame));
+	}
+
+	for (f = 0, i = 0; f < frame_count; f++)
+	{
+		i += accel_codec_unpack(frames[f], lengths[f], bits, &m_decoded[i], TEST_SAMPLES - i);
+	}
+	for (i = 0; i < TEST_SAMPLES * 3; i++)
+	{
+		int16_t value = m_samples[i / 3][i % 3];
+
+		if (m_decoded[i / 3][i % 3] != (int16_t)(value & ~((1 << (14 - bits)) - 1)))
+		{
+			return 0;
+		}
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for (run = 0; run < TEST_RUNS; run++)
+	{
+		for (f = 0, i = 0; f < frame_count; f++)
+		{
+			i += accel_codec_unpack(frames[f], lengths[f], bits, &m_decoded[i], TEST_SAMPLES - i);
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	*p_ns_ref = ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / ((double)TEST_RUNS * TEST_SAMPLES);
+
+	if (bits != 14)
+	{
+		*p_ns_word = *p_ns_simd = 0.0;
+		return (double)per_frame;
+	}
+
+	// the host unpacker, the word path and the SSE4.1 path, against the firmware
+	for (path = 0; path < 2; path++)
+	{
+		double * p_ns = path ? p_ns_simd : p_ns_word;
+
+		memset(fast, 0, sizeof(fast));
+		clock_gettime(CLOCK_MONOTONIC, &t0);
+		for (run = 0; run < TEST_RUNS; run++)
+		{
+			for (f = 0, i = 0; f < frame_count; f++)
+			{
+				i += accel_unpack14(frames[f], lengths[f], fast[i], TEST_SAMPLES - i, path);
+			}
+		}
+		clock_gettime(CLOCK_MONOTONIC, &t1);
+		*p_ns = ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / ((double)TEST_RUNS * TEST_SAMPLES);
+
+		if ((i != TEST_SAMPLES) || (memcmp(fast, m_decoded, sizeof(fast)) != 0))
+		{
+			return 0;
+		}
+	}
+	return (double)per_frame;
+}
+
+/*@brief Encode every sample in frames of size bytes, decode them back
+ *
+ * @return Frames, 0 on a decode mismatch.
+*/
+static uint32_t round_trip(uint16_t size)
+{
+	static uint8_t frames[TEST_SAMPLES][TEST_FRAME_LEN];
+	static uint16_t lengths[TEST_SAMPLES];
+	accel_codec_t codec;
+	uint32_t      frame_count = 0;
+	uint32_t      decoded = 0;
+	uint32_t      i;
+
+	accel_codec_init(&codec, frames[0], size);
+	for (i = 0; i < TEST_SAMPLES; i++)
+	{
+		if (accel_codec_put(&codec, m_samples[i]))
+		{
+			lengths[frame_count++] = codec.length;
+			codec.p_frame = frames[frame_count];
+			accel_codec_next(&codec);
+		}
+	}
+	// the last samples may take two frames
+	while (accel_codec_flush(&codec) > 0)
+	{
+		lengths[frame_count++] = codec.length;
+		codec.p_frame = frames[frame_count];
+		accel_codec_next(&codec);
+	}
+
+	for (i = 0; i < frame_count; i++)
+	{
+		uint16_t count = accel_codec_decode(frames[i], lengths[i], &m_decoded[decoded], TEST_SAMPLES - decoded);
+
+		if ((count == 0) || (lengths[i] > size))
+		{
+			return 0;
+		}
+		decoded += count;
+	}
+
+	if ((decoded != TEST_SAMPLES) || (memcmp(m_decoded, m_samples, sizeof(m_samples)) != 0))
+	{
+		return 0;
+	}
+	return frame_count;
+}
+
+static double encode_ns(uint16_t size)
+{
+	static uint8_t  frame[TEST_FRAME_LEN];
+	accel_codec_t   codec;
+	struct timespec t0, t1;
+	uint32_t        run, i;
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for (run = 0; run < TEST_RUNS; run++)
+	{
+		accel_codec_init(&codec, frame, size);
+		for (i = 0; i < TEST_SAMPLES; i++)
+		{
+			if (accel_codec_put(&codec, m_samples[i]))
+			{
+				accel_codec_next(&codec);
+			}
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+
+	return ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / ((double)TEST_RUNS * TEST_SAMPLES);
+}
+
+int main(void)
+{
+	static const uint16_t sizes[] = { 20, 60, 120, TEST_FRAME_LEN };
+	int      failed = vectors_check() | packed_vectors_check();
+	uint32_t s;
+
+	printf("\ndelta %6s %8s %10s %10s %8s %10s\n", "frame", "raw", "motion", "gain", "worst", "ns/sample");
+	for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+	{
+		uint16_t size = sizes[s];
+		uint32_t raw  = size / TEST_SAMPLE_LEN;
+		uint32_t motion, full;
+		double   ns;
+
+		m_seed = 1;
+		motion_make();
+		motion = round_trip(size);
+		ns     = encode_ns(size);
+
+		// worst case: no two samples alike, the frames must still decode
+		full_range_make(32767);
+		full = round_trip(size);
+
+		if ((motion == 0) || (full == 0))
+		{
+			printf("%12u round trip FAILED\n", size);
+			failed = 1;
+			continue;
+		}
+
+		double per_frame = (double)TEST_SAMPLES / motion;
+		printf("%12u %8u %10.1f %9.2fx %8.1f %10.1f\n", size, raw, per_frame, per_frame / raw,
+		       (double)TEST_SAMPLES / full, ns);
+
+		// small frames spend more on the key sample, the gain is asked for full frames
+		if ((size == TEST_FRAME_LEN) && (per_frame < 2.0 * raw))
+		{
+			printf("%12u less than twice the raw samples per frame\n", size);
+			failed = 1;
+		}
+	}
+
+	printf("\npacked %5s %8s %10s %10s %10s %10s %10s\n", "bits", "raw", "samples", "gain", "ns ref", "ns word", "ns simd");
+	for (s = 12; s <= 14; s += 2)
+	{
+		double ns_ref, ns_word, ns_simd;
+		double per_frame;
+
+		// every 14-bit count first, then the motion data for the timing
+		full_range_make(8191);
+		per_frame = packed_round_trip(TEST_FRAME_LEN, (uint8_t)s, &ns_ref, &ns_word, &ns_simd);
+		m_seed = 1;
+		motion_make();
+		if (per_frame > 0)
+		{
+			per_frame = packed_round_trip(TEST_FRAME_LEN, (uint8_t)s, &ns_ref, &ns_word, &ns_simd);
+		}
+
+		if (per_frame == 0)
+		{
+			printf("%12u round trip FAILED\n", s);
+			failed = 1;
+			continue;
+		}
+		printf("%12u %8u %10.0f %9.2fx %10.1f", s, TEST_FRAME_LEN / TEST_SAMPLE_LEN, per_frame,
+		       per_frame / (TEST_FRAME_LEN / TEST_SAMPLE_LEN), ns_ref);
+		if (s == 14)
+		{
+			printf(" %10.1f %10.1f\n", ns_word, ns_simd);
+		}
+		else
+		{
+			printf(" %10s %10s\n", "-", "-");
+		}
+	}
+
+	return failed;
+}
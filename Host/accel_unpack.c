@@ -0,0 +1,104 @@
+#include <string.h>
+
+#include "accel_unpack.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define UNPACK_SSE41    1
+#endif
+
+#define UNPACK_BITS     14
+
+static inline uint32_t unpack_min(uint32_t a, uint32_t b)
+{
+	return (a < b) ? a : b;
+}
+
+/*@brief 4 values from the 7 bytes at p_in, reads 8
+*/
+static inline void word_unpack(uint8_t const * p_in, int16_t * p_out)
+{
+	uint64_t word;
+
+	memcpy(&word, p_in, sizeof(word));                      // little endian host
+	p_out[0] = (int16_t)((int64_t)(word << 50) >> 50);
+	p_out[1] = (int16_t)((int64_t)(word << 36) >> 50);
+	p_out[2] = (int16_t)((int64_t)(word << 22) >> 50);
+	p_out[3] = (int16_t)((int64_t)(word <<  8) >> 50);
+}
+
+#ifdef UNPACK_SSE41
+/*@brief 8 values from the 14 bytes at p_in, reads 16
+ *
+ * Each value is gathered with the two bytes after it into a 32-bit lane, lifted to bit 6 by a
+ * multiply (there is no per-lane shift before AVX2), then shifted up to the sign and back.
+*/
+__attribute__((target("sse4.1")))
+static uint32_t sse41_unpack(uint8_t const * p_in, uint32_t steps, int16_t * p_out)
+{
+	const __m128i lo   = _mm_setr_epi8(0, 1, 2, -1, 1, 2, 3, -1, 3, 4, 5, -1, 5, 6, 7, -1);
+	const __m128i hi   = _mm_setr_epi8(7, 8, 9, -1, 8, 9, 10, -1, 10, 11, 12, -1, 12, 13, -1, -1);
+	const __m128i lift = _mm_setr_epi32(64, 1, 4, 16);      // bit offsets 0, 6, 4, 2
+	uint32_t      i;
+
+	for (i = 0; i < steps; i++)
+	{
+		__m128i in = _mm_loadu_si128((__m128i const *)p_in);
+		__m128i a  = _mm_mullo_epi32(_mm_shuffle_epi8(in, lo), lift);
+		__m128i b  = _mm_mullo_epi32(_mm_shuffle_epi8(in, hi), lift);
+
+		a = _mm_srai_epi32(_mm_slli_epi32(a, 32 - 6 - UNPACK_BITS), 32 - UNPACK_BITS);
+		b = _mm_srai_epi32(_mm_slli_epi32(b, 32 - 6 - UNPACK_BITS), 32 - UNPACK_BITS);
+		_mm_storeu_si128((__m128i *)p_out, _mm_packs_epi32(a, b));
+
+		p_in  += 14;
+		p_out += 8;
+	}
+	return steps * 8;
+}
+#endif
+
+uint16_t accel_unpack14(uint8_t const * p_frame, uint16_t length, int16_t * p_out, uint16_t max, int simd)
+{
+	uint16_t count  = (uint16_t)(((uint32_t)length * 8) / (3 * UNPACK_BITS));
+	uint32_t values = (uint32_t)count * 3;
+	uint32_t done   = 0;
+
+	if (count > max)
+	{
+		return 0;
+	}
+
+#ifdef UNPACK_SSE41
+	// whole 14-byte steps with the 2 bytes after them still in the frame
+	if (simd && __builtin_cpu_supports("sse4.1") && (length >= 16))
+	{
+		done = sse41_unpack(p_frame, unpack_min(values / 8, (uint32_t)(length - 16) / 14 + 1), p_out);
+	}
+#else
+	(void)simd;
+#endif
+
+	while ((done + 4 <= values) && ((done / 4) * 7 + 8 <= length))
+	{
+		word_unpack(&p_frame[(done / 4) * 7], &p_out[done]);
+		done += 4;
+	}
+
+	// the last values one bit at a time, the word would read past the frame
+	for (; done < values; done++)
+	{
+		uint32_t bit  = done * UNPACK_BITS;
+		uint32_t word = 0;
+		uint32_t i;
+
+		for (i = bit >> 3; (i < length) && (i <= (bit + UNPACK_BITS - 1) >> 3); i++)
+		{
+			word |= (uint32_t)p_frame[i] << (8 * (i - (bit >> 3)));
+		}
+		word        = (word >> (bit & 7)) << (32 - UNPACK_BITS);
+		p_out[done] = (int16_t)((int32_t)word >> (32 - UNPACK_BITS));
+	}
+
+	return count;
+}
@@ -0,0 +1,18 @@
+/* Unpacker of the 14-bit packed accelerometer frames of Inc/accel_codec.h for the receiving side,
+ * a 7-byte word of 4 values at a time, 8 values per SSE4.1 step where the host has it.
+ */
+#ifndef ACCEL_UNPACK_H__
+#define ACCEL_UNPACK_H__
+
+#include <stdint.h>
+
+/*@brief Unpack a 14-bit frame, same result as accel_codec_unpack(p_frame, length, 14, ...)
+ *
+ * @param[out] p_out  3 values per sample, x, y, z.
+ * @param[in]  simd   0 to stay on the 64-bit word path.
+ *
+ * @return Samples unpacked, 0 if there are more than max.
+*/
+uint16_t accel_unpack14(uint8_t const * p_frame, uint16_t length, int16_t * p_out, uint16_t max, int simd);
+
+#endif /* ACCEL_UNPACK_H__ */
@@ -0,0 +1,93 @@
+/* Generates Inc/resampler_taps.h, the polyphase filter bank of Src/resampler.c.
+ *
+ *   make -C Host taps
+ *
+ * Every filter is a Kaiser windowed sinc. Row p is the filter for an output sample p / PHASES of an
+ * input sample after the base sample, row PHASES is row 0 moved by one sample so the rounded phase
+ * never has to carry into the base index. Each row is scaled to a DC gain of exactly 1 << COEF_SHIFT.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#include "resampler.h"
+
+#define KAISER_BETA     6.0
+#define PASSBAND        0.90                                // of the filter's Nyquist
+
+static double bessel_i0(double x)
+{
+	double sum  = 1.0;
+	double term = 1.0;
+	int    k;
+
+	for (k = 1; k < 32; k++)
+	{
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum  += term;
+	}
+	return sum;
+}
+
+static void filter_print(char const * p_name, double cutoff)
+{
+	int p, j;
+
+	printf("static const int16_t %s[RESAMPLER_PHASES + 1][RESAMPLER_TAPS] =\n{\n", p_name);
+
+	for (p = 0; p <= RESAMPLER_PHASES; p++)
+	{
+		double  h[RESAMPLER_TAPS];
+		int16_t q[RESAMPLER_TAPS];
+		double  sum = 0.0;
+		int32_t total = 0;
+		int     center = 0;
+
+		for (j = 0; j < RESAMPLER_TAPS; j++)
+		{
+			// tap j reads input sample base + j - (TAPS / 2 - 1)
+			double x = (double)(j - (RESAMPLER_TAPS / 2 - 1)) - (double)p / RESAMPLER_PHASES;
+			double w = x / (RESAMPLER_TAPS / 2);
+			double s = (x == 0.0) ? 1.0 : sin(M_PI * cutoff * x) / (M_PI * cutoff * x);
+
+			h[j] = (fabs(w) >= 1.0) ? 0.0 : s * bessel_i0(KAISER_BETA * sqrt(1.0 - w * w)) / bessel_i0(KAISER_BETA);
+			sum += h[j];
+		}
+
+		for (j = 0; j < RESAMPLER_TAPS; j++)
+		{
+			q[j]   = (int16_t)lrint(h[j] / sum * (1 << RESAMPLER_COEF_SHIFT));
+			total += q[j];
+			if (fabs(h[j]) > fabs(h[center]))
+			{
+				center = j;
+			}
+		}
+
+		// rounding error goes to the largest tap so DC passes unchanged
+		q[center] += (int16_t)((1 << RESAMPLER_COEF_SHIFT) - total);
+
+		printf("\t{");
+		for (j = 0; j < RESAMPLER_TAPS; j++)
+		{
+			printf("%6d%s", q[j], (j < RESAMPLER_TAPS - 1) ? "," : "");
+		}
+		printf(" },\n");
+	}
+
+	printf("};\n\n");
+}
+
+int main(void)
+{
+	printf("#pragma once\n\n");
+	printf("/* Generated by Host/gen_resampler_taps.c, do not edit.\n");
+	printf(" * Kaiser beta %.1f, %d phases, %d taps, q%d.\n */\n\n",
+	       KAISER_BETA, RESAMPLER_PHASES, RESAMPLER_TAPS, RESAMPLER_COEF_SHIFT);
+	printf("#include <stdint.h>\n\n");
+
+	filter_print("resampler_taps_up", PASSBAND);
+	filter_print("resampler_taps_down2", PASSBAND / RESAMPLER_RATIO_MAX);
+
+	return 0;
+}
@@ -0,0 +1,164 @@
+/* Renders the built-in clips through Src/output_dsp.c with the default settings and writes WAV
+ * files to compare with what reached the amplifier before the post-mix stage.
+ *
+ *   make -C Host render
+ *
+ * For every case <name>_raw.wav is the mix saturated to 16 bits, <name>_out.wav is the mix after
+ * the speaker high-pass and the limiter. Clipped samples, peaks, the deepest gain reduction and the
+ * time per sample of the stage are printed.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "output_dsp.h"
+#include "sounds.h"
+#include "wav.h"
+
+#define RENDER_RATE     23810                               // I2S_SAMPLE_RATE in Inc/I2S.h
+#define RENDER_BUFFER   96                                  // I2S_BUFFER_SAMPLES in Inc/I2S.h
+#define RENDER_RUNS     50
+
+typedef struct
+{
+	char const * name;
+	int32_t *    p_mix;
+	uint32_t     length;
+} render_case_t;
+
+/*@brief Mix of clips at the given sample offsets, as the mixer adds unity gain voices
+*/
+static int32_t * mix_make(uint32_t length, int16_t const * p_a, uint32_t a_length, int16_t const * p_b,
+                          uint32_t b_length, uint32_t b_offset)
+{
+	int32_t * p_mix = calloc(length, sizeof(int32_t));
+	uint32_t  i;
+
+	for (i = 0; i < a_length && i < length; i++)
+	{
+		p_mix[i] += p_a[i];
+	}
+	for (i = 0; (p_b != NULL) && (i < b_length) && (b_offset + i < length); i++)
+	{
+		p_mix[b_offset + i] += p_b[i];
+	}
+	return p_mix;
+}
+
+/*@brief Low tone the speaker cannot play on top of a 1 kHz tone, 90% of full scale
+*/
+static int32_t * tone_make(uint32_t length)
+{
+	int32_t * p_mix = malloc(length * sizeof(int32_t));
+	uint32_t  i;
+
+	for (i = 0; i < length; i++)
+	{
+		p_mix[i] = (int32_t)lrint(14745.0 * sin(2.0 * M_PI * 60.0 * i / RENDER_RATE) +
+		                          14745.0 * sin(2.0 * M_PI * 1000.0 * i / RENDER_RATE));
+	}
+	return p_mix;
+}
+
+static uint32_t peak_get(int32_t const * p_data, uint32_t length)
+{
+	uint32_t peak = 0;
+	uint32_t i;
+
+	for (i = 0; i < length; i++)
+	{
+		uint32_t mag = (uint32_t)abs(p_data[i]);
+
+		peak = (mag > peak) ? mag : peak;
+	}
+	return peak;
+}
+
+static void case_render(render_case_t const * p_case)
+{
+	uint32_t  length  = (p_case->length / RENDER_BUFFER) * RENDER_BUFFER;
+	int32_t * p_work  = malloc(length * sizeof(int32_t));
+	int16_t * p_raw   = malloc(length * sizeof(int16_t));
+	int16_t * p_out   = malloc(length * sizeof(int16_t));
+	uint32_t  clipped = 0;
+	uint32_t  peak_out;
+	uint32_t  gain_min;
+	uint32_t  i;
+	uint32_t  run;
+	char      name[64];
+	clock_t   start;
+	double    ns;
+
+	for (i = 0; i < length; i++)
+	{
+		int32_t x = p_case->p_mix[i];
+
+		clipped += (x > 32767) || (x < -32768);
+		p_raw[i] = (int16_t)((x > 32767) ? 32767 : ((x < -32768) ? -32768 : x));
+	}
+
+	output_dsp_init(RENDER_RATE);
+	memcpy(p_work, p_case->p_mix, length * sizeof(int32_t));
+	for (i = 0; i < length; i += RENDER_BUFFER)
+	{
+		output_dsp_process(&p_work[i], RENDER_BUFFER);
+	}
+	gain_min = output_dsp_gain_min_get();
+	peak_out = peak_get(p_work, length);
+
+	for (i = 0; i < length; i++)
+	{
+		p_out[i] = (int16_t)p_work[i];
+	}
+
+	start = clock();
+	for (run = 0; run < RENDER_RUNS; run++)
+	{
+		memcpy(p_work, p_case->p_mix, length * sizeof(int32_t));
+		for (i = 0; i < length; i += RENDER_BUFFER)
+		{
+			output_dsp_process(&p_work[i], RENDER_BUFFER);
+		}
+	}
+	ns = 1e9 * (double)(clock() - start) / CLOCKS_PER_SEC / ((double)length * RENDER_RUNS);
+
+	printf("%-14s %7u samples  mix peak %6u  clipped %5u  out peak %5u  limiter gain min %5.2f dB  %5.1f ns/sample\n",
+	       p_case->name, length, peak_get(p_case->p_mix, length), clipped, peak_out,
+	       20.0 * log10(gain_min / 65536.0), ns);
+
+	snprintf(name, sizeof(name), "%s_raw.wav", p_case->name);
+	wav_write(name, p_raw, length, RENDER_RATE);
+	snprintf(name, sizeof(name), "%s_out.wav", p_case->name);
+	wav_write(name, p_out, length, RENDER_RATE);
+
+	free(p_work);
+	free(p_raw);
+	free(p_out);
+}
+
+int main(void)
+{
+	int16_t const * p_claves = sine_claves;
+	int16_t const * p_cuica  = sine_cuica;
+	uint32_t        claves   = sizeof(sine_claves) / sizeof(sine_claves[0]);
+	uint32_t        cuica    = sizeof(sine_cuica) / sizeof(sine_cuica[0]);
+	uint32_t        both     = (claves > cuica) ? claves : cuica;
+	render_case_t   cases[]  =
+	{
+		{ "claves",       mix_make(claves, p_claves, claves, NULL, 0, 0),          claves },
+		{ "cuica",        mix_make(cuica, p_cuica, cuica, NULL, 0, 0),             cuica  },
+		{ "claves_cuica", mix_make(both, p_claves, claves, p_cuica, cuica, 2000),  both   },
+		{ "tone_60_1k",   tone_make(RENDER_RATE),                                  RENDER_RATE },
+	};
+	uint32_t        i;
+
+	for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+	{
+		case_render(&cases[i]);
+		free(cases[i].p_mix);
+	}
+	return 0;
+}
@@ -0,0 +1,161 @@
+/* Quality and speed of Src/resampler.c for every asset rate, converted to the I2S rate.
+ *
+ *   make -C Host bench
+ *
+ * Quality is THD+N of a converted tone: the output is fitted with a sine of the tone frequency and
+ * everything that is left (aliases, images, rounding) counts as noise. Tones above the output
+ * Nyquist must be removed, their level after conversion is printed as the rejection.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "resampler.h"
+
+#define BENCH_RATE_OUT  23810                               // I2S_SAMPLE_RATE in Inc/I2S.h
+#define BENCH_SECONDS   2
+#define BENCH_SKIP      64                                  // output samples left out at each end
+#define BENCH_RUNS      20
+
+static const uint32_t m_rates[] = { 8000, 11025, 16000, 22050, 44100 };
+
+static int16_t * tone_make(uint32_t rate, double frequency, uint32_t length)
+{
+	int16_t * p_data = malloc(length * sizeof(int16_t));
+	uint32_t  i;
+
+	for (i = 0; i < length; i++)
+	{
+		p_data[i] = (int16_t)lrint(16384.0 * sin(2.0 * M_PI * frequency * i / rate));
+	}
+	return p_data;
+}
+
+/*@brief Level of what is left after removing the best fitting sine, dB relative to that sine
+ *
+ * @param[in] cycles   Tone cycles per output sample, from the converter's own q16 step.
+*/
+static double thdn_db(int16_t const * p_out, uint32_t count, double cycles, double * p_level)
+{
+	double ss = 0.0, sc = 0.0, cc = 0.0, ys = 0.0, yc = 0.0;
+	double noise = 0.0, signal;
+	uint32_t i;
+
+	for (i = BENCH_SKIP; i < count - BENCH_SKIP; i++)
+	{
+		double s = sin(2.0 * M_PI * cycles * i);
+		double c = cos(2.0 * M_PI * cycles * i);
+
+		ss += s * s;
+		sc += s * c;
+		cc += c * c;
+		ys += p_out[i] * s;
+		yc += p_out[i] * c;
+	}
+
+	double det = ss * cc - sc * sc;
+	double a   = (ys * cc - yc * sc) / det;
+	double b   = (yc * ss - ys * sc) / det;
+
+	for (i = BENCH_SKIP; i < count - BENCH_SKIP; i++)
+	{
+		double e = p_out[i] - a * sin(2.0 * M_PI * cycles * i) - b * cos(2.0 * M_PI * cycles * i);
+		noise += e * e;
+	}
+
+	signal   = (a * a + b * b) / 2.0 * (count - 2 * BENCH_SKIP);
+	*p_level = 20.0 * log10(sqrt(a * a + b * b) / 16384.0);
+
+	return 10.0 * log10(noise / signal);
+}
+
+static double rms_db(int16_t const * p_out, uint32_t count)
+{
+	double   sum = 0.0;
+	uint32_t i;
+
+	for (i = BENCH_SKIP; i < count - BENCH_SKIP; i++)
+	{
+		sum += (double)p_out[i] * p_out[i];
+	}
+	return 10.0 * log10(sum / (count - 2 * BENCH_SKIP) / (16384.0 * 16384.0 / 2.0) + 1e-20);
+}
+
+static resampler_t m_rs;
+
+static uint32_t convert(uint32_t rate, int16_t const * p_in, uint32_t length, int16_t * p_out, uint32_t size)
+{
+	resampler_t rs;
+
+	if (!resampler_init(&rs, rate, BENCH_RATE_OUT))
+	{
+		fprintf(stderr, "%u Hz not supported\n", rate);
+		exit(1);
+	}
+	m_rs = rs;
+	return resampler_process(&rs, p_in, length, p_out, size);
+}
+
+int main(void)
+{
+	uint32_t r;
+
+	printf("output %u Hz, %d taps, %d phases\n\n", BENCH_RATE_OUT, RESAMPLER_TAPS, RESAMPLER_PHASES);
+	printf("%8s %12s %12s %12s %14s %10s\n", "input", "1k THD+N", "0.4fs THD+N", "1k gain", "rejection", "ns/sample");
+
+	for (r = 0; r < sizeof(m_rates) / sizeof(m_rates[0]); r++)
+	{
+		uint32_t  rate    = m_rates[r];
+		uint32_t  length  = rate * BENCH_SECONDS;
+		uint32_t  size    = BENCH_RATE_OUT * BENCH_SECONDS + 16;
+		int16_t * p_out   = malloc(size * sizeof(int16_t));
+		double    high    = 0.4 * ((rate < BENCH_RATE_OUT) ? rate : BENCH_RATE_OUT);
+		double    level, level_high;
+		double    thdn_1k, thdn_high, rejection = NAN;
+		uint32_t  count, run;
+		struct timespec t0, t1;
+
+		int16_t * p_tone = tone_make(rate, 1000.0, length);
+		count   = convert(rate, p_tone, length, p_out, size);
+		thdn_1k = thdn_db(p_out, count, 1000.0 * m_rs.step / 65536.0 / rate, &level);
+
+		clock_gettime(CLOCK_MONOTONIC, &t0);
+		for (run = 0; run < BENCH_RUNS; run++)
+		{
+			convert(rate, p_tone, length, p_out, size);
+		}
+		clock_gettime(CLOCK_MONOTONIC, &t1);
+		free(p_tone);
+
+		p_tone    = tone_make(rate, high, length);
+		count     = convert(rate, p_tone, length, p_out, size);
+		thdn_high = thdn_db(p_out, count, high * m_rs.step / 65536.0 / rate, &level_high);
+		free(p_tone);
+
+		// a tone the output cannot carry, only for rates above the output rate
+		if (rate > BENCH_RATE_OUT)
+		{
+			p_tone    = tone_make(rate, 0.4 * rate, length);
+			count     = convert(rate, p_tone, length, p_out, size);
+			rejection = rms_db(p_out, count);
+			free(p_tone);
+		}
+
+		double ns = ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / ((double)BENCH_RUNS * count);
+
+		printf("%8u %9.1f dB %9.1f dB %9.2f dB ", rate, thdn_1k, thdn_high, level);
+		if (isnan(rejection))
+		{
+			printf("%14s %10.1f\n", "-", ns);
+		}
+		else
+		{
+			printf("%11.1f dB %10.1f\n", rejection, ns);
+		}
+		free(p_out);
+	}
+
+	return 0;
+}
@@ -0,0 +1,13 @@
+/* Host stand-in for the app_timer counter, the RTC runs on the simulated output time. */
+#ifndef APP_TIMER_H__
+#define APP_TIMER_H__
+
+#include <stdint.h>
+
+#define APP_TIMER_CLOCK_FREQ        16384                   // APP_TIMER_CONFIG_RTC_FREQUENCY 1 in sdk_config.h
+#define APP_TIMER_TICKS(MS)         ((uint32_t)(((uint64_t)(MS) * APP_TIMER_CLOCK_FREQ) / 1000))
+
+uint32_t app_timer_cnt_get(void);
+uint32_t app_timer_cnt_diff_compute(uint32_t ticks_to, uint32_t ticks_from);
+
+#endif // APP_TIMER_H__
@@ -0,0 +1,11 @@
+/* Host stand-in, see nrf.h for why the critical regions are empty. */
+#ifndef APP_UTIL_PLATFORM_H__
+#define APP_UTIL_PLATFORM_H__
+
+#define APP_IRQ_PRIORITY_HIGH       2
+#define APP_IRQ_PRIORITY_LOW        6
+
+#define CRITICAL_REGION_ENTER()     {
+#define CRITICAL_REGION_EXIT()      }
+
+#endif // APP_UTIL_PLATFORM_H__
@@ -0,0 +1,245 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "i2s_sim.h"
+#include "nrf.h"
+#include "app_timer.h"
+#include "nordic_common.h"
+#include "I2S.h"
+
+#define SIM_CPU_HZ          64000000ULL                     // cycle counter rate
+#define SIM_RTC_MASK        0x00FFFFFF                      // 24-bit RTC counter
+
+void I2S_IRQHandler(void);                                  // Src/I2S.c, in the vector table on the device
+
+typedef struct
+{
+	int16_t const *    p_data;
+	uint32_t           length;
+	clip_store_info_t  info;
+} sim_clip_t;
+
+NRF_I2S_Type   i2s_sim_regs;
+DWT_Type       i2s_sim_dwt;
+CoreDebug_Type i2s_sim_coredebug;
+
+static uint32_t        m_time;                              // output samples
+static bool            m_running;                           // started, the EasyDMA is reading
+static int16_t *       m_latched;                           // copy of the buffer being sent
+static uint32_t        m_latched_len;
+static uint32_t        m_latched_pos;
+static int16_t *       m_output;
+static uint32_t        m_output_len;
+static uint32_t        m_output_size;
+static i2s_sim_stats_t m_stats;
+static sim_clip_t      m_clips[CLIP_STORE_ID_LAST + 1];
+
+uint32_t app_timer_cnt_get(void)
+{
+	return (uint32_t)(((uint64_t)m_time * APP_TIMER_CLOCK_FREQ) / I2S_SAMPLE_RATE) & SIM_RTC_MASK;
+}
+
+uint32_t app_timer_cnt_diff_compute(uint32_t ticks_to, uint32_t ticks_from)
+{
+	return (ticks_to - ticks_from) & SIM_RTC_MASK;
+}
+
+bool clip_store_find(uint8_t clip_id, int16_t const ** pp_data, uint32_t * p_length, clip_store_info_t * p_info)
+{
+	if ((clip_id < CLIP_STORE_ID_FIRST) || (clip_id > CLIP_STORE_ID_LAST) || (m_clips[clip_id].p_data == NULL))
+	{
+		return false;
+	}
+
+	*pp_data  = m_clips[clip_id].p_data;
+	*p_length = m_clips[clip_id].length;
+	*p_info   = m_clips[clip_id].info;
+
+	return true;
+}
+
+void i2s_sim_clip_add(uint8_t clip_id, int16_t const * p_data, uint32_t length, clip_store_info_t const * p_info)
+{
+	if ((clip_id >= CLIP_STORE_ID_FIRST) && (clip_id <= CLIP_STORE_ID_LAST))
+	{
+		m_clips[clip_id].p_data = p_data;
+		m_clips[clip_id].length = length;
+		m_clips[clip_id].info   = *p_info;
+	}
+}
+
+/*@brief Cycle counter at the current output position
+*/
+static void clocks_update(void)
+{
+	i2s_sim_dwt.CYCCNT = (uint32_t)(((uint64_t)m_time * SIM_CPU_HZ) / I2S_SAMPLE_RATE);
+}
+
+static void output_put(int16_t const * p_data, uint32_t count)
+{
+	if (m_output_len + count > m_output_size)
+	{
+		m_output_size = (m_output_len + count) * 2;
+		m_output      = realloc(m_output, m_output_size * sizeof(int16_t));
+		if (m_output == NULL)
+		{
+			perror("i2s_sim");
+			exit(1);
+		}
+	}
+
+	if (p_data != NULL)
+	{
+		memcpy(&m_output[m_output_len], p_data, count * sizeof(int16_t));
+	}
+	else
+	{
+		memset(&m_output[m_output_len], 0, count * sizeof(int16_t));
+	}
+	m_output_len += count;
+}
+
+/*@brief Interrupt of an enabled event, then one pass of the main loop
+*/
+static void irq_take(uint32_t mask)
+{
+	struct timespec start;
+	struct timespec end;
+
+	if ((i2s_sim_regs.INTENSET & mask) == 0)
+	{
+		return;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	I2S_IRQHandler();
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	m_stats.interrupts++;
+	m_stats.irq_ns += (uint64_t)(end.tv_sec - start.tv_sec) * 1000000000ULL + (uint64_t)(end.tv_nsec - start.tv_nsec);
+
+	sound_process();
+}
+
+/*@brief EasyDMA takes the buffer at TXD.PTR, the words are sent from here on
+*/
+static void buffer_latch(void)
+{
+	uint32_t const * p_words = (uint32_t const *)(uintptr_t)i2s_sim_regs.TXD.PTR;
+	uint32_t         words   = i2s_sim_regs.RXTXD.MAXCNT;
+	uint32_t         i;
+
+	m_latched     = realloc(m_latched, words * 2 * sizeof(int16_t));
+	m_latched_len = words * 2;
+	m_latched_pos = 0;
+
+	// left in the low half-word, sent first
+	for (i = 0; i < words; i++)
+	{
+		m_latched[2 * i]     = (int16_t)(p_words[i] & 0xFFFF);
+		m_latched[2 * i + 1] = (int16_t)(p_words[i] >> 16);
+	}
+
+	m_stats.buffers++;
+	i2s_sim_regs.EVENTS_TXPTRUPD = 1;
+	irq_take(I2S_INTENSET_TXPTRUPD_Msk);
+}
+
+/*@brief Tasks written by the firmware since the last look
+*/
+static void tasks_run(void)
+{
+	if (i2s_sim_regs.TASKS_STOP)
+	{
+		i2s_sim_regs.TASKS_STOP = 0;
+		if (m_running)
+		{
+			m_running = false;
+			i2s_sim_regs.EVENTS_STOPPED = 1;
+			irq_take(I2S_INTENSET_STOPPED_Msk);
+		}
+	}
+
+	if (i2s_sim_regs.TASKS_START)
+	{
+		i2s_sim_regs.TASKS_START = 0;
+		if (!m_running && (i2s_sim_regs.ENABLE != 0))
+		{
+			m_running = true;
+			buffer_latch();
+		}
+	}
+}
+
+void i2s_sim_init(void)
+{
+	static uint32_t probe;
+
+	if ((uintptr_t)&probe > UINT32_MAX)
+	{
+		fprintf(stderr, "i2s_sim: static data above 4 GB, TXD.PTR cannot hold it, link with -no-pie\n");
+		exit(1);
+	}
+
+	memset(&i2s_sim_regs, 0, sizeof(i2s_sim_regs));
+	memset(&m_stats, 0, sizeof(m_stats));
+	m_time        = 0;
+	m_running     = false;
+	m_latched_len = 0;
+	m_latched_pos = 0;
+	m_output_len  = 0;
+	clocks_update();
+}
+
+void i2s_sim_run(uint32_t sample)
+{
+	tasks_run();
+
+	while (m_time < sample)
+	{
+		uint32_t count = sample - m_time;
+
+		if (m_running)
+		{
+			count = MIN(count, m_latched_len - m_latched_pos);
+			output_put(&m_latched[m_latched_pos], count);
+			m_latched_pos             += count;
+			m_stats.streaming_samples += count;
+		}
+		else
+		{
+			output_put(NULL, count);
+		}
+
+		if (i2s_sim_regs.ENABLE != 0)
+		{
+			m_stats.enabled_samples += count;
+		}
+
+		m_time += count;
+		clocks_update();
+
+		if (m_running && (m_latched_pos == m_latched_len))
+		{
+			buffer_latch();
+		}
+		tasks_run();
+	}
+}
+
+uint32_t i2s_sim_time_get(void)
+{
+	return m_time;
+}
+
+int16_t const * i2s_sim_output_get(uint32_t * p_length)
+{
+	*p_length = m_output_len;
+	return m_output;
+}
+
+void i2s_sim_stats_get(i2s_sim_stats_t * p_stats)
+{
+	*p_stats = m_stats;
+}
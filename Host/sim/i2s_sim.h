@@ -0,0 +1,57 @@
+/* Simulated board for running the player of Src/I2S.c on the host.
+ *
+ * The I2S peripheral behind the registers of nrf.h latches TXD.PTR and MAXCNT words at START and
+ * at the end of every buffer, raises TXPTRUPD and calls I2S_IRQHandler() there, the way the
+ * EasyDMA does. STOP ends the stream at once with STOPPED. The words sent are collected as the
+ * output, 16-bit samples in the order they reach the amplifier, silence while the I2S is stopped.
+ *
+ * Time is counted in output samples at I2S_SAMPLE_RATE, the cycle counter (64 MHz) and the RTC
+ * of app_timer run on it. sound_process() is called after every interrupt, as the main loop would.
+ *
+ * TXD.PTR holds 32-bit addresses, link with -no-pie so the buffers of I2S.c are below 4 GB.
+ */
+#ifndef I2S_SIM_H__
+#define I2S_SIM_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "clip_store.h"
+
+/**@brief Simulation counters. */
+typedef struct
+{
+	uint32_t  interrupts;                                  /**< I2S_IRQHandler() calls. */
+	uint32_t  buffers;                                     /**< Buffers latched by the EasyDMA. */
+	uint32_t  streaming_samples;                           /**< Output samples sent while the I2S was started. */
+	uint32_t  enabled_samples;                             /**< Output samples while the I2S was enabled. */
+	uint64_t  irq_ns;                                      /**< Host CPU time in I2S_IRQHandler(). */
+} i2s_sim_stats_t;
+
+/**@brief Function for resetting the simulated time, registers and output, call before I2S_init(). */
+void i2s_sim_init(void);
+
+/**@brief Function for running the peripheral until the output reaches a sample.
+ *
+ * @param[in]   sample   Output position, samples since i2s_sim_init().
+ */
+void i2s_sim_run(uint32_t sample);
+
+/**@brief Function for getting the output position, samples since i2s_sim_init(). */
+uint32_t i2s_sim_time_get(void);
+
+/**@brief Function for getting the output so far. */
+int16_t const * i2s_sim_output_get(uint32_t * p_length);
+
+/**@brief Function for getting the simulation counters. */
+void i2s_sim_stats_get(i2s_sim_stats_t * p_stats);
+
+/**@brief Function for adding a clip to the simulated clip store, found by clip_store_find().
+ *
+ * @param[in]   clip_id   CLIP_STORE_ID_FIRST..CLIP_STORE_ID_LAST.
+ * @param[in]   p_data    Samples, kept by reference.
+ * @param[in]   length    Samples.
+ * @param[in]   p_info    Rate, loop points and priority.
+ */
+void i2s_sim_clip_add(uint8_t clip_id, int16_t const * p_data, uint32_t length, clip_store_info_t const * p_info);
+
+#endif // I2S_SIM_H__
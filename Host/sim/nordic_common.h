@@ -0,0 +1,11 @@
+/* Host stand-in, the helpers of the SDK header the audio sources use. */
+#ifndef NORDIC_COMMON_H__
+#define NORDIC_COMMON_H__
+
+#define MIN(a, b)                   ((a) < (b) ? (a) : (b))
+#define MAX(a, b)                   ((a) < (b) ? (b) : (a))
+#define ARRAY_SIZE(arr)             (sizeof(arr) / sizeof((arr)[0]))
+#define ROUNDED_DIV(A, B)           (((A) + ((B) / 2)) / (B))
+#define UNUSED_PARAMETER(X)         (void)(X)
+
+#endif // NORDIC_COMMON_H__
@@ -0,0 +1,178 @@
+/* Host stand-in for the nRF52840 device header, just what the audio sources use: the I2S
+ * registers, the cycle counter and the Cortex-M4 DSP intrinsics in portable C.
+ *
+ * The registers are plain memory, i2s_sim.c plays the peripheral behind them.
+ */
+#ifndef NRF_H
+#define NRF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define __INLINE                            inline
+
+typedef enum
+{
+	I2S_IRQn = 37,
+} IRQn_Type;
+
+typedef struct
+{
+	volatile uint32_t TXEN;
+	volatile uint32_t MCKEN;
+	volatile uint32_t MCKFREQ;
+	volatile uint32_t RATIO;
+	volatile uint32_t MODE;
+	volatile uint32_t SWIDTH;
+	volatile uint32_t ALIGN;
+	volatile uint32_t FORMAT;
+	volatile uint32_t CHANNELS;
+} I2S_CONFIG_Type;
+
+typedef struct
+{
+	volatile uint32_t PTR;
+} I2S_TXD_Type;
+
+typedef struct
+{
+	volatile uint32_t MAXCNT;
+} I2S_RXTXD_Type;
+
+typedef struct
+{
+	volatile uint32_t MCK;
+	volatile uint32_t SCK;
+	volatile uint32_t LRCK;
+	volatile uint32_t SDIN;
+	volatile uint32_t SDOUT;
+} I2S_PSEL_Type;
+
+typedef struct
+{
+	volatile uint32_t TASKS_START;
+	volatile uint32_t TASKS_STOP;
+	volatile uint32_t EVENTS_RXPTRUPD;
+	volatile uint32_t EVENTS_STOPPED;
+	volatile uint32_t EVENTS_TXPTRUPD;
+	volatile uint32_t INTEN;
+	volatile uint32_t INTENSET;
+	volatile uint32_t INTENCLR;
+	volatile uint32_t ENABLE;
+	I2S_CONFIG_Type   CONFIG;
+	I2S_TXD_Type      TXD;
+	I2S_RXTXD_Type    RXTXD;
+	I2S_PSEL_Type     PSEL;
+} NRF_I2S_Type;
+
+typedef struct
+{
+	volatile uint32_t CTRL;
+	volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct
+{
+	volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+extern NRF_I2S_Type   i2s_sim_regs;
+extern DWT_Type       i2s_sim_dwt;
+extern CoreDebug_Type i2s_sim_coredebug;
+
+#define NRF_I2S                             (&i2s_sim_regs)
+#define DWT                                 (&i2s_sim_dwt)
+#define CoreDebug                           (&i2s_sim_coredebug)
+
+#define CoreDebug_DEMCR_TRCENA_Msk          (1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk              (1UL << 0)
+
+#define I2S_INTENSET_STOPPED_Msk            (1UL << 2)
+#define I2S_INTENSET_TXPTRUPD_Msk           (1UL << 5)
+
+#define I2S_CONFIG_TXEN_TXEN_Pos            0
+#define I2S_CONFIG_TXEN_TXEN_ENABLE         1
+#define I2S_CONFIG_MCKEN_MCKEN_Pos          0
+#define I2S_CONFIG_MCKEN_MCKEN_ENABLE       1
+#define I2S_CONFIG_MCKFREQ_MCKFREQ_Pos      0
+#define I2S_CONFIG_MCKFREQ_MCKFREQ_32MDIV21 0x0B000000UL
+#define I2S_CONFIG_RATIO_RATIO_Pos          0
+#define I2S_CONFIG_RATIO_RATIO_128X         4
+#define I2S_CONFIG_MODE_MODE_Pos            0
+#define I2S_CONFIG_MODE_MODE_MASTER         0
+#define I2S_CONFIG_SWIDTH_SWIDTH_Pos        0
+#define I2S_CONFIG_SWIDTH_SWIDTH_16BIT      1
+#define I2S_CONFIG_ALIGN_ALIGN_Pos          0
+#define I2S_CONFIG_ALIGN_ALIGN_LEFT         0
+#define I2S_CONFIG_FORMAT_FORMAT_Pos        0
+#define I2S_CONFIG_FORMAT_FORMAT_I2S        0
+#define I2S_CONFIG_CHANNELS_CHANNELS_Pos    0
+#define I2S_CONFIG_CHANNELS_CHANNELS_STEREO 0
+#define I2S_PSEL_MCK_PIN_Pos                0
+#define I2S_PSEL_MCK_CONNECT_Pos            31
+#define I2S_PSEL_MCK_CONNECT_Disconnected   1
+#define I2S_PSEL_SCK_PIN_Pos                0
+#define I2S_PSEL_LRCK_PIN_Pos               0
+#define I2S_PSEL_SDOUT_PIN_Pos              0
+
+/* Interrupts are taken by i2s_sim_run() between two calls of the application, never in the middle
+ * of one, so masking and priorities have nothing to do.
+ */
+static inline void NVIC_SetPriority(IRQn_Type irq, uint32_t priority) { (void)irq; (void)priority; }
+static inline void NVIC_EnableIRQ(IRQn_Type irq)                        { (void)irq; }
+static inline void NVIC_DisableIRQ(IRQn_Type irq)                       { (void)irq; }
+static inline void NVIC_ClearPendingIRQ(IRQn_Type irq)                  { (void)irq; }
+static inline void NVIC_SetPendingIRQ(IRQn_Type irq)                    { (void)irq; }
+
+static inline uint32_t __UNALIGNED_UINT32_READ(void const * p_addr)
+{
+	uint32_t value;
+
+	memcpy(&value, p_addr, sizeof(value));
+	return value;
+}
+
+static inline int32_t __SSAT(int32_t value, uint32_t bits)
+{
+	int32_t max = (int32_t)((1UL << (bits - 1)) - 1);
+
+	return (value > max) ? max : ((value < -max - 1) ? -max - 1 : value);
+}
+
+static inline uint32_t __SMULBB(uint32_t a, uint32_t b)
+{
+	return (uint32_t)((int32_t)(int16_t)a * (int16_t)b);
+}
+
+static inline uint32_t __SMULTB(uint32_t a, uint32_t b)
+{
+	return (uint32_t)((int32_t)(int16_t)(a >> 16) * (int16_t)b);
+}
+
+static inline uint32_t __SMULTT(uint32_t a, uint32_t b)
+{
+	return (uint32_t)((int32_t)(int16_t)(a >> 16) * (int16_t)(b >> 16));
+}
+
+static inline int32_t __SMULWB(int32_t a, uint32_t b)
+{
+	return (int32_t)(((int64_t)a * (int16_t)b) >> 16);
+}
+
+static inline uint32_t __SMLAD(uint32_t a, uint32_t b, uint32_t acc)
+{
+	return acc + (uint32_t)((int16_t)a * (int16_t)b) + (uint32_t)((int16_t)(a >> 16) * (int16_t)(b >> 16));
+}
+
+static inline uint32_t __QADD16(uint32_t a, uint32_t b)
+{
+	int32_t low  = __SSAT((int16_t)a + (int16_t)b, 16);
+	int32_t high = __SSAT((int16_t)(a >> 16) + (int16_t)(b >> 16), 16);
+
+	return ((uint32_t)low & 0xFFFF) | ((uint32_t)high << 16);
+}
+
+#define __PKHBT(a, b, shift)                ((((uint32_t)(a)) & 0xFFFFUL) | ((((uint32_t)(b)) << (shift)) & 0xFFFF0000UL))
+
+#endif // NRF_H
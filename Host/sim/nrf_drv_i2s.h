@@ -0,0 +1 @@
+/* Host stand-in, I2S.h includes the board and driver headers without using them. */
@@ -0,0 +1,11 @@
+/* Host stand-in, only the error type is used by the headers the simulator includes. */
+#ifndef SDK_ERRORS_H__
+#define SDK_ERRORS_H__
+
+#include <stdint.h>
+
+typedef uint32_t ret_code_t;
+
+#define NRF_SUCCESS                 0
+
+#endif // SDK_ERRORS_H__
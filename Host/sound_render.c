@@ -0,0 +1,290 @@
+/* Runs the player of Src/I2S.c on the host against the simulated I2S of sim/i2s_sim.c and writes
+ * what reaches the amplifier to WAV files.
+ *
+ *   make -C Host sim      every scene to sim_<scene>.wav, with latency and CPU time per audio second
+ *   make -C Host check    compare the rendered samples with sound_render.golden
+ *   make -C Host golden   regenerate sound_render.golden after an intended change of the output
+ *
+ * Each scene runs in its own process, from a freshly booted player, and renders until the I2S has
+ * powered down after its last sound. The golden file holds the length and CRC-32 of every scene,
+ * the rendering is integer only so it does not depend on the host.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "I2S.h"
+#include "i2s_sim.h"
+#include "adpcm.h"
+#include "wav.h"
+
+#define RENDER_LIMIT_MS     10000                           // a scene that does not go idle is cut here
+#define RENDER_CLIP_LOOP    0x05                            // uploaded clip ids used by the scenes
+#define RENDER_CLIP_SLOW    0x06
+#define RENDER_STREAM_RATE  16000
+#define RENDER_FRAME        160                             // stream samples per frame, 10 ms
+
+typedef struct
+{
+	char const * name;
+	void      (* p_play)(void);
+} render_scene_t;
+
+static int16_t m_loop_clip[16000];                          // 1 s at 16 kHz, looped in the middle
+static int16_t m_slow_clip[8000];                           // 0.5 s at 12 kHz, played once
+
+static uint32_t ms_to_samples(uint32_t ms)
+{
+	return (uint32_t)(((uint64_t)ms * I2S_SAMPLE_RATE) / 1000);
+}
+
+/*@brief Let the simulated time run up to ms since the scene started
+*/
+static void at(uint32_t ms)
+{
+	i2s_sim_run(ms_to_samples(ms));
+}
+
+/*@brief Triangle wave, exact in integers so the golden file does not depend on the host libm
+*/
+static void triangle_make(int16_t * p_data, uint32_t length, uint32_t period, int32_t amplitude)
+{
+	uint32_t i;
+
+	for (i = 0; i < length; i++)
+	{
+		int32_t phase = (int32_t)(i % period);
+		int32_t half  = (int32_t)period / 2;
+		int32_t ramp  = (phase < half) ? phase : (int32_t)period - phase;
+
+		p_data[i] = (int16_t)(((2 * ramp - half) * amplitude) / half);
+	}
+}
+
+static void scene_claves(void)
+{
+	sound_play(SOUND_CLIP_CLAVES);
+}
+
+static void scene_layers(void)
+{
+	sound_play(SOUND_CLIP_CUICA);
+	at(60);
+	sound_hit(SOUND_CLIP_CLAVES, 0x4000);
+	at(180);
+	sound_hit(SOUND_CLIP_CLAVES, 0x7FFF);
+}
+
+static void scene_tone(void)
+{
+	synth_params_t params =
+	{
+		.waveform    = SYNTH_WAVE_SQUARE,
+		.frequency   = 880,
+		.duration_ms = 200,
+		.attack_ms   = 5,
+		.decay_ms    = 40,
+		.sustain     = 0x4000,
+		.release_ms  = 80,
+	};
+
+	sound_tone(&params);
+}
+
+static void scene_pattern(void)
+{
+	// two loops of 20 ms ticks: cuica, claves, claves, rest
+	static const uint8_t pattern[] = { 2, 20, 0, 0, 0x1F, 4, 0x2A, 2, 0x27, 2, 0x00 };
+
+	(void)sound_pattern_play(pattern, sizeof(pattern));
+}
+
+static void scene_loop(void)
+{
+	sound_play(RENDER_CLIP_LOOP);
+	at(800);
+	sound_release();
+}
+
+static void scene_priority(void)
+{
+	sound_play_priority(RENDER_CLIP_LOOP, SOUND_PRIORITY_AMBIENT);
+	at(200);
+	sound_play_priority(SOUND_CLIP_CLAVES, SOUND_PRIORITY_ALARM);
+	at(230);
+	// lower than the alarm: must neither fade nor replace it
+	sound_play(SOUND_CLIP_CUICA);
+	at(260);
+	sound_play(RENDER_CLIP_SLOW);
+	at(600);
+	sound_release();
+}
+
+static void scene_stream(void)
+{
+	static int16_t source[RENDER_FRAME * 48];
+	adpcm_state_t  encoder = { 0, 0 };
+	uint8_t        frame[SOUND_STREAM_HEADER_LEN + RENDER_FRAME / 2];
+	uint32_t       count   = sizeof(source) / sizeof(source[0]) / RENDER_FRAME;
+	uint32_t       i;
+
+	triangle_make(source, sizeof(source) / sizeof(source[0]), 32, 12000);
+
+	(void)sound_stream_play(RENDER_STREAM_RATE);
+
+	// frames come three at a time, once per 30 ms connection interval
+	for (i = 0; i < count; i++)
+	{
+		if ((i % 3) == 0)
+		{
+			at(10 * i);
+		}
+
+		frame[0] = (uint8_t)i;
+		frame[1] = (i == count - 1) ? SOUND_STREAM_FLAG_END : 0;
+		frame[2] = (uint8_t)encoder.predictor;
+		frame[3] = (uint8_t)((uint16_t)encoder.predictor >> 8);
+		frame[4] = encoder.step_index;
+		adpcm_encode(&encoder, &source[i * RENDER_FRAME], RENDER_FRAME / 2, &frame[SOUND_STREAM_HEADER_LEN]);
+
+		(void)sound_stream_frame_put(frame, sizeof(frame));
+	}
+}
+
+static void scene_power(void)
+{
+	synth_params_t blip =
+	{
+		.waveform    = SYNTH_WAVE_TRIANGLE,
+		.frequency   = 1200,
+		.duration_ms = 40,
+		.attack_ms   = 2,
+		.decay_ms    = 10,
+		.sustain     = 0x6000,
+		.release_ms  = 20,
+	};
+
+	// the second blip comes while the I2S drains, the third once it has powered down
+	sound_tone(&blip);
+	at(60 + I2S_DRAIN_MS / 2);
+	sound_tone(&blip);
+	at(1000);
+	sound_tone(&blip);
+}
+
+static const render_scene_t m_scenes[] =
+{
+	{ "claves",   scene_claves   },
+	{ "layers",   scene_layers   },
+	{ "tone",     scene_tone     },
+	{ "pattern",  scene_pattern  },
+	{ "loop",     scene_loop     },
+	{ "priority", scene_priority },
+	{ "stream",   scene_stream   },
+	{ "power",    scene_power    },
+};
+
+static uint32_t crc32_compute(uint8_t const * p_data, uint32_t length)
+{
+	uint32_t crc = 0xFFFFFFFF;
+	uint32_t i;
+	uint32_t bit;
+
+	for (i = 0; i < length; i++)
+	{
+		crc ^= p_data[i];
+		for (bit = 0; bit < 8; bit++)
+		{
+			crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+		}
+	}
+	return ~crc;
+}
+
+static void evt_handler(sound_evt_t const * p_evt)
+{
+	(void)p_evt;
+}
+
+/*@brief Boot the player, play a scene and write what came out
+*/
+static void scene_render(render_scene_t const * p_scene, bool golden)
+{
+	clip_store_info_t loop = { 16000, 4000, 12000, SOUND_PRIORITY_NORMAL };
+	clip_store_info_t slow = { 12000, 0, 0, 0xFF };
+	i2s_sim_stats_t   sim;
+	sound_stats_t     stats;
+	int16_t const *   p_out;
+	uint32_t          length;
+	uint32_t          limit = ms_to_samples(RENDER_LIMIT_MS);
+	char              name[64];
+
+	triangle_make(m_loop_clip, sizeof(m_loop_clip) / sizeof(m_loop_clip[0]), 40, 10000);
+	triangle_make(m_slow_clip, sizeof(m_slow_clip) / sizeof(m_slow_clip[0]), 60, 14000);
+
+	i2s_sim_init();
+	i2s_sim_clip_add(RENDER_CLIP_LOOP, m_loop_clip, sizeof(m_loop_clip) / sizeof(m_loop_clip[0]), &loop);
+	i2s_sim_clip_add(RENDER_CLIP_SLOW, m_slow_clip, sizeof(m_slow_clip) / sizeof(m_slow_clip[0]), &slow);
+	I2S_init(evt_handler);
+
+	p_scene->p_play();
+
+	// render on until the I2S has stopped and powered down
+	do
+	{
+		i2s_sim_run(i2s_sim_time_get() + I2S_BUFFER_SAMPLES);
+	}
+	while ((sound_state_get() != SOUND_STATE_IDLE) && (i2s_sim_time_get() < limit));
+
+	p_out = i2s_sim_output_get(&length);
+	i2s_sim_stats_get(&sim);
+	sound_stats_get(&stats);
+
+	if (golden)
+	{
+		printf("%-10s %8u %08x\n", p_scene->name, length, crc32_compute((uint8_t const *)p_out, length * sizeof(int16_t)));
+		return;
+	}
+
+	snprintf(name, sizeof(name), "sim_%s.wav", p_scene->name);
+	wav_write(name, p_out, length, I2S_SAMPLE_RATE);
+
+	printf("%-10s %6.3f s  streaming %6.3f s  power ups %u  latency max %4u us (cold %4u)  misses %u  irq %5.1f us/buffer  %6.2f ms CPU per audio s\n",
+	       p_scene->name, (double)length / I2S_SAMPLE_RATE, (double)sim.streaming_samples / I2S_SAMPLE_RATE,
+	       stats.power_ups, stats.trigger_latency_max, stats.cold_latency_max, stats.trigger_latency_misses,
+	       (sim.interrupts > 0) ? sim.irq_ns / 1000.0 / sim.interrupts : 0.0,
+	       (sim.streaming_samples > 0) ? sim.irq_ns / 1e6 / ((double)sim.streaming_samples / I2S_SAMPLE_RATE) : 0.0);
+}
+
+int main(int argc, char ** argv)
+{
+	bool     golden = (argc > 1) && (strcmp(argv[1], "-g") == 0);
+	int      failed = 0;
+	uint32_t i;
+
+	for (i = 0; i < sizeof(m_scenes) / sizeof(m_scenes[0]); i++)
+	{
+		pid_t pid;
+		int   status;
+
+		// a fresh process per scene is a freshly booted player
+		fflush(stdout);
+		pid = fork();
+		if (pid == 0)
+		{
+			scene_render(&m_scenes[i], golden);
+			fflush(stdout);
+			_exit(0);
+		}
+
+		if ((pid < 0) || (waitpid(pid, &status, 0) != pid) || !WIFEXITED(status) || (WEXITSTATUS(status) != 0))
+		{
+			fprintf(stderr, "%s: render failed\n", m_scenes[i].name);
+			failed = 1;
+		}
+	}
+	return failed;
+}
@@ -0,0 +1,412 @@
+/* Decoder of the sample stream frames of Inc/stream_frame.h, for captures of the accelerometer
+ * notifications and burst SDUs.
+ *
+ *   ./stream_decode [-s] [capture]   one frame per line in hex, '#' starts a comment, stdin without a file
+ *   ./stream_decode -t               self-test, run by make -C Host check
+ *
+ * Every gap, frame out of order, duplicate and resync is reported with the line it was found on,
+ * followed by a summary per stream. -s prints the samples too, x, y, z in 14-bit counts. The
+ * self-test sends a stream through stream_frame.c and the codecs of the device, loses, repeats and
+ * reorders frames on the way, runs the sequence through its wrap and restarts the device, then
+ * checks what the decoder counted. Exits non-zero on any failure.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "stream_frame.h"
+#include "accel_codec.h"
+
+#define DECODE_FRAME_MAX    1024                            // L2CAP_CHANNEL_SDU_MAX in Inc/l2cap_channel.h
+#define DECODE_SAMPLE_LEN   6                               // ACEL_SAMPLE_LEN, raw
+#define DECODE_SAMPLES_MAX  (DECODE_FRAME_MAX * 8 / 36)     // 12-bit packed, the densest format but delta
+
+#define TEST_FRAMES         40
+#define TEST_COUNT          4                               // samples per frame
+#define TEST_TICKS          82                              // 400 Hz at STREAM_FRAME_TICK_HZ
+
+typedef struct
+{
+	stream_frame_rx_t rx;
+	uint32_t          samples;                              /**< Samples decoded. */
+	uint32_t          malformed;                            /**< Frames whose samples do not match the header. */
+	uint32_t          newest_time;                          /**< Timestamp of the newest frame. */
+} decode_stream_t;
+
+static decode_stream_t m_streams[256];
+static bool            m_show_samples;
+static bool            m_quiet;
+
+static uint8_t hex_value(char c)
+{
+	return (uint8_t)(isdigit((unsigned char)c) ? c - '0' : tolower((unsigned char)c) - 'a' + 10);
+}
+
+static char const * encoding_name(uint8_t encoding)
+{
+	static char const * const names[] = { "raw", "delta", "packed14", "packed12" };
+
+	return (encoding < sizeof(names) / sizeof(names[0])) ? names[encoding] : "unknown";
+}
+
+static double ticks_to_ms(uint32_t ticks)
+{
+	return ticks * 1000.0 / STREAM_FRAME_TICK_HZ;
+}
+
+/*@brief Decode the samples after the header in their encoding
+ *
+ * @return Samples decoded, 0 for an unknown encoding or a malformed frame.
+*/
+static uint16_t samples_decode(uint8_t encoding, uint8_t const * p_data, uint16_t length, int16_t (* p_out)[3])
+{
+	uint16_t count;
+	uint16_t i;
+	uint8_t  axis;
+
+	switch (encoding)
+	{
+	case STREAM_FRAME_ENCODING_RAW:
+		if ((length % DECODE_SAMPLE_LEN) != 0)
+		{
+			return 0;
+		}
+		count = length / DECODE_SAMPLE_LEN;
+		for (i = 0; i < count; i++)
+		{
+			for (axis = 0; axis < 3; axis++)
+			{
+				uint8_t const * p_value = &p_data[i * DECODE_SAMPLE_LEN + 2 * axis];
+
+				// left aligned as in the BMA280 registers
+				p_out[i][axis] = (int16_t)(p_value[0] | (p_value[1] << 8)) >> 2;
+			}
+		}
+		return count;
+
+	case STREAM_FRAME_ENCODING_DELTA:
+		return accel_codec_decode(p_data, length, p_out, DECODE_SAMPLES_MAX);
+
+	case STREAM_FRAME_ENCODING_PACKED14:
+		return accel_codec_unpack(p_data, length, 14, p_out, DECODE_SAMPLES_MAX);
+
+	case STREAM_FRAME_ENCODING_PACKED12:
+		return accel_codec_unpack(p_data, length, 12, p_out, DECODE_SAMPLES_MAX);
+
+	default:
+		return 0;
+	}
+}
+
+/*@brief Place one frame in its stream and report what does not follow on
+*/
+static void frame_decode(uint8_t const * p_frame, uint16_t length, uint32_t line)
+{
+	static int16_t           samples[DECODE_SAMPLES_MAX][3];
+	stream_frame_header_t    header;
+	decode_stream_t *        p_stream;
+	stream_frame_rx_result_t result;
+	uint16_t                 newest;
+	uint16_t                 missed;
+	uint16_t                 count;
+	uint16_t                 i;
+
+	if (!stream_frame_header_get(p_frame, length, &header))
+	{
+		if (!m_quiet)
+		{
+			printf("line %u: %u bytes, shorter than a header\n", line, length);
+		}
+		return;
+	}
+
+	p_stream = &m_streams[header.stream_id];
+	newest   = p_stream->rx.newest;
+	result   = stream_frame_rx_put(&p_stream->rx, header.sequence, &missed);
+
+	if (!m_quiet)
+	{
+		switch (result)
+		{
+		case STREAM_FRAME_GAP:
+			printf("line %u: stream %u seq %u: gap, %u frames lost after seq %u, %.1f ms apart\n", line, header.stream_id,
+			       header.sequence, missed, newest, ticks_to_ms(header.timestamp - p_stream->newest_time));
+			break;
+
+		case STREAM_FRAME_LATE:
+			printf("line %u: stream %u seq %u: late, after seq %u\n", line, header.stream_id, header.sequence, newest);
+			break;
+
+		case STREAM_FRAME_DUPLICATE:
+			printf("line %u: stream %u seq %u: duplicate\n", line, header.stream_id, header.sequence);
+			break;
+
+		case STREAM_FRAME_RESYNC:
+			printf("line %u: stream %u seq %u: resync after seq %u, the device restarted or more than %u frames were lost\n",
+			       line, header.stream_id, header.sequence, newest, STREAM_FRAME_WINDOW);
+			break;
+
+		default:
+			break;
+		}
+		if ((header.flags & STREAM_FRAME_FLAG_RESUMED) && (result != STREAM_FRAME_DUPLICATE))
+		{
+			printf("line %u: stream %u seq %u: sampling resumed\n", line, header.stream_id, header.sequence);
+		}
+	}
+
+	if (result == STREAM_FRAME_DUPLICATE)
+	{
+		return;
+	}
+	if (result != STREAM_FRAME_LATE)
+	{
+		p_stream->newest_time = header.timestamp;
+	}
+
+	count = samples_decode(header.flags & STREAM_FRAME_ENCODING_MASK, &p_frame[STREAM_FRAME_HEADER_LEN],
+	                       length - STREAM_FRAME_HEADER_LEN, samples);
+	if (count != header.count)
+	{
+		p_stream->malformed++;
+		if (!m_quiet)
+		{
+			printf("line %u: stream %u seq %u: %s, %u samples in the header, %u decoded\n", line, header.stream_id,
+			       header.sequence, encoding_name(header.flags & STREAM_FRAME_ENCODING_MASK), header.count, count);
+		}
+		return;
+	}
+	p_stream->samples += count;
+
+	for (i = 0; m_show_samples && (i < count); i++)
+	{
+		printf("%u %u %.3f %d %d %d\n", header.stream_id, header.sequence,
+		       ticks_to_ms(header.timestamp) / 1000.0, samples[i][0], samples[i][1], samples[i][2]);
+	}
+}
+
+static void summary_print(void)
+{
+	uint32_t id;
+
+	for (id = 0; id < sizeof(m_streams) / sizeof(m_streams[0]); id++)
+	{
+		decode_stream_t const * p_stream = &m_streams[id];
+		uint32_t                expected = p_stream->rx.frames + p_stream->rx.lost;
+
+		if (!p_stream->rx.started)
+		{
+			continue;
+		}
+		printf("stream %u: %u frames, %u samples, %u lost in %u gaps (%.2f %%), %u late, %u duplicates, %u resyncs, %u malformed\n",
+		       id, p_stream->rx.frames, p_stream->samples, p_stream->rx.lost, p_stream->rx.gaps,
+		       (expected > 0) ? 100.0 * p_stream->rx.lost / expected : 0.0,
+		       p_stream->rx.late, p_stream->rx.duplicates, p_stream->rx.resyncs, p_stream->malformed);
+	}
+}
+
+/*@brief Read the frames of a capture, one per line in hex
+*/
+static int capture_decode(FILE * p_file)
+{
+	static uint8_t frame[DECODE_FRAME_MAX];
+	char           text[4 * DECODE_FRAME_MAX];
+	uint32_t       line = 0;
+
+	while (fgets(text, sizeof(text), p_file) != NULL)
+	{
+		uint16_t length = 0;
+		char *   p_text = text;
+		char *   p_end;
+
+		line++;
+		p_end = strchr(text, '#');
+		if (p_end != NULL)
+		{
+			*p_end = '\0';
+		}
+
+		// bytes apart or run together, with or without separators
+		while (*p_text != '\0')
+		{
+			if (!isxdigit((unsigned char)p_text[0]))
+			{
+				p_text++;
+				continue;
+			}
+			if (!isxdigit((unsigned char)p_text[1]) || (length == sizeof(frame)))
+			{
+				fprintf(stderr, "line %u: not a frame\n", line);
+				return 1;
+			}
+			frame[length++] = (uint8_t)((hex_value(p_text[0]) << 4) | hex_value(p_text[1]));
+			p_text += 2;
+		}
+
+		if (length > 0)
+		{
+			frame_decode(frame, length, line);
+		}
+	}
+
+	summary_print();
+	return 0;
+}
+
+/*@brief A frame of the self-test stream in one of the encodings, built as the device does
+*/
+static uint16_t test_frame_make(stream_frame_tx_t * p_tx, int16_t (* p_samples)[3], uint32_t timestamp, uint8_t * p_frame)
+{
+	uint8_t  encoding = (uint8_t)(p_tx->sequence % 4);
+	uint16_t length   = 0;
+	uint16_t i;
+
+	switch (encoding)
+	{
+	case STREAM_FRAME_ENCODING_RAW:
+		for (i = 0; i < TEST_COUNT; i++)
+		{
+			uint8_t axis;
+
+			for (axis = 0; axis < 3; axis++)
+			{
+				uint16_t value = (uint16_t)p_samples[i][axis] << 2;
+
+				p_frame[STREAM_FRAME_HEADER_LEN + length++] = (uint8_t)value;
+				p_frame[STREAM_FRAME_HEADER_LEN + length++] = (uint8_t)(value >> 8);
+			}
+		}
+		break;
+
+	case STREAM_FRAME_ENCODING_DELTA:
+	{
+		accel_codec_t codec;
+
+		accel_codec_init(&codec, &p_frame[STREAM_FRAME_HEADER_LEN], DECODE_FRAME_MAX - STREAM_FRAME_HEADER_LEN);
+		for (i = 0; i < TEST_COUNT; i++)
+		{
+			(void)accel_codec_put(&codec, p_samples[i]);
+		}
+		length = accel_codec_flush(&codec);
+		break;
+	}
+
+	default:
+		for (i = 0; i < TEST_COUNT; i++)
+		{
+			length = accel_codec_pack(p_samples[i], (encoding == STREAM_FRAME_ENCODING_PACKED14) ? 14 : 12,
+			                          &p_frame[STREAM_FRAME_HEADER_LEN], i);
+		}
+		break;
+	}
+
+	stream_frame_header_put(p_tx, encoding, timestamp, TEST_COUNT, p_frame);
+	return STREAM_FRAME_HEADER_LEN + length;
+}
+
+static int self_test(void)
+{
+	static uint8_t    frames[TEST_FRAMES + 5][DECODE_FRAME_MAX];
+	static uint16_t   lengths[TEST_FRAMES + 5];
+	// lost on the way: 3 to 5, 21 to 29; 8 after 9, 8 and 10 twice, then the device restarts
+	static const int8_t order[] =
+	{
+		0, 1, 2, 6, 7, 9, 8, 8, 10, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20,
+		30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44,
+	};
+	stream_frame_tx_t tx;
+	decode_stream_t * p_stream = &m_streams[STREAM_ID_ACEL_NOTIFY];
+	int16_t           samples[TEST_COUNT][3];
+	int16_t           decoded[DECODE_SAMPLES_MAX][3];
+	uint32_t          i;
+	uint32_t          j;
+	int               failed = 0;
+
+	stream_frame_tx_init(&tx, STREAM_ID_ACEL_NOTIFY);
+	// through the wrap of the sequence from the sixth frame on
+	tx.sequence = 65530;
+	for (i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++)
+	{
+		if (i == TEST_FRAMES)
+		{
+			stream_frame_tx_init(&tx, STREAM_ID_ACEL_NOTIFY);
+		}
+		for (j = 0; j < TEST_COUNT; j++)
+		{
+			// multiples of 4 so the 12-bit frames decode exactly
+			samples[j][0] = (int16_t)(4 * (i * TEST_COUNT + j) - 2048);
+			samples[j][1] = (int16_t)(-4 * (int32_t)j);
+			samples[j][2] = 4096;
+		}
+		lengths[i] = test_frame_make(&tx, samples, (i * TEST_COUNT) * TEST_TICKS, frames[i]);
+
+		if ((samples_decode(frames[i][1] & STREAM_FRAME_ENCODING_MASK, &frames[i][STREAM_FRAME_HEADER_LEN],
+		                    lengths[i] - STREAM_FRAME_HEADER_LEN, decoded) != TEST_COUNT) ||
+		    (memcmp(decoded, samples, sizeof(samples)) != 0))
+		{
+			printf("frame %u, %s: round trip FAILED\n", i, encoding_name(frames[i][1] & STREAM_FRAME_ENCODING_MASK));
+			failed = 1;
+		}
+	}
+
+	m_quiet = true;
+	for (i = 0; i < sizeof(order) / sizeof(order[0]); i++)
+	{
+		frame_decode(frames[order[i]], lengths[order[i]], i + 1);
+	}
+	// cut short, counted nowhere
+	frame_decode(frames[0], STREAM_FRAME_HEADER_LEN - 1, 0);
+	m_quiet = false;
+
+	if ((p_stream->rx.frames != 33) || (p_stream->rx.lost != 12) || (p_stream->rx.gaps != 3) ||
+	    (p_stream->rx.late != 1) || (p_stream->rx.duplicates != 2) || (p_stream->rx.resyncs != 1) ||
+	    (p_stream->samples != 33 * TEST_COUNT) || (p_stream->malformed != 0))
+	{
+		printf("stream counters FAILED\n");
+		failed = 1;
+	}
+	summary_print();
+	return failed;
+}
+
+int main(int argc, char ** argv)
+{
+	FILE *   p_file = stdin;
+	int      arg    = 1;
+	int      result;
+	uint32_t i;
+
+	for (i = 0; i < sizeof(m_streams) / sizeof(m_streams[0]); i++)
+	{
+		stream_frame_rx_init(&m_streams[i].rx);
+	}
+
+	if ((arg < argc) && (strcmp(argv[arg], "-t") == 0))
+	{
+		return self_test();
+	}
+	if ((arg < argc) && (strcmp(argv[arg], "-s") == 0))
+	{
+		m_show_samples = true;
+		arg++;
+	}
+	if (arg < argc)
+	{
+		p_file = fopen(argv[arg], "r");
+		if (p_file == NULL)
+		{
+			perror(argv[arg]);
+			return 1;
+		}
+	}
+
+	result = capture_decode(p_file);
+	if (p_file != stdin)
+	{
+		fclose(p_file);
+	}
+	return result;
+}
@@ -0,0 +1,35 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "wav.h"
+
+void wav_write(char const * p_name, int16_t const * p_data, uint32_t length, uint32_t sample_rate)
+{
+	FILE *   p_file = fopen(p_name, "wb");
+	uint32_t bytes  = length * sizeof(int16_t);
+	uint8_t  header[44];
+
+	if (p_file == NULL)
+	{
+		perror(p_name);
+		exit(1);
+	}
+
+	memcpy(&header[0], "RIFF", 4);
+	*(uint32_t *)&header[4]  = 36 + bytes;
+	memcpy(&header[8], "WAVEfmt ", 8);
+	*(uint32_t *)&header[16] = 16;
+	*(uint16_t *)&header[20] = 1;                           // PCM
+	*(uint16_t *)&header[22] = 1;                           // mono
+	*(uint32_t *)&header[24] = sample_rate;
+	*(uint32_t *)&header[28] = sample_rate * sizeof(int16_t);
+	*(uint16_t *)&header[32] = sizeof(int16_t);
+	*(uint16_t *)&header[34] = 16;
+	memcpy(&header[36], "data", 4);
+	*(uint32_t *)&header[40] = bytes;
+
+	fwrite(header, 1, sizeof(header), p_file);
+	fwrite(p_data, 1, bytes, p_file);
+	fclose(p_file);
+}
@@ -0,0 +1,10 @@
+/* Mono 16-bit WAV files for the host tools. */
+#ifndef WAV_H__
+#define WAV_H__
+
+#include <stdint.h>
+
+/**@brief Function for writing samples to a WAV file, exits on an error. */
+void wav_write(char const * p_name, int16_t const * p_data, uint32_t length, uint32_t sample_rate);
+
+#endif // WAV_H__
@@ -14,7 +14,9 @@ extern "C" {
 #include "nrf_drv_i2s.h"
 #include "nrf_delay.h"
 
-#include "sounds.h"
+#include "synth.h"
+#include "sound_stream.h"
+#include "output_dsp.h"
 
 	// I2S configuration
 #define PIN_MCK    (37) // (13)no wire
@@ -25,10 +27,112 @@ extern "C" {
 
 #define	NRF_I2S_STOP NRF_I2S->TASKS_START = 0;
 
-void I2S_init();
+	// Playback buffers: two halves of 16-bit sample pairs, refilled on TXPTRUPD
+#define I2S_BUFFER_WORDS      48                                  // 32-bit words per DMA buffer (~4 ms, bounds the trigger latency)
+#define I2S_BUFFER_SAMPLES    (I2S_BUFFER_WORDS * 2)              // 16-bit samples per DMA buffer
+#define I2S_VOICE_COUNT       4                                   // clips that can be mixed at once
+
+	// Gains are q15, 0x7FFF is unity
+#define I2S_GAIN_UNITY        0x7FFF
+#define I2S_FADE_SAMPLES      256                                 // fade-in/fade-out ramp length (~10 ms)
+
+	// Clip identifiers, same values as the BLE play command
+#define SOUND_CLIP_NONE       0x00
+#define SOUND_CLIP_CUICA      0x01
+#define SOUND_CLIP_CLAVES     0x02
+	// 0x03..0x0F are clips uploaded to flash, see clip_store.h
+#define SOUND_CLIP_TONE       0x80                                // synthesized tone, not a stored clip
+#define SOUND_CLIP_STREAM     0x81                                // BLE audio stream
+
+	// Samples per second consumed from the stream, two per LRCK frame (32 MHz / 21 / 128 * 2)
+#define I2S_SAMPLE_RATE       23810
+
+	// Sound priorities, a new sound only replaces voices of the same or a lower priority
+#define SOUND_PRIORITY_AMBIENT 0x00                               // background loops, first to go
+#define SOUND_PRIORITY_NORMAL  0x01                               // built-in clips, tones, stream
+#define SOUND_PRIORITY_ALERT   0x02
+#define SOUND_PRIORITY_ALARM   0x03                               // never replaced by anything else
+#define SOUND_PRIORITY_CLIP    0xFF                               // sound_play_priority(): priority stored with the clip
+
+	// Power: the I2S is only enabled, and only holds the HFCLK, while it streams
+#define I2S_DRAIN_MS          250                                 // silence streamed after the last voice before the I2S is stopped and disabled
+#define I2S_MCK_OUTPUT        0                                   // the MAX98357A runs from SCK and LRCK, MCK stays internal and its pin off
+
+	// Trigger-to-output latency the player is designed for, counted in sound_stats_t when exceeded
+#define I2S_TRIGGER_LATENCY_TARGET_US 5000
+
+/**@brief Player states. */
+typedef enum
+{
+	SOUND_STATE_IDLE,                   /**< I2S stopped and disabled, HFCLK released. */
+	SOUND_STATE_PLAYING,                /**< At least one voice is being rendered. */
+	SOUND_STATE_STOPPING,               /**< Last silent buffer queued, waiting for EVENTS_STOPPED. */
+	SOUND_STATE_ARMED,                  /**< I2S streaming silence, waiting for a trigger: pre-armed, or for I2S_DRAIN_MS after the last voice. */
+} sound_state_t;
+
+/**@brief Player event types. */
+typedef enum
+{
+	SOUND_EVT_STARTED   = 0x01,         /**< First buffer of a clip rendered. */
+	SOUND_EVT_FINISHED  = 0x02,         /**< Clip played to its end, a looping clip after sound_release(). */
+	SOUND_EVT_STOPPED   = 0x03,         /**< Clip faded out, replaced by a sound of the same or a higher priority, or cut by sound_store_cut(). */
+	SOUND_EVT_UNDERRUN  = 0x04,         /**< Buffer refill was late, the previous buffer was replayed. */
+	SOUND_EVT_IDLE      = 0x05,         /**< Last voice done (state ARMED), then I2S powered down (state IDLE). */
+	SOUND_EVT_PATTERN_DONE = 0x06,      /**< Sequencer started the last hit of its last loop. */
+} sound_evt_type_t;
+
+/**@brief Player event. */
+typedef struct
+{
+	sound_evt_type_t evt_type;
+	sound_state_t    state;             /**< Player state when the event was queued. */
+	uint8_t          clip_id;           /**< SOUND_CLIP_NONE for UNDERRUN, IDLE and PATTERN_DONE. */
+	uint8_t          voice;
+	uint32_t         sample_time;       /**< Position on the output timeline, samples. */
+	uint32_t         duration;          /**< STARTED: clip length, FINISHED/STOPPED: samples played, UNDERRUN: RTC ticks since the previous refill. */
+	uint32_t         timestamp;         /**< RTC ticks when the event was queued. */
+} sound_evt_t;
+
+/**@brief Render statistics, worst cases since boot. */
+typedef struct
+{
+	uint32_t         render_cycles_max;         /**< CPU cycles to render one buffer, all voices and output stage. */
+	uint32_t         synth_cycles_max;          /**< CPU cycles for one tone voice in one buffer. */
+	uint32_t         synth_budget_overruns;     /**< Tone renders over SYNTH_CYCLES_PER_SAMPLE. */
+	uint32_t         trigger_latency_last;      /**< Play call to first sample latched by the EasyDMA, us, in RTC ticks of ~61 us. */
+	uint32_t         trigger_latency_max;       /**< Worst trigger latency, us. */
+	uint32_t         trigger_latency_misses;    /**< Triggers over I2S_TRIGGER_LATENCY_TARGET_US. */
+	uint32_t         dsp_cycles_max;            /**< CPU cycles of the equalizer and limiter for one buffer. */
+	uint32_t         dsp_budget_overruns;       /**< Buffers over output_dsp_cycles_budget(). */
+	uint32_t         power_ups;                 /**< Times the I2S was enabled from IDLE. */
+	uint32_t         cold_latency_max;          /**< Worst trigger latency of a trigger that powered the I2S up, us. */
+} sound_stats_t;
+
+/**@brief Player event handler type. */
+typedef void (*sound_evt_handler_t)(sound_evt_t const * p_evt);
+
+void I2S_init(sound_evt_handler_t evt_handler);
 void sound_cuica_start();
 void sound_claves_start();
 
+void sound_play(uint8_t clip_id);
+void sound_play_priority(uint8_t clip_id, uint8_t priority);
+void sound_hit(uint8_t clip_id, uint16_t gain);
+void sound_tone(synth_params_t const * p_params);
+bool sound_pattern_play(uint8_t const * p_data, uint16_t length);
+bool sound_stream_play(uint32_t sample_rate);
+void sound_stop(void);
+void sound_release(void);
+void sound_store_cut(uint8_t clip_id);
+void sound_prearm_set(bool enable);
+void sound_master_gain_set(uint16_t gain);
+void sound_voice_gain_set(uint8_t voice, uint16_t gain);
+bool sound_eq_set(uint8_t stage, output_dsp_biquad_t const * p_biquad);
+void sound_limiter_set(output_dsp_limiter_t const * p_limiter);
+sound_state_t sound_state_get(void);
+void sound_stats_get(sound_stats_t * p_stats);
+void sound_process(void);
+
 #ifdef __cplusplus
 }
 #endif
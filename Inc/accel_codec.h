@@ -0,0 +1,126 @@
+#pragma once
+
+#ifndef ACCEL_CODEC_H__
+#define ACCEL_CODEC_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ACCEL_CODEC_GROUP             8                     /**< Samples sharing one set of bit widths. */
+#define ACCEL_CODEC_KEY_LEN           6                     /**< Key sample, x, y, z int16 LE. */
+
+/* Delta frame (accelerometer characteristic):
+ *
+ *   [key x LSB] [key x MSB] [key y LSB] [key y MSB] [key z LSB] [key z MSB] then groups to the end
+ *
+ * Group of 1 to ACCEL_CODEC_GROUP samples:
+ *
+ *   [width x | width y << 4] [width z | (samples - 1) << 4] then the deltas
+ *
+ * Each sample is x, y, z as zig-zag coded deltas to the sample before, each in the width of its
+ * axis, packed LSB first; the group is padded to a whole byte. A width of 15 stands for 16 bits.
+ * Deltas wrap at 16 bits so every int16 sample comes back exact, a resting sensor needs 2 to 3
+ * bits per axis.
+ */
+
+/* Packed frame:
+ *
+ *   x, y, z of each sample in a fixed number of bits, two's complement, packed LSB first
+ *
+ * 14 bits carry the BMA280 counts whole, fewer drop their low bits. The samples in a frame are
+ * length * 8 / (3 * bits), rounded down. At 14 bits every 7 bytes hold 4 values at the same bit
+ * offsets, so an unpacker can work on 64-bit words without looking at the data.
+ */
+#define ACCEL_CODEC_PACK_BITS_MAX     14                    /**< Bits of a BMA280 count. */
+
+/**@brief Frame encoder. */
+typedef struct
+{
+	uint8_t * p_frame;
+	uint16_t  size;                                         /**< Frame capacity, bytes. */
+	uint16_t  length;                                       /**< Bytes encoded. */
+	uint16_t  count;                                        /**< Samples encoded, key included. */
+	int16_t   last[3];                                      /**< Last encoded sample, the base of the next delta. */
+	int16_t   group[ACCEL_CODEC_GROUP][3];                  /**< Samples waiting for their group to fill. */
+	uint8_t   group_count;
+} accel_codec_t;
+
+/**@brief Function for starting an encoder on an empty frame.
+ *
+ * @param[out]  p_codec   Encoder.
+ * @param[in]   p_frame   Frame buffer.
+ * @param[in]   size      Frame capacity, at least ACCEL_CODEC_KEY_LEN + 2.
+ */
+void accel_codec_init(accel_codec_t * p_codec, uint8_t * p_frame, uint16_t size);
+
+/**@brief Function for adding a sample.
+ *
+ * @details The samples are encoded a group at a time. When a group does not fit whole, the part
+ *          that fits ends the frame and the rest waits for accel_codec_next().
+ *
+ * @param[in,out] p_codec    Encoder.
+ * @param[in]     p_sample   x, y, z.
+ *
+ * @return      true if the frame is complete: send p_frame, length bytes, then call accel_codec_next().
+ */
+bool accel_codec_put(accel_codec_t * p_codec, int16_t const * p_sample);
+
+/**@brief Function for encoding the samples waiting in a group, as many as fit.
+ *
+ * @param[in,out] p_codec    Encoder.
+ *
+ * @return      Frame length, 0 if the frame holds no sample.
+ */
+uint16_t accel_codec_flush(accel_codec_t * p_codec);
+
+/**@brief Function for starting the next frame in the same buffer, once the last one was sent.
+ *
+ * @details The samples that did not fit the last frame start this one.
+ *
+ * @param[in,out] p_codec    Encoder.
+ */
+void accel_codec_next(accel_codec_t * p_codec);
+
+/**@brief Function for decoding a frame.
+ *
+ * @param[in]   p_frame   Frame.
+ * @param[in]   length    Frame length.
+ * @param[out]  p_out     x, y, z of each sample.
+ * @param[in]   max       Samples p_out holds.
+ *
+ * @return      Samples decoded, 0 if the frame is malformed or holds more than max.
+ */
+uint16_t accel_codec_decode(uint8_t const * p_frame, uint16_t length, int16_t (* p_out)[3], uint16_t max);
+
+/**@brief Function for adding a sample to a packed frame.
+ *
+ * @param[in]   p_sample   x, y, z as 14-bit counts.
+ * @param[in]   bits       Bits per value, 8 to ACCEL_CODEC_PACK_BITS_MAX.
+ * @param[out]  p_frame    Frame, the samples before this one already packed.
+ * @param[in]   count      Samples before this one.
+ *
+ * @return      Frame length with this sample.
+ */
+uint16_t accel_codec_pack(int16_t const * p_sample, uint8_t bits, uint8_t * p_frame, uint16_t count);
+
+/**@brief Function for unpacking a packed frame, values scaled back to 14-bit counts.
+ *
+ * @param[in]   p_frame   Frame.
+ * @param[in]   length    Frame length.
+ * @param[in]   bits      Bits per value.
+ * @param[out]  p_out     x, y, z of each sample.
+ * @param[in]   max       Samples p_out holds.
+ *
+ * @return      Samples unpacked, 0 if there are more than max.
+ */
+uint16_t accel_codec_unpack(uint8_t const * p_frame, uint16_t length, uint8_t bits, int16_t (* p_out)[3], uint16_t max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ACCEL_CODEC_H__ */
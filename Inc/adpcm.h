@@ -0,0 +1,41 @@
+#pragma once
+
+#ifndef ADPCM_H__
+#define ADPCM_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/**@brief IMA ADPCM decoder state. */
+typedef struct
+{
+	int16_t   predictor;                                    /**< Last decoded sample. */
+	uint8_t   step_index;                                   /**< 0..88. */
+} adpcm_state_t;
+
+/**@brief Function for decoding IMA ADPCM, 4 bits per sample, low nibble first.
+ *
+ * @param[in,out] p_state   Decoder state, continued from the previous call.
+ * @param[in]     p_in      Encoded bytes.
+ * @param[in]     length    Encoded bytes, two samples each.
+ * @param[out]    p_out     2 * length samples.
+ */
+void adpcm_decode(adpcm_state_t * p_state, uint8_t const * p_in, uint32_t length, int16_t * p_out);
+
+/**@brief Function for encoding IMA ADPCM, the inverse of adpcm_decode().
+ *
+ * @param[in,out] p_state   Encoder state, continued from the previous call.
+ * @param[in]     p_in      2 * length samples.
+ * @param[in]     length    Encoded bytes.
+ * @param[out]    p_out     Encoded bytes.
+ */
+void adpcm_encode(adpcm_state_t * p_state, int16_t const * p_in, uint32_t length, uint8_t * p_out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ADPCM_H__ */
@@ -0,0 +1,63 @@
+#pragma once
+
+#ifndef BEACON_H__
+#define BEACON_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Sensor summary for the advertising payload, read by any number of scanners without a connection.
+ * Manufacturer specific data, after the company identifier:
+ *
+ *   version, sequence, x, y, z, activity, battery, flags
+ *
+ * x, y and z are the latest sample in signed 14-bit counts (4096 per g) as 16-bit LE. The activity
+ * is the mean change between successive samples since the previous summary, the sum over the three
+ * axes in counts shifted right by BEACON_ACTIVITY_SHIFT, 255 at most. The battery is the supply in
+ * 20 mV steps. The sequence goes up by one every summary so a scanner tells a new one from a repeat.
+ */
+#define BEACON_COMPANY_ID             0xFFFF                /**< Bluetooth SIG identifier for tests, until the product has its own. */
+#define BEACON_VERSION                1
+#define BEACON_DATA_LEN               11                    /**< Manufacturer data after the company identifier. */
+#define BEACON_ACTIVITY_SHIFT         2
+#define BEACON_BATTERY_STEP_MV        20
+
+#define BEACON_FLAG_SOUND             0x01                  /**< A sound is playing. */
+#define BEACON_FLAG_CONNECTABLE       0x02                  /**< A link is free for one more client. */
+#define BEACON_FLAG_STALE             0x04                  /**< No sample since the previous summary, the accelerometer is off. */
+
+/**@brief Function for starting over, at sequence 0. */
+void beacon_init(void);
+
+/**@brief Function for taking a new accelerometer sample into the summary.
+ *
+ * @param[in]   p_accel   x, y and z as signed 14-bit counts.
+ */
+void beacon_sample_put(int16_t const * p_accel);
+
+/**@brief Function for reading the supply voltage.
+ *
+ * @details One blocking SAADC conversion of VDD, some 20 us, the SAADC is off again afterwards.
+ *
+ * @return      Supply in mV.
+ */
+uint16_t beacon_supply_read(void);
+
+/**@brief Function for closing the summary window and encoding the summary.
+ *
+ * @details Measures the supply and starts the activity of the next window.
+ *
+ * @param[in]   flags    BEACON_FLAG_ set by the application.
+ * @param[out]  p_data   BEACON_DATA_LEN bytes.
+ */
+void beacon_encode(uint8_t flags, uint8_t * p_data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BEACON_H__
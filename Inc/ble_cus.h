@@ -9,10 +9,12 @@
 #include <stdbool.h>
 #include "ble.h"
 #include "ble_srv_common.h"
+#include "nrf_sdh_ble.h"
 
 //#include "timer_lib.h"
 
 #define BLE_CUS_BLE_OBSERVER_PRIO  2
+#define BLE_CUS_LINK_COUNT         NRF_SDH_BLE_PERIPHERAL_LINK_COUNT    /**< Clients served at once, one per peripheral link. */
 
 /**@brief   Macro for defining a ble_cus instance.
  *
@@ -33,6 +35,17 @@ NRF_SDH_BLE_OBSERVER(_name ## _obs,
 #define TEMPERATURE_CHAR_UUID         0x1201 
 #define COMMAND_CHAR_UUID             0x1202	
 
+#define SOUND_STATUS_CHAR_UUID        0x1203
+#define AUDIO_STREAM_CHAR_UUID        0x1204
+#define CLIP_UPLOAD_CHAR_UUID         0x1205
+
+#define ACEL_SAMPLE_LEN               6                   /**< One x/y/z sample, three left aligned 14-bit counts, little endian. */
+#define ACEL_VALUE_CHAR_MAX_LEN       240                 /**< Up to 38 raw samples after the stream frame header per notification, up to an MTU of 247. */
+#define COMMAND_CHAR_MAX_LEN          244                 /**< A frame of commands per write, see command.h, up to an MTU of 247. */
+#define SOUND_STATUS_CHAR_LEN         16                  /**< Player event: type, state, clip, voice, sample time, duration, timestamp. */
+#define AUDIO_STREAM_CHAR_MAX_LEN     244                 /**< One stream frame per write, up to an MTU of 247. */
+#define CLIP_UPLOAD_CHAR_MAX_LEN      244                 /**< One clip store block per write, up to an MTU of 247. */
+
 /* */
 #define ACEL_SERVICE_UUID_BASE         {0xBC, 0x8A, 0xBF, 0x45, 0xCA, 0x05, 0x50, 0xBA, \
                                           0x40, 0x42, 0xB0, 0x00, 0xC9, 0xAD, 0x64, 0xF3}
@@ -50,6 +63,10 @@ typedef enum
     BLE_TEMP_NOTIFICATION_ENABLED,
     BLE_TEMP_NOTIFICATION_DISABLED,
     BLE_CUS_EVT_COMMAND_RX,  
+    BLE_SOUND_STATUS_NOTIFICATION_ENABLED,
+    BLE_SOUND_STATUS_NOTIFICATION_DISABLED,
+    BLE_CUS_EVT_AUDIO_RX,
+    BLE_CUS_EVT_CLIP_RX,
 
 } ble_cus_evt_type_t;
 
@@ -67,6 +84,7 @@ typedef struct
 typedef struct
 {
    ble_cus_evt_type_t evt_type;                     
+   uint16_t           conn_handle;                  /**< Connection the event came from. */
 
    union
    {
@@ -84,6 +102,15 @@ typedef struct ble_cus_s ble_cus_t;
 typedef void (*ble_cus_evt_handler_t) (ble_cus_t * p_cus, ble_cus_evt_t * p_evt);
 
 
+/**@brief Subscriptions of one client. */
+typedef struct
+{
+    uint16_t                      conn_handle;                    /**< BLE_CONN_HANDLE_INVALID for a free entry. */
+    bool                          acel_notify;                    /**< Client enabled accelerometer notifications. */
+    bool                          sound_status_notify;            /**< Client enabled sound status notifications. */
+} ble_cus_link_t;
+
+
 /**@brief Custom Service init structure. This contains all options and data needed for
  *        initialization of the service.*/
 typedef struct
@@ -104,8 +131,10 @@ struct ble_cus_s
    
     ble_gatts_char_handles_t      temperature_value_handles;      /**< Handles related to the temperature characteristic. */
     ble_gatts_char_handles_t      command_value_handles;          /**< Handles related to the command characteristic. */
-     
-    uint16_t                      conn_handle;                    /**< Handle of the current connection (as provided by the BLE stack, is BLE_CONN_HANDLE_INVALID if not in a connection). */
+    ble_gatts_char_handles_t      sound_status_handles;           /**< Handles related to the sound status characteristic. */
+    ble_gatts_char_handles_t      audio_stream_handles;           /**< Handles related to the audio stream characteristic. */
+    ble_gatts_char_handles_t      clip_upload_handles;            /**< Handles related to the clip upload characteristic. */
+    ble_cus_link_t                links[BLE_CUS_LINK_COUNT];      /**< Subscriptions of every connected client. */
     uint8_t                       uuid_type; 
 };
 
@@ -130,15 +159,40 @@ uint32_t ble_cus_init(ble_cus_t * p_cus, ble_cus_t *p_cus_acel, const ble_cus_in
 
 /**@brief Function for updating the temperature data.
  *
- * @note 
+ * @note    The value is a stream frame header, see stream_frame.h, then the samples in its encoding,
+ *          as many as fit the negotiated MTU.
  *       
  * @param[in]   p_cus          Custom Service structure.
+ * @param[in]   conn_handle    connection to notify
  * @param[in]   p_data         data array
  * @param[in]   p_length       length
  *
- * @return      NRF_SUCCESS on success, otherwise an error code.
+ * @return      NRF_SUCCESS on success, NRF_ERROR_INVALID_STATE if that client does not listen, otherwise an error code.
+ */
+
+uint32_t acelerometer_value_update(ble_cus_t * p_cus, uint16_t conn_handle, uint8_t  * p_data, uint16_t  p_length);
+
+
+/**@brief Function for notifying a player event on the sound status characteristic, to every client listening.
+ *
+ * @param[in]   p_cus          Custom Service structure.
+ * @param[in]   p_data         encoded event
+ * @param[in]   p_length       length
+ *
+ * @return      NRF_SUCCESS on success, NRF_ERROR_INVALID_STATE if no client listens, otherwise the error of a client.
  */
 
-uint32_t acelerometer_value_update(ble_cus_t * p_cus, uint8_t  * p_data, uint16_t  p_length);
+uint32_t sound_status_update(ble_cus_t * p_cus, uint8_t  * p_data, uint16_t  p_length);
+
+
+/**@brief Function for notifying a reply on the sound status characteristic, to the one client it is for.
+ *
+ * @param[in]   p_cus          Custom Service structure.
+ * @param[in]   conn_handle    client
+ * @param[in]   p_data         encoded reply
+ * @param[in]   p_length       length
+ *
+ * @return      NRF_SUCCESS on success, NRF_ERROR_INVALID_STATE if the client does not listen, otherwise an error code.
+ */
 
-static uint8_t enableNotificationAcel;
\ No newline at end of file
+uint32_t sound_status_reply(ble_cus_t * p_cus, uint16_t conn_handle, uint8_t  * p_data, uint16_t  p_length);
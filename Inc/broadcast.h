@@ -0,0 +1,79 @@
+#pragma once
+
+#ifndef BROADCAST_H__
+#define BROADCAST_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdk_errors.h"
+#include "app_util.h"
+#include "ble_gap.h"
+
+/* Accelerometer broadcast in extended advertising, non-connectable and non-scannable, for any
+ * number of scanners without a connection. The advertising data is one manufacturer specific AD
+ * structure of up to BROADCAST_DATA_MAX bytes:
+ *
+ *   length, 0xFF, company LSB, MSB, BROADCAST_VERSION, sequence, count, samples
+ *
+ * The samples are packed in 3 x 14 bits as ACEL_FORMAT_PACKED14, see accel_codec.h. A batch is
+ * advertised until the next one is full, every BROADCAST_INTERVAL, about twice at the gesture
+ * sample rate. Scanners drop the repeats and count the batches lost by the sequence.
+ *
+ * The S140 has one advertising set, the broadcast takes it over from the connectable advertising.
+ */
+#define BROADCAST_DATA_MAX            BLE_GAP_ADV_SET_DATA_SIZE_EXTENDED_MAX_SUPPORTED
+#define BROADCAST_HEADER_LEN          7
+#define BROADCAST_BITS                14
+#define BROADCAST_SAMPLES             ((BROADCAST_DATA_MAX - BROADCAST_HEADER_LEN) * 8 / (3 * BROADCAST_BITS))
+#define BROADCAST_VERSION             2                     /**< After the beacon summary, version 1. */
+#define BROADCAST_COMPANY_ID          0xFFFF                /**< As the beacon, see beacon.h. */
+#define BROADCAST_INTERVAL            MSEC_TO_UNITS(50, UNIT_0_625_MS)
+#define BROADCAST_PRIMARY_PHY         BLE_GAP_PHY_1MBPS     /**< Advertising channels, every BLE 5 scanner listens on 1M. */
+#define BROADCAST_SECONDARY_PHY       BLE_GAP_PHY_2MBPS     /**< Batches, half the airtime of 1M. */
+
+/**@brief Broadcast statistics, since the broadcast was initialized. */
+typedef struct
+{
+	uint32_t  batches;                                      /**< Batches handed to the advertising set. */
+	uint32_t  samples;
+	uint32_t  refused;                                      /**< Batches the SoftDevice refused, their samples are lost. */
+	bool      on;
+} broadcast_stats_t;
+
+/**@brief Function for initializing the broadcast, stopped. */
+void broadcast_init(void);
+
+/**@brief Function for configuring the advertising set for the broadcast and starting it.
+ *
+ * @details The set must not be advertising.
+ *
+ * @param[in,out]  p_adv_handle   Advertising set, BLE_GAP_ADV_SET_HANDLE_NOT_SET for a new one.
+ *
+ * @return      The error of sd_ble_gap_adv_set_configure() or sd_ble_gap_adv_start().
+ */
+ret_code_t broadcast_start(uint8_t * p_adv_handle);
+
+/**@brief Function for stopping the broadcast, the batch being packed is dropped. */
+void broadcast_stop(void);
+
+/**@brief Function for packing a sample, a full batch replaces the advertised one.
+ *
+ * @param[in]   p_accel   x, y and z as signed 14-bit counts.
+ */
+void broadcast_sample_put(int16_t const * p_accel);
+
+/**@brief Function for reading the broadcast statistics.
+ *
+ * @param[out]  p_stats   Statistics.
+ */
+void broadcast_stats_get(broadcast_stats_t * p_stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BROADCAST_H__
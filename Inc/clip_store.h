@@ -0,0 +1,114 @@
+#pragma once
+
+#ifndef CLIP_STORE_H__
+#define CLIP_STORE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdk_errors.h"
+
+/* Flash region of the clip store, between the application and the FDS pages at the end of flash.
+ * The application image must stay below CLIP_STORE_START, the FLASH region of the linker script ends there.
+ */
+#define CLIP_STORE_START              0x000C0000
+#define CLIP_STORE_END                0x000FD000
+#define CLIP_STORE_PAGE_SIZE          0x1000
+
+#define CLIP_STORE_ID_FIRST           0x03                  /**< Clip identifiers for uploaded clips, 4 bits so patterns can use them. */
+#define CLIP_STORE_ID_LAST            0x0F
+
+/* Upload block (clip upload characteristic, write without response):
+ *
+ *   [offset, 4 bytes LE] [CRC16-CCITT of the payload, 2 bytes LE] then the payload
+ *
+ * The offset counts bytes of clip data. Blocks must come in order, the store acknowledges what
+ * is in flash and answers a block it cannot take with the offset it expects next.
+ */
+#define CLIP_STORE_BLOCK_HEADER_LEN   6
+
+/**@brief How an uploaded clip plays. */
+typedef struct
+{
+    uint32_t              sample_rate;                      /**< Hz. */
+    uint32_t              loop_start;                       /**< First sample of the loop. */
+    uint32_t              loop_end;                         /**< Sample after the loop, 0 if the clip plays once. */
+    uint8_t               priority;                         /**< Player priority, 0xFF for the player default. */
+} clip_store_info_t;
+
+/**@brief Clip store event types. */
+typedef enum
+{
+    CLIP_STORE_EVT_ACK     = 0x01,                          /**< offset: clip bytes written to flash so far. */
+    CLIP_STORE_EVT_NACK    = 0x02,                          /**< Block rejected, offset: next offset expected, error: reason. */
+    CLIP_STORE_EVT_DONE    = 0x03,                          /**< Clip verified and playable. */
+    CLIP_STORE_EVT_ERROR   = 0x04,                          /**< Upload aborted, error: reason. */
+    CLIP_STORE_EVT_ERASED  = 0x05,                          /**< Store erased. */
+} clip_store_evt_type_t;
+
+/**@brief Clip store event. */
+typedef struct
+{
+    clip_store_evt_type_t evt_type;
+    uint8_t               clip_id;
+    uint32_t              offset;
+    ret_code_t            error;
+    uint32_t              free;                             /**< Bytes left in the store. */
+} clip_store_evt_t;
+
+/**@brief Clip store event handler type, called from the SoftDevice event context. */
+typedef void (*clip_store_evt_handler_t)(clip_store_evt_t const * p_evt);
+
+/**@brief Function for initializing the store and registering the clips already in flash.
+ *
+ * @details Flash is written through the SoftDevice, so call after the SoftDevice is enabled.
+ */
+ret_code_t clip_store_init(clip_store_evt_handler_t evt_handler);
+
+/**@brief Function for starting an upload.
+ *
+ * @param[in]   clip_id       CLIP_STORE_ID_FIRST..CLIP_STORE_ID_LAST, replaces an older clip with that identifier.
+ * @param[in]   p_info        Rate, loop points and priority, kept with the clip.
+ * @param[in]   size          Clip bytes, 16-bit LE mono samples.
+ * @param[in]   crc           CRC16-CCITT of the whole clip.
+ *
+ * @return      NRF_SUCCESS, NRF_ERROR_INVALID_PARAM, NRF_ERROR_NO_MEM if the clip does not fit,
+ *              NRF_ERROR_BUSY during an upload or an erase, or while the chunks of an aborted upload
+ *              are still going to flash.
+ */
+ret_code_t clip_store_begin(uint8_t clip_id, clip_store_info_t const * p_info, uint32_t size, uint16_t crc);
+
+/**@brief Function for handing over one upload block, answered with an ACK or a NACK event. */
+ret_code_t clip_store_block_put(uint8_t const * p_block, uint16_t length);
+
+/**@brief Function for finishing an upload, DONE or ERROR follows once the flash is verified. */
+ret_code_t clip_store_end(void);
+
+/**@brief Function for erasing every uploaded clip, ERASED follows.
+ *
+ * @return      NRF_SUCCESS, NRF_ERROR_BUSY in the same cases as clip_store_begin(), or the fstorage error.
+ */
+ret_code_t clip_store_erase(void);
+
+/**@brief Function for looking up an uploaded clip.
+ *
+ * @param[in]   clip_id         Clip identifier.
+ * @param[out]  pp_data         Samples in flash.
+ * @param[out]  p_length        Samples.
+ * @param[out]  p_info          Rate, loop points and priority.
+ *
+ * @return      false if no clip was uploaded with that identifier.
+ */
+bool clip_store_find(uint8_t clip_id, int16_t const ** pp_data, uint32_t * p_length, clip_store_info_t * p_info);
+
+/**@brief Function for getting the bytes left in the store. */
+uint32_t clip_store_free_get(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CLIP_STORE_H__ */
@@ -0,0 +1,91 @@
+#pragma once
+
+#ifndef COMMAND_H__
+#define COMMAND_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Command frame, one write of the command characteristic:
+ *
+ *   [0xC0 | version] [sequence] then commands to the end of the write
+ *
+ * Command:
+ *
+ *   [opcode] [length] [length bytes of value]
+ *
+ * The commands run in order, each one whatever the result of those before, and the client gets one
+ * acknowledgement for the frame with the result of every command. A write that does not start with
+ * a version byte is a single command the old way, [opcode, value...], run without acknowledgement.
+ */
+#define COMMAND_FRAME_VERSION_MASK    0xF0                  /**< High nibble of the first byte of a frame. */
+#define COMMAND_FRAME_V1              0xC1                  /**< First byte of a version 1 frame. */
+#define COMMAND_FRAME_HEADER_LEN      2
+#define COMMAND_HEADER_LEN            2
+#define COMMAND_ACK_RESULTS           12                    /**< Results of the first commands of a frame, in its acknowledgement. */
+
+/**@brief Result of a command. */
+typedef enum
+{
+	COMMAND_RESULT_OK,
+	COMMAND_RESULT_UNKNOWN,                                 /**< No such opcode. */
+	COMMAND_RESULT_LENGTH,                                  /**< Value shorter than the command needs. */
+	COMMAND_RESULT_REFUSED,                                 /**< Value out of range, or the module refused it. */
+	COMMAND_RESULT_TRUNCATED,                               /**< Length past the end of the write, the frame stops here. */
+	COMMAND_RESULT_VERSION,                                 /**< Frame version not supported, nothing was run. */
+} command_result_t;
+
+/**@brief Function for running one command.
+ *
+ * @param[in]   conn_handle   Connection the command came from.
+ * @param[in]   p_value       Value, after the opcode and length.
+ * @param[in]   length        Value length, at least the min_length of the command.
+ */
+typedef command_result_t (*command_handler_t)(uint16_t conn_handle, uint8_t const * p_value, uint8_t length);
+
+/**@brief Entry of the dispatch table. */
+typedef struct
+{
+	uint8_t            opcode;
+	uint8_t            min_length;                          /**< Shortest value the handler accepts. */
+	command_handler_t  handler;
+} command_t;
+
+/**@brief Acknowledgement of a frame. */
+typedef struct
+{
+	uint8_t   sequence;                                     /**< Sequence byte of the frame. */
+	uint8_t   version;                                      /**< Version byte of the frame. */
+	uint8_t   count;                                        /**< Commands run. */
+	uint8_t   failed;                                       /**< Commands that did not return COMMAND_RESULT_OK. */
+	uint8_t   results[COMMAND_ACK_RESULTS];                 /**< command_result_t of the first commands. */
+} command_ack_t;
+
+/**@brief Function for sending the acknowledgement of a frame to the client that wrote it. */
+typedef void (*command_ack_send_t)(uint16_t conn_handle, command_ack_t const * p_ack);
+
+/**@brief Function for setting the dispatch table.
+ *
+ * @param[in]   p_table    Commands, kept by reference.
+ * @param[in]   count      Entries.
+ * @param[in]   ack_send   Sender of the acknowledgements.
+ */
+void command_init(command_t const * p_table, uint8_t count, command_ack_send_t ack_send);
+
+/**@brief Function for running the commands of one write.
+ *
+ * @param[in]   conn_handle   Connection the write came from.
+ * @param[in]   p_data        Write.
+ * @param[in]   length        Write length.
+ */
+void command_write(uint16_t conn_handle, uint8_t const * p_data, uint16_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // COMMAND_H__
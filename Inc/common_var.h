@@ -7,8 +7,6 @@
 #include "bsp.h"
 
 
-static uint16_t m_conn_handle = BLE_CONN_HANDLE_INVALID;                        /**< Handle of the current connection. */
-
 /**@brief The function for set sound play condition 
 	*/
 void set_play_sound_condition(uint8_t data);
\ No newline at end of file
@@ -0,0 +1,124 @@
+#pragma once
+
+#ifndef GESTURE_H__
+#define GESTURE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Gesture detection on the BMA280 samples and the rule table that turns gestures into sound actions.
+ *
+ * Samples are 14-bit counts at +/-2 g, 4096 counts per g, fed at GESTURE_SAMPLE_RATE. A tap is
+ * reported on the sample that crosses the tap threshold, without waiting to rule out a double tap:
+ * the second tap of a double tap is reported as a tap and as a double tap.
+ */
+#define GESTURE_SAMPLE_RATE         400                        /**< Samples per second fed to gesture_process(). */
+#define GESTURE_SAMPLE_PERIOD_US    (1000000 / GESTURE_SAMPLE_RATE)
+#define GESTURE_COUNTS_PER_G        4096
+#define GESTURE_RULES_MAX           8
+
+/**@brief Gesture events. */
+typedef enum
+{
+	GESTURE_EVT_NONE        = 0x00,                         /**< Rule slot is free. */
+	GESTURE_EVT_TAP         = 0x01,
+	GESTURE_EVT_DOUBLE_TAP  = 0x02,
+	GESTURE_EVT_THRESHOLD   = 0x03,                         /**< One axis crossed a level, away from zero. */
+	GESTURE_EVT_ORIENTATION = 0x04,                         /**< The axis closest to gravity changed. */
+} gesture_evt_type_t;
+
+/**@brief Orientations, the axis pointing up. */
+typedef enum
+{
+	GESTURE_ORIENT_X_UP     = 0x00,
+	GESTURE_ORIENT_X_DOWN   = 0x01,
+	GESTURE_ORIENT_Y_UP     = 0x02,
+	GESTURE_ORIENT_Y_DOWN   = 0x03,
+	GESTURE_ORIENT_Z_UP     = 0x04,
+	GESTURE_ORIENT_Z_DOWN   = 0x05,
+	GESTURE_ORIENT_ANY      = 0xFF,                         /**< Rule match for every orientation change. */
+} gesture_orient_t;
+
+/**@brief Sound actions. */
+typedef enum
+{
+	GESTURE_ACTION_PLAY     = 0x00,                         /**< sound_play(): the clip replaces what is playing. */
+	GESTURE_ACTION_HIT      = 0x01,                         /**< sound_hit(): the clip is layered, no fade-in. */
+	GESTURE_ACTION_STOP     = 0x02,                         /**< sound_stop(). */
+} gesture_action_t;
+
+/**@brief Rule, as received over BLE. */
+typedef struct
+{
+	uint8_t   event;                                       /**< @ref gesture_evt_type_t. */
+	uint8_t   match;                                       /**< THRESHOLD: axis 0..2, ORIENTATION: @ref gesture_orient_t, unused for taps. */
+	int16_t   level;                                       /**< THRESHOLD: level in counts, the sign gives the direction. */
+	uint8_t   action;                                      /**< @ref gesture_action_t. */
+	uint8_t   clip_id;
+	uint16_t  gain;                                        /**< HIT: q15, 0 takes the gain from the tap strength. */
+} gesture_rule_t;
+
+/**@brief Detector settings. */
+typedef struct
+{
+	uint16_t  tap_threshold;                               /**< Change between two samples that counts as a tap, counts. */
+	uint16_t  tap_shock_ms;                                /**< Dead time after a tap, the ringing of the case is not a tap. */
+	uint16_t  double_tap_ms;                               /**< Window for the second tap of a double tap. */
+	uint16_t  orientation_ms;                              /**< Time a new orientation must hold. */
+} gesture_config_t;
+
+/**@brief Handler for a matched rule, called from gesture_process().
+ *
+ * @param[in]   index    Rule slot.
+ * @param[in]   p_rule   Rule.
+ * @param[in]   gain     Gain for the action, q15: the rule gain, or the tap strength.
+ */
+typedef void (*gesture_handler_t)(uint8_t index, gesture_rule_t const * p_rule, uint16_t gain);
+
+/**@brief Function for setting up the detector and the default rules.
+ *
+ * @details Defaults: a tap hits the claves with the tap strength, a double tap hits the cuica and
+ *          turning the device face down stops the sound.
+ */
+void gesture_init(gesture_handler_t handler);
+
+/**@brief Function for changing the detector settings. */
+void gesture_config_set(gesture_config_t const * p_config);
+
+/**@brief Function for setting one rule.
+ *
+ * @param[in]   index    0..GESTURE_RULES_MAX-1.
+ * @param[in]   p_rule   Rule, event GESTURE_EVT_NONE frees the slot.
+ *
+ * @return      false if the slot or the rule is out of range.
+ */
+bool gesture_rule_set(uint8_t index, gesture_rule_t const * p_rule);
+
+/**@brief Function for knowing whether any rule needs the samples.
+ *
+ * @return      false if every slot is free.
+ */
+bool gesture_rules_active(void);
+
+/**@brief Function for restarting the detector on the next sample, after the samples were suspended.
+ *
+ * @details The last sample and the low-passed gravity are taken afresh from the next sample, a
+ *          pending tap and orientation candidate are dropped, so a move while suspended is no tap.
+ */
+void gesture_resume(void);
+
+/**@brief Function for running the detector and the rules on one sample.
+ *
+ * @param[in]   p_accel   x, y, z in counts.
+ */
+void gesture_process(int16_t const * p_accel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GESTURE_H__ */
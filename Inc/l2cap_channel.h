@@ -0,0 +1,104 @@
+#pragma once
+
+#ifndef L2CAP_CHANNEL_H__
+#define L2CAP_CHANNEL_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdk_errors.h"
+#include "ble.h"
+#include "nrf_sdh_ble.h"
+
+/* Bulk data channel, an LE credit based L2CAP channel next to the GATT service:
+ *
+ *   the central opens it on L2CAP_CHANNEL_PSM, one channel per connection
+ *   SDUs up to L2CAP_CHANNEL_SDU_MAX both ways, cut by the SoftDevice into K-frames of up to
+ *   L2CAP_CHANNEL_MPS that fill one link layer packet each at a data length of 251
+ *
+ * An SDU costs one API call and one buffer whatever its length, against one per notification of at
+ * most 244 bytes on GATT. The central gets L2CAP_CHANNEL_CREDITS credits, enough for a whole SDU.
+ */
+#define L2CAP_CHANNEL_PSM                 0x0081            /**< LE PSM, dynamic range. */
+#define L2CAP_CHANNEL_MPS                 247               /**< K-frame payload, data length 251 less the L2CAP header. */
+#define L2CAP_CHANNEL_SDU_MAX             1024              /**< Largest SDU either way. */
+#define L2CAP_CHANNEL_TX_SDUS             2                 /**< SDUs with the SoftDevice at once per channel, power of two. */
+#define L2CAP_CHANNEL_CREDITS             5                 /**< K-frames the central may send ahead, one SDU_MAX SDU and its length. */
+#define L2CAP_CHANNEL_BLE_OBSERVER_PRIO   2
+#define L2CAP_CHANNEL_LINKS               NRF_SDH_BLE_PERIPHERAL_LINK_COUNT
+
+/**@brief Channel event types. */
+typedef enum
+{
+	L2CAP_CHANNEL_EVT_OPENED,                               /**< The central opened the channel. */
+	L2CAP_CHANNEL_EVT_CLOSED,                               /**< Channel released, or the connection is gone. */
+	L2CAP_CHANNEL_EVT_RX,                                   /**< SDU received, valid during the event only. */
+	L2CAP_CHANNEL_EVT_TX_DONE,                              /**< SDU sent, its buffer is free. */
+} l2cap_channel_evt_type_t;
+
+/**@brief Channel event, from the SoftDevice event context. */
+typedef struct
+{
+	l2cap_channel_evt_type_t  evt_type;
+	uint16_t                  conn_handle;
+	uint8_t const *           p_data;                       /**< SDU of L2CAP_CHANNEL_EVT_RX. */
+	uint16_t                  length;                       /**< SDU length of L2CAP_CHANNEL_EVT_RX and L2CAP_CHANNEL_EVT_TX_DONE. */
+} l2cap_channel_evt_t;
+
+typedef void (*l2cap_channel_evt_handler_t)(l2cap_channel_evt_t const * p_evt);
+
+/**@brief Channel statistics, since the channels were initialized. */
+typedef struct
+{
+	uint32_t  sdus_sent;
+	uint32_t  bytes_sent;                                   /**< Bytes of the SDUs the central acknowledged. */
+	uint32_t  bytes_received;
+	uint32_t  tx_busy;                                      /**< Sends refused while every TX buffer was out. */
+	uint8_t   open;                                         /**< Channels open now. */
+} l2cap_channel_stats_t;
+
+/**@brief Function for initializing the channels.
+ *
+ * @details The SoftDevice needs a BLE_CONN_CFG_L2CAP configuration of one channel per connection
+ *          with these MPS and queue sizes before it is enabled.
+ *
+ * @param[in]   evt_handler   Channel events.
+ */
+void l2cap_channel_init(l2cap_channel_evt_handler_t evt_handler);
+
+/**@brief Function for the largest SDU the central of a connection takes.
+ *
+ * @return      0 if the connection has no channel open.
+ */
+uint16_t l2cap_channel_sdu_max_get(uint16_t conn_handle);
+
+/**@brief Function for sending an SDU.
+ *
+ * @details The SDU is copied, the SoftDevice sends it from the channel buffer.
+ *
+ * @param[in]   conn_handle   Connection.
+ * @param[in]   p_data        SDU.
+ * @param[in]   length        SDU length, up to l2cap_channel_sdu_max_get().
+ *
+ * @return      NRF_SUCCESS, NRF_ERROR_RESOURCES while every TX buffer is out, NRF_ERROR_INVALID_STATE
+ *              without a channel, NRF_ERROR_INVALID_LENGTH for an SDU too long.
+ */
+ret_code_t l2cap_channel_send(uint16_t conn_handle, uint8_t const * p_data, uint16_t length);
+
+/**@brief Function for reading the channel statistics.
+ *
+ * @param[out]  p_stats   Statistics.
+ */
+void l2cap_channel_stats_get(l2cap_channel_stats_t * p_stats);
+
+/**@brief Function for handling the BLE events, registered by the module. */
+void l2cap_channel_on_ble_evt(ble_evt_t const * p_ble_evt, void * p_context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // L2CAP_CHANNEL_H__
@@ -27,6 +27,7 @@ https://devzone.nordicsemi.com/nordic/short-range-guides/b/bluetooth-low-energy/
 #include "nrf_sdh_soc.h"
 #include "nrf_sdh_ble.h"
 #include "app_timer.h"
+#include "app_util_platform.h"
 #include "fds.h"
 #include "peer_manager.h"
 #include "peer_manager_handler.h"
@@ -50,6 +51,15 @@ https://devzone.nordicsemi.com/nordic/short-range-guides/b/bluetooth-low-energy/
 #include "BMA280.h"
 
 #include "I2S.h"
+#include "clip_store.h"
+#include "gesture.h"
+#include "notify_queue.h"
+#include "accel_codec.h"
+#include "command.h"
+#include "l2cap_channel.h"
+#include "beacon.h"
+#include "broadcast.h"
+#include "stream_frame.h"
 
 
 #define DEVICE_NAME                     "Mishka"                       /**< Name of device. Will be included in the advertising data. */
@@ -59,10 +69,14 @@ https://devzone.nordicsemi.com/nordic/short-range-guides/b/bluetooth-low-energy/
 #define APP_ADV_DURATION                18000                                   /**< The advertising duration (180 seconds) in units of 10 milliseconds. */
 #define APP_BLE_OBSERVER_PRIO           3                                       /**< Application's BLE observer priority. You shouldn't need to modify this value. */
 #define APP_BLE_CONN_CFG_TAG            1                                       /**< A tag identifying the SoftDevice BLE configuration. */
-
-#define MIN_CONN_INTERVAL               MSEC_TO_UNITS(100, UNIT_1_25_MS)        /**< Minimum acceptable connection interval (0.1 seconds). */
-#define MAX_CONN_INTERVAL               MSEC_TO_UNITS(200, UNIT_1_25_MS)        /**< Maximum acceptable connection interval (0.2 second). */
-#define SLAVE_LATENCY                   0                                       /**< Slave latency. */
+#define APP_HVN_TX_QUEUE_SIZE           8                                       /**< Notifications the SoftDevice holds per connection, enough for a long connection event. */
+
+#define MIN_CONN_INTERVAL               MSEC_TO_UNITS(100, UNIT_1_25_MS)        /**< Minimum acceptable connection interval (0.1 seconds), idle profile. */
+#define MAX_CONN_INTERVAL               MSEC_TO_UNITS(200, UNIT_1_25_MS)        /**< Maximum acceptable connection interval (0.2 second), idle profile. */
+#define SLAVE_LATENCY                   4                                       /**< Slave latency, idle profile: a command may wait up to 1 s. */
+#define STREAM_MIN_CONN_INTERVAL        MSEC_TO_UNITS(7.5, UNIT_1_25_MS)        /**< Minimum connection interval while streaming (7.5 ms). */
+#define STREAM_MAX_CONN_INTERVAL        MSEC_TO_UNITS(15, UNIT_1_25_MS)         /**< Maximum connection interval while streaming (15 ms). */
+#define STREAM_SLAVE_LATENCY            0                                       /**< Slave latency while streaming. */
 #define CONN_SUP_TIMEOUT                MSEC_TO_UNITS(4000, UNIT_10_MS)         /**< Connection supervisory timeout (4 seconds). */
 
 #define FIRST_CONN_PARAMS_UPDATE_DELAY  APP_TIMER_TICKS(5000)                   /**< Time from initiating event (connect or start of notification) to first time sd_ble_gap_conn_param_update is called (5 seconds). */
@@ -80,11 +94,106 @@ https://devzone.nordicsemi.com/nordic/short-range-guides/b/bluetooth-low-energy/
 
 #define DEAD_BEEF                       0xDEADBEEF                              /**< Value used as error code on stack dump, can be used to identify stack location on stack unwind. */
 
-
-static int16_t  resultBMA[4];
-static uint8_t  acelerometer[6];
-
-//static uint8_t enableNotificationAcel = 0;
+// Commands: one [opcode, value...] per write, or [0xC1, sequence, (opcode, length, value)...] acknowledged, see command.h
+#define CMD_SOUND_MASTER_GAIN           0x10                                    /**< Command: [0x10, gain LSB, gain MSB] sets the master gain (q15). */
+#define CMD_SOUND_VOICE_GAIN            0x11                                    /**< Command: [0x11, voice, gain LSB, gain MSB] sets one voice gain (q15). */
+#define CMD_SOUND_STATS                 0x12                                    /**< Command: [0x12] notifies the render statistics on the sound status characteristic. */
+#define CMD_SOUND_PLAY                  0x13                                    /**< Command: [0x13, clip (, priority)] plays a built-in or uploaded clip, see SOUND_PRIORITY_ in I2S.h. */
+#define CMD_SOUND_EQ                    0x14                                    /**< Command: [0x14, stage, post shift, b0, b1, b2, a1, a2] sets a q15 biquad of the output equalizer, 16-bit LE coefficients, [0x14, stage] ends the cascade there. */
+#define CMD_SOUND_LIMITER               0x15                                    /**< Command: [0x15, enable, threshold LSB, threshold MSB, release ms LSB, release ms MSB] sets the output limiter. */
+#define CMD_SOUND_RELEASE               0x16                                    /**< Command: [0x16] ends the clip loops and held tones, they play out to their end. */
+#define CMD_SOUND_PREARM                0x17                                    /**< Command: [0x17, enable] keeps the I2S streaming silence between sounds, 0 lets it power down after I2S_DRAIN_MS. */
+#define CMD_SOUND_CONDITION             0x18                                    /**< Command: [0x18, condition] 0 stops, 1 plays the cuica, 2 the claves, a one byte write [condition] does the same. */
+#define CMD_SOUND_TONE                  0x20                                    /**< Command: [0x20, waveform, frequency, duration, attack, decay, sustain, release] plays a tone, 16-bit LE fields, times in ms, sustain q15. */
+#define CMD_SOUND_PATTERN               0x30                                    /**< Command: [0x30, loops, tick ms LSB, tick ms MSB, (delta, clip << 4 | velocity)...] plays a sample-accurate pattern, see sequencer.h. */
+#define CMD_SOUND_STREAM                0x31                                    /**< Command: [0x31, rate LSB, rate MSB] opens the audio stream at that rate (Hz), rate 0 closes it. */
+#define CMD_CLIP_BEGIN                  0x40                                    /**< Command: [0x40, clip, rate LSB, rate MSB, size (4 bytes LE), crc LSB, crc MSB (, priority (, loop start, loop end, 4 bytes LE in samples))] starts a clip upload, see clip_store.h. */
+#define CMD_CLIP_END                    0x41                                    /**< Command: [0x41] finishes the upload, the clip is verified and committed. */
+#define CMD_CLIP_ERASE                  0x42                                    /**< Command: [0x42] erases every uploaded clip. */
+#define CMD_GESTURE_RULE                0x50                                    /**< Command: [0x50, slot, event, match, level LSB, level MSB, action, clip, gain LSB, gain MSB] sets a gesture rule, see gesture.h, event 0 frees the slot. */
+#define CMD_GESTURE_CONFIG              0x51                                    /**< Command: [0x51, tap threshold, tap shock ms, double tap ms, orientation ms] 16-bit LE, sets the gesture detector. */
+#define CMD_ACEL_FORMAT                 0x52                                    /**< Command: [0x52, format] selects the accelerometer notification format, see ACEL_FORMAT_. */
+#define CMD_ACEL_BURST                  0x53                                    /**< Command: [0x53, samples LSB, samples MSB] sends that many raw samples in SDUs on the L2CAP channel of the writer, see l2cap_channel.h, 0 stops. */
+#define CMD_LINK_BENCH                  0x54                                    /**< Command: [0x54, path, seconds] sends a test pattern for up to LINK_BENCH_SECONDS_MAX s on one LINK_BENCH_PATH_ of the writer, answered with SOUND_STATUS_BENCH. */
+#define CMD_BEACON                      0x55                                    /**< Command: [0x55, enable] puts the sensor summary of beacon.h in the advertising data, updated every second, and advertises without timeout while a link is free. */
+#define CMD_BROADCAST                   0x56                                    /**< Command: [0x56, enable] broadcasts the samples in extended non-connectable advertising, see broadcast.h, no new client can connect meanwhile. */
+
+#define SOUND_STATUS_STATS              0x80                                    /**< Sound status frame: [0x80, 0, 0, 0, render cycles max, tone cycles max, tone budget overruns]. */
+#define SOUND_STATUS_LATENCY            0x81                                    /**< Sound status frame: [0x81, 0, 0, 0, last trigger latency us, max trigger latency us, triggers over 5 ms]. */
+#define SOUND_STATUS_STREAM             0x82                                    /**< Sound status frame: [0x82, state, target, depth, jitter, underruns, late, lost, overflows] 16-bit LE after the state. */
+#define SOUND_STATUS_CLIP               0x83                                    /**< Sound status frame: [0x83, clip store event, clip, 0, offset, error, free bytes] 32-bit LE after the clip. */
+#define SOUND_STATUS_DSP                0x84                                    /**< Sound status frame: [0x84, eq stages, 0, 0, eq and limiter cycles max, budget overruns, lowest limiter gain q16] 32-bit LE after the stages. */
+#define SOUND_STATUS_GESTURE            0x85                                    /**< Sound status frame: [0x85, event, rule, clip, gain LSB, gain MSB, action, 0, RTC ticks] sent after the action of a gesture rule. */
+#define SOUND_STATUS_GESTURE_STATS      0x86                                    /**< Sound status frame: [0x86, 0, 0, 0, sample to action latency max us, samples over one period, rules run] 32-bit LE. */
+#define SOUND_STATUS_POWER              0x87                                    /**< Sound status frame: [0x87, player state, 0, 0, I2S power ups, cold start trigger latency max us, drain ms] 32-bit LE. */
+#define SOUND_STATUS_ACEL               0x89                                    /**< Sound status frame: [0x89, format, samples in the last frame LSB, MSB, encode cycles per sample, encode cycles max, samples encoded] 32-bit LE. */
+#define SOUND_STATUS_COMMAND            0x8A                                    /**< Sound status frame: [0x8A, sequence, commands run, failed, result of the first 12 commands] acknowledges a command frame, to its writer only, see command.h. */
+#define SOUND_STATUS_L2CAP              0x8B                                    /**< Sound status frame: [0x8B, channels open, sends refused LSB, MSB, SDUs sent, bytes sent, bytes received] 32-bit LE, see l2cap_channel.h. */
+#define SOUND_STATUS_BENCH              0x8C                                    /**< Sound status frame: [0x8C, path, 0, 0, bytes taken by the stack, ms, CPU cycles in the send calls per KB] 32-bit LE, to the writer of CMD_LINK_BENCH only. */
+#define SOUND_STATUS_BROADCAST          0x8D                                    /**< Sound status frame: [0x8D, broadcasting, 0, 0, batches, samples, batches refused] 32-bit LE, see broadcast.h. */
+#define SOUND_STATUS_STREAM_FRAMES      0x8E                                    /**< Sound status frame: [0x8E, 0, notifications not queued LSB, MSB, notification frames, burst frames, burst SDUs refused] 32-bit LE, see stream_frame.h. */
+#define SOUND_STATUS_NOTIFY             0x88                                    /**< Sound status frame: [0x88, frames waiting, high water, links fed, frames queued, sent, dropped] 32-bit LE, accelerometer notification queue. */
+
+	// Accelerometer sample to sound output: the gesture falls anywhere in a sample period, the sample is
+	// acted on within the next period, then the player trigger latency
+#define GESTURE_SAMPLE_INTERVAL         ROUNDED_DIV(APP_TIMER_CLOCK_FREQ, GESTURE_SAMPLE_RATE)
+#define GESTURE_LATENCY_BOUND_US        (2 * GESTURE_SAMPLE_PERIOD_US + I2S_TRIGGER_LATENCY_TARGET_US)
+
+#define ACEL_WAKE_SAMPLES               1                                       /**< Samples dropped after waking the BMA280, 1.8 ms wake-up time. */
+#define ACEL_FORMAT_RAW                 STREAM_FRAME_ENCODING_RAW               /**< Notification of ACEL_SAMPLE_LEN byte samples, left aligned as in the BMA280 registers. */
+#define ACEL_FORMAT_DELTA               STREAM_FRAME_ENCODING_DELTA             /**< Notification of a key sample and delta groups in counts, see accel_codec.h. */
+#define ACEL_FORMAT_PACKED14            STREAM_FRAME_ENCODING_PACKED14          /**< Notification of samples packed in 3 x 14 bits, see accel_codec.h. */
+#define ACEL_FORMAT_PACKED12            STREAM_FRAME_ENCODING_PACKED12          /**< Notification of samples packed in 3 x 12 bits, the 2 low bits dropped. */
+#define ACEL_STREAM_TICK_SCALE          (STREAM_FRAME_TICK_HZ / APP_TIMER_TICKS(1000)) /**< Stream frame timestamp ticks per RTC tick. */
+
+#define LINK_BENCH_PATH_NOTIFY          0                                       /**< Bench of accelerometer notifications at the payload of the link. */
+#define LINK_BENCH_PATH_L2CAP           1                                       /**< Bench of L2CAP SDUs at the SDU size of the channel. */
+#define LINK_BENCH_SECONDS_MAX          60                                      /**< Longest bench, well inside the 24-bit RTC. */
+
+
+/**@brief Connection profiles, streaming while the client listens to the accelerometer or an audio stream is open.
+ *
+ * @details The streaming profile also asks for the 2M PHY, a connection event runs on for up to
+ *          NRF_SDH_BLE_GAP_EVENT_LENGTH while there is data.
+ */
+typedef enum
+{
+	CONN_PROFILE_IDLE,
+	CONN_PROFILE_STREAMING,
+} conn_profile_t;
+
+/**@brief Context of one connection, an entry of the link table.
+ *
+ * @details The accelerometer samples are encoded once, in frames no longer than the smallest payload
+ *          of the subscribed links, and every subscribed link sends the same frames from the
+ *          notification queue at its own pace.
+ */
+typedef struct
+{
+	uint16_t       conn_handle;                                             /**< BLE_CONN_HANDLE_INVALID for a free entry. */
+	bool           acel_notify;                                             /**< Subscribed to the accelerometer, fed from the notification queue. */
+	uint16_t       payload;                                                 /**< Notification payload at the negotiated ATT MTU, up to ACEL_VALUE_CHAR_MAX_LEN. */
+	uint8_t        tx_phy;                                                  /**< PHY in use, BLE_GAP_PHY_. */
+	conn_profile_t profile;                                                 /**< Profile last asked of the central. */
+	bool           profile_pending;                                         /**< A profile change was refused as busy, retried on the next update. */
+	bool           l2cap_open;                                              /**< The client opened the L2CAP channel, streams like a subscription. */
+} link_ctx_t;
+
+/**@brief Throughput bench of one connection, run from the main loop.
+ *
+ * @details The pattern is sent as fast as the stack takes it, so over a few seconds the bytes taken
+ *          are what went over the air. The cycles spent in the send calls show the cost per byte
+ *          of each path.
+ */
+typedef struct
+{
+	volatile uint16_t conn_handle;                                          /**< BLE_CONN_HANDLE_INVALID while no bench runs. */
+	uint8_t        path;                                                    /**< LINK_BENCH_PATH_. */
+	uint32_t       start;                                                   /**< RTC ticks. */
+	uint32_t       duration;                                                /**< RTC ticks. */
+	uint32_t       bytes;                                                   /**< Bytes the stack took. */
+	uint32_t       cycles;                                                  /**< DWT cycles in the send calls. */
+} link_bench_t;
 
 /* YOUR_JOB: Declare all services structure your application is using
  *  BLE_XYZ_DEF(m_xyz);
@@ -100,3 +209,4 @@ static ble_uuid_t m_adv_uuids[] =
 
 
 static void advertising_start(bool erase_bonds);
+static void disconnect();
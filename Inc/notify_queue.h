@@ -0,0 +1,91 @@
+#pragma once
+
+#ifndef NOTIFY_QUEUE_H__
+#define NOTIFY_QUEUE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define NOTIFY_QUEUE_FRAMES           16                    /**< Frames waiting for a SoftDevice TX slot, power of two. */
+#define NOTIFY_QUEUE_FRAME_MAX        244                   /**< Largest frame, one notification at an MTU of 247. */
+#define NOTIFY_QUEUE_LINKS            3                     /**< Connections fed from the queue, at least NRF_SDH_BLE_PERIPHERAL_LINK_COUNT. */
+
+/**@brief Function for handing a frame to the SoftDevice, on one connection.
+ *
+ * @return      NRF_SUCCESS once queued for the air, NRF_ERROR_RESOURCES if every TX slot of the
+ *              connection is taken (the frame is tried again on its next TX complete), any other
+ *              error drops the frame for that connection.
+ */
+typedef uint32_t (*notify_queue_send_t)(uint16_t conn_handle, uint8_t * p_data, uint16_t length);
+
+/**@brief Queue statistics, since the queue was initialized. */
+typedef struct
+{
+	uint32_t  queued;                                       /**< Frames put, each one stored once for every connection. */
+	uint32_t  sent;                                         /**< Notifications the SoftDevice accepted, on all connections. */
+	uint32_t  dropped;                                      /**< Notifications lost on a full queue or a failed send. */
+	uint8_t   depth;                                        /**< Frames waiting now, for the connection furthest behind. */
+	uint8_t   high_water;                                   /**< Most frames ever waiting for one connection. */
+	uint8_t   links;                                        /**< Connections fed now. */
+} notify_queue_stats_t;
+
+/**@brief Function for initializing the queue.
+ *
+ * @param[in]   send   Sender of one frame, called from the main loop and the BLE event handler.
+ */
+void notify_queue_init(notify_queue_send_t send);
+
+/**@brief Function for feeding a connection from the queue.
+ *
+ * @details The connection gets the frames put from now on. A connection already fed keeps its place.
+ *
+ * @param[in]   conn_handle   Connection.
+ *
+ * @return      false if NOTIFY_QUEUE_LINKS connections are fed already.
+ */
+bool notify_queue_link_add(uint16_t conn_handle);
+
+/**@brief Function for no longer feeding a connection, on unsubscription or disconnection.
+ *
+ * @details The frames it has not sent yet are counted as dropped.
+ *
+ * @param[in]   conn_handle   Connection.
+ */
+void notify_queue_link_remove(uint16_t conn_handle);
+
+/**@brief Function for queueing a frame for every connection fed and sending what the SoftDevice takes.
+ *
+ * @details Only one context may put. The frame is copied once, whatever the number of connections.
+ *          A connection that is NOTIFY_QUEUE_FRAMES behind loses its oldest frame, so one slow
+ *          central does not hold back the others.
+ *
+ * @param[in]   p_data   Frame.
+ * @param[in]   length   Frame length, up to NOTIFY_QUEUE_FRAME_MAX.
+ *
+ * @return      false if no connection is fed or the frame is too long, the frame was dropped.
+ */
+bool notify_queue_put(uint8_t const * p_data, uint16_t length);
+
+/**@brief Function for filling the free SoftDevice TX slots of a connection from the queue.
+ *
+ * @details Called on BLE_GATTS_EVT_HVN_TX_COMPLETE, each completed packet frees one slot.
+ *
+ * @param[in]   conn_handle   Connection.
+ */
+void notify_queue_send(uint16_t conn_handle);
+
+/**@brief Function for reading the queue statistics.
+ *
+ * @param[out]  p_stats   Statistics.
+ */
+void notify_queue_stats_get(notify_queue_stats_t * p_stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NOTIFY_QUEUE_H__
@@ -0,0 +1,96 @@
+#pragma once
+
+#ifndef OUTPUT_DSP_H__
+#define OUTPUT_DSP_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Post-mix stage between the mixer and the I2S buffers: speaker equalization with a cascade of
+ * biquads, then a look-ahead peak limiter that brings the mix back into 16 bits.
+ *
+ * The samples are 32-bit so the headroom of the mix reaches the limiter. The coefficients are q15
+ * in the CMSIS-DSP arm_biquad_cascade_df1_q15 layout, per stage:
+ *
+ *   { b0, 0, b1, b2, a1, a2 }, scaled by 2^(15 - post_shift)
+ *
+ *   y[n] = (b0 * x[n] + b1 * x[n-1] + b2 * x[n-2] + a1 * y[n-1] + a2 * y[n-2]) >> (15 - post_shift)
+ *
+ * a1 and a2 have the opposite sign of the usual 1 + a1 z^-1 + a2 z^-2 denominator, as in CMSIS.
+ */
+#define OUTPUT_DSP_STAGES_MAX               4
+#define OUTPUT_DSP_COEFFS_PER_STAGE         6
+
+#define OUTPUT_DSP_LOOKAHEAD                32                 /**< Limiter delay, samples, power of two (~1.3 ms). */
+#define OUTPUT_DSP_GAIN_UNITY               0x10000            /**< Limiter gain, q16. */
+
+#define OUTPUT_DSP_BIQUAD_CYCLES_PER_SAMPLE 16                 /**< CPU cycle budget per sample and biquad stage. */
+#define OUTPUT_DSP_LIMITER_CYCLES_PER_SAMPLE 24                /**< CPU cycle budget per sample for the limiter. */
+
+/**@brief Biquad stage, as received over BLE. */
+typedef struct
+{
+	int16_t   coeffs[OUTPUT_DSP_COEFFS_PER_STAGE];         /**< { b0, 0, b1, b2, a1, a2 }. */
+	uint8_t   post_shift;                                  /**< 0..3, coefficients up to 2^post_shift. */
+} output_dsp_biquad_t;
+
+/**@brief Limiter settings. */
+typedef struct
+{
+	bool      enabled;
+	uint16_t  threshold;                                   /**< Output peak the limiter holds, 1..32767. */
+	uint16_t  release_ms;                                  /**< Time constant of the gain recovery. */
+} output_dsp_limiter_t;
+
+/**@brief Function for setting up the stage with the default speaker high-pass and limiter.
+ *
+ * @param[in]   sample_rate   Output sample rate, Hz.
+ */
+void output_dsp_init(uint32_t sample_rate);
+
+/**@brief Function for setting one biquad stage.
+ *
+ * @details Stages run in order from 0, the cascade ends at the first stage that was never set or
+ *          was cleared. The delay line of the stage is cleared.
+ *
+ * @param[in]   stage      0..OUTPUT_DSP_STAGES_MAX-1.
+ * @param[in]   p_biquad   Coefficients, NULL clears the stage and the stages after it.
+ *
+ * @return      false if the stage or the post shift is out of range.
+ */
+bool output_dsp_biquad_set(uint8_t stage, output_dsp_biquad_t const * p_biquad);
+
+/**@brief Function for changing the limiter settings. */
+void output_dsp_limiter_set(output_dsp_limiter_t const * p_limiter);
+
+/**@brief Function for processing one buffer in place.
+ *
+ * @param[in,out]  p_samples   Mix, 32-bit in, within 16 bits out when the limiter is enabled.
+ * @param[in]      count       Samples.
+ */
+void output_dsp_process(int32_t * p_samples, uint32_t count);
+
+/**@brief Function for getting the gain the limiter applies now, q16. */
+uint32_t output_dsp_gain_get(void);
+
+/**@brief Function for getting the lowest limiter gain since the last call, q16, and resetting it. */
+uint32_t output_dsp_gain_min_get(void);
+
+/**@brief Function for getting the biquad stages in the cascade. */
+uint8_t output_dsp_stages_get(void);
+
+/**@brief Function for getting the CPU cycle budget of one call to output_dsp_process().
+ *
+ * @param[in]   count   Samples.
+ */
+uint32_t output_dsp_cycles_budget(uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OUTPUT_DSP_H__ */
@@ -0,0 +1,90 @@
+#pragma once
+
+#ifndef RESAMPLER_H__
+#define RESAMPLER_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define RESAMPLER_PHASES        128                         /**< Fractional positions the filter bank is designed for. */
+#define RESAMPLER_TAPS          16                          /**< Input samples per output sample. */
+#define RESAMPLER_COEF_SHIFT    14                          /**< Filter coefficients are q14, unity DC gain per phase. */
+#define RESAMPLER_RATIO_MAX     2                           /**< Highest input to output rate ratio. */
+#define RESAMPLER_HISTORY       (RESAMPLER_TAPS / 2 - 1)    /**< Input samples read before the base sample. */
+#define RESAMPLER_LOOKAHEAD     (RESAMPLER_TAPS / 2)        /**< Input samples read after the base sample. */
+
+/**@brief Filter bank, generated at build time by Host/gen_resampler_taps.c. */
+typedef enum
+{
+	RESAMPLER_FILTER_UP,                                    /**< Input rate up to the output rate, cutoff at the input Nyquist. */
+	RESAMPLER_FILTER_DOWN2,                                 /**< Input rate up to twice the output rate, cutoff at half the input Nyquist. */
+	RESAMPLER_FILTER_COUNT
+} resampler_filter_t;
+
+/**@brief Resampler state for one stream. */
+typedef struct
+{
+	uint32_t        index;                                  /**< Input sample the next output is based on. */
+	uint32_t        frac;                                   /**< Position after index, q16. */
+	uint32_t        step;                                   /**< Input samples per output sample, q16.16. */
+	int16_t const * p_taps;                                 /**< RESAMPLER_PHASES + 1 rows of RESAMPLER_TAPS coefficients. */
+} resampler_t;
+
+/**@brief Function for setting up a stream converter.
+ *
+ * @param[out]  p_rs       Resampler state, starts at the first input sample.
+ * @param[in]   rate_in    Input sample rate, Hz.
+ * @param[in]   rate_out   Output sample rate, Hz.
+ *
+ * @return      false if the ratio is above RESAMPLER_RATIO_MAX.
+ */
+bool resampler_init(resampler_t * p_rs, uint32_t rate_in, uint32_t rate_out);
+
+/**@brief Function for converting part of a stream.
+ *
+ * @details Input samples outside of [0, length) are taken as silence, so the start and the end of
+ *          a clip need no padding.
+ *
+ * @param[in]   p_rs       Resampler state.
+ * @param[in]   p_in       Complete input signal.
+ * @param[in]   length     Input samples.
+ * @param[out]  p_out      Output samples.
+ * @param[in]   count      Output samples wanted.
+ *
+ * @return      Output samples written, less than count once the input is used up.
+ */
+uint32_t resampler_process(resampler_t * p_rs, int16_t const * p_in, uint32_t length, int16_t * p_out, uint32_t count);
+
+/**@brief Function for converting a clip that loops, the input after loop_end continues at loop_start.
+ *
+ * @details The filter reads across the loop point, so the loop is as seamless as the input is.
+ *          Before loop_start the clip plays as with resampler_process().
+ *
+ * @param[in]   p_rs         Resampler state.
+ * @param[in]   p_in         Complete input signal.
+ * @param[in]   loop_start   First input sample of the loop.
+ * @param[in]   loop_end     Input sample after the loop, above loop_start.
+ * @param[out]  p_out        Output samples.
+ * @param[in]   count        Output samples, all are written.
+ */
+void resampler_process_loop(resampler_t * p_rs, int16_t const * p_in, uint32_t loop_start, uint32_t loop_end,
+                            int16_t * p_out, uint32_t count);
+
+/**@brief Function for getting how many outputs a stream can give without reading past its input.
+ *
+ * @param[in]   p_rs       Resampler state.
+ * @param[in]   length     Input samples available, counted from the sample at p_rs->index.
+ *
+ * @return      Outputs whose filter taps are all inside the available input.
+ */
+uint32_t resampler_output_available(resampler_t const * p_rs, uint32_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RESAMPLER_H__ */
@@ -0,0 +1,274 @@
+#pragma once
+
+/* Generated by Host/gen_resampler_taps.c, do not edit.
+ * Kaiser beta 6.0, 128 phases, 16 taps, q14.
+ */
+
+#include <stdint.h>
+
+static const int16_t resampler_taps_up[RESAMPLER_PHASES + 1][RESAMPLER_TAPS] =
+{
+	{    40,  -135,   319,  -598,   944, -1288,  1543, 14734,  1543, -1288,   944,  -598,   319,  -135,    40,     0 },
+	{    41,  -135,   317,  -591,   925, -1242,  1426, 14737,  1662, -1334,   964,  -606,   321,  -135,    40,    -6 },
+	{    41,  -135,   315,  -584,   904, -1196,  1310, 14736,  1782, -1380,   983,  -613,   322,  -135,    40,    -6 },
+	{    41,  -135,   313,  -576,   884, -1149,  1195, 14726,  1903, -1425,  1002,  -619,   324,  -135,    40,    -5 },
+	{    41,  -135,   310,  -568,   864, -1103,  1081, 14721,  2025, -1470,  1020,  -626,   325,  -135,    39,    -5 },
+	{    41,  -134,   308,  -559,   843, -1057,   969, 14707,  2148, -1515,  1039,  -632,   326,  -134,    39,    -5 },
+	{    42,  -134,   305,  -551,   822, -1010,   858, 14696,  2272, -1560,  1056,  -638,   327,  -134,    38,    -5 },
+	{    42,  -134,   303,  -542,   800,  -964,   749, 14677,  2398, -1604,  1074,  -643,   328,  -133,    38,    -5 },
+	{    42,  -133,   300,  -533,   779,  -917,   640, 14661,  2524, -1648,  1091,  -649,   328,  -133,    37,    -5 },
+	{    42,  -132,   297,  -524,   757,  -870,   534, 14637,  2652, -1692,  1108,  -654,   329,  -132,    37,    -5 },
+	{    42,  -132,   294,  -515,   735,  -824,   428, 14617,  2780, -1735,  1124,  -659,   329,  -131,    36,    -5 },
+	{    42,  -131,   290,  -506,   713,  -778,   325, 14590,  2909, -1778,  1140,  -663,   329,  -130,    36,    -4 },
+	{    42,  -130,   287,  -496,   691,  -731,   222, 14560,  3040, -1820,  1155,  -667,   329,  -129,    35,    -4 },
+	{    42,  -130,   284,  -486,   669,  -685,   121, 14530,  3171, -1862,  1170,  -671,   329,  -128,    34,    -4 },
+	{    41,  -129,   280,  -476,   646,  -639,    22, 14498,  3303, -1904,  1185,  -675,   329,  -127,    34,    -4 },
+	{    41,  -128,   276,  -466,   624,  -593,   -76, 14463,  3436, -1945,  1199,  -678,   328,  -126,    33,    -4 },
+	{    41,  -127,   273,  -456,   601,  -547,  -172, 14425,  3569, -1985,  1212,  -681,   327,  -125,    32,    -3 },
+	{    41,  -126,   269,  -446,   578,  -502,  -267, 14383,  3704, -2025,  1225,  -683,   327,  -123,    32,    -3 },
+	{    41,  -125,   265,  -435,   555,  -456,  -360, 14341,  3839, -2064,  1238,  -686,   325,  -122,    31,    -3 },
+	{    41,  -123,   261,  -425,   533,  -411,  -452, 14296,  3974, -2103,  1250,  -688,   324,  -120,    30,    -3 },
+	{    40,  -122,   257,  -414,   510,  -366,  -542, 14249,  4111, -2141,  1261,  -689,   323,  -119,    29,    -3 },
+	{    40,  -121,   252,  -403,   487,  -322,  -630, 14200,  4248, -2178,  1272,  -691,   321,  -117,    28,    -2 },
+	{    40,  -120,   248,  -392,   463,  -277,  -717, 14148,  4385, -2215,  1283,  -691,   319,  -115,    27,    -2 },
+	{    39,  -118,   244,  -382,   440,  -233,  -802, 14095,  4523, -2251,  1293,  -692,   317,  -113,    26,    -2 },
+	{    39,  -117,   239,  -370,   417,  -190,  -885, 14037,  4662, -2286,  1302,  -692,   315,  -111,    25,    -1 },
+	{    39,  -115,   235,  -359,   394,  -146,  -967, 13977,  4801, -2320,  1311,  -692,   312,  -109,    24,    -1 },
+	{    39,  -114,   230,  -348,   371,  -103, -1047, 13917,  4941, -2354,  1319,  -692,   310,  -107,    23,    -1 },
+	{    38,  -112,   225,  -337,   348,   -61, -1126, 13855,  5081, -2387,  1327,  -691,   307,  -105,    22,     0 },
+	{    38,  -111,   221,  -326,   325,   -19, -1202, 13790,  5221, -2419,  1334,  -690,   304,  -103,    21,     0 },
+	{    37,  -109,   216,  -314,   302,    23, -1277, 13722,  5362, -2450,  1340,  -688,   301,  -100,    19,     0 },
+	{    37,  -107,   211,  -303,   280,    64, -1351, 13652,  5503, -2480,  1346,  -686,   297,   -98,    18,     1 },
+	{    37,  -106,   206,  -291,   257,   105, -1422, 13579,  5644, -2509,  1351,  -684,   294,   -95,    17,     1 },
+	{    36,  -104,   201,  -280,   234,   146, -1492, 13506,  5785, -2537,  1355,  -681,   290,   -92,    16,     1 },
+	{    36,  -102,   196,  -268,   211,   186, -1560, 13430,  5927, -2565,  1359,  -678,   286,   -90,    14,     2 },
+	{    35,  -101,   191,  -257,   189,   225, -1627, 13353,  6069, -2591,  1362,  -674,   282,   -87,    13,     2 },
+	{    35,   -99,   186,  -245,   167,   264, -1691, 13271,  6210, -2616,  1365,  -671,   278,   -84,    12,     2 },
+	{    34,   -97,   181,  -234,   144,   303, -1754, 13191,  6352, -2641,  1366,  -666,   273,   -81,    10,     3 },
+	{    34,   -95,   176,  -222,   122,   340, -1815, 13106,  6494, -2664,  1368,  -662,   268,   -78,     9,     3 },
+	{    33,   -93,   170,  -210,   100,   378, -1875, 13021,  6636, -2686,  1368,  -657,   263,   -75,     7,     4 },
+	{    33,   -91,   165,  -199,    78,   415, -1933, 12931,  6778, -2707,  1368,  -651,   258,   -71,     6,     4 },
+	{    32,   -89,   160,  -187,    57,   451, -1988, 12839,  6920, -2727,  1367,  -645,   253,   -68,     4,     5 },
+	{    32,   -87,   155,  -176,    35,   486, -2043, 12751,  7061, -2746,  1365,  -639,   247,   -65,     3,     5 },
+	{    31,   -85,   149,  -164,    14,   521, -2095, 12655,  7203, -2763,  1363,  -633,   242,   -61,     1,     6 },
+	{    30,   -83,   144,  -153,    -7,   556, -2146, 12561,  7344, -2780,  1360,  -626,   236,   -57,    -1,     6 },
+	{    30,   -81,   139,  -141,   -28,   590, -2194, 12460,  7485, -2795,  1356,  -618,   230,   -54,    -2,     7 },
+	{    29,   -79,   133,  -130,   -49,   623, -2242, 12367,  7625, -2809,  1351,  -611,   223,   -50,    -4,     7 },
+	{    29,   -77,   128,  -119,   -69,   655, -2287, 12262,  7766, -2821,  1346,  -602,   217,   -46,    -6,     8 },
+	{    28,   -75,   123,  -107,   -89,   687, -2331, 12160,  7906, -2833,  1340,  -594,   210,   -42,    -7,     8 },
+	{    28,   -73,   117,   -96,  -109,   718, -2372, 12056,  8045, -2843,  1333,  -585,   203,   -38,    -9,     9 },
+	{    27,   -71,   112,   -85,  -129,   749, -2413, 11951,  8184, -2851,  1326,  -576,   196,   -34,   -11,     9 },
+	{    26,   -69,   107,   -74,  -148,   779, -2451, 11843,  8323, -2859,  1317,  -566,   189,   -30,   -13,    10 },
+	{    26,   -67,   101,   -63,  -168,   808, -2488, 11735,  8461, -2865,  1308,  -556,   182,   -26,   -14,    10 },
+	{    25,   -65,    96,   -52,  -187,   836, -2523, 11624,  8598, -2869,  1299,  -545,   174,   -22,   -16,    11 },
+	{    24,   -63,    91,   -41,  -205,   864, -2556, 11513,  8735, -2873,  1288,  -535,   166,   -17,   -18,    11 },
+	{    24,   -61,    85,   -30,  -224,   891, -2587, 11397,  8871, -2874,  1277,  -523,   159,   -13,   -20,    12 },
+	{    23,   -59,    80,   -20,  -242,   918, -2617, 11284,  9007, -2875,  1265,  -512,   151,    -9,   -22,    12 },
+	{    23,   -57,    75,    -9,  -260,   943, -2645, 11167,  9142, -2874,  1252,  -500,   142,    -4,   -24,    13 },
+	{    22,   -54,    70,     1,  -277,   968, -2672, 11047,  9276, -2871,  1238,  -487,   134,     1,   -26,    14 },
+	{    21,   -52,    64,    11,  -294,   992, -2696, 10931,  9409, -2867,  1224,  -475,   125,     5,   -28,    14 },
+	{    21,   -50,    59,    22,  -311,  1016, -2720, 10808,  9541, -2861,  1209,  -462,   117,    10,   -30,    15 },
+	{    20,   -48,    54,    32,  -328,  1038, -2741, 10687,  9673, -2854,  1193,  -448,   108,    15,   -32,    15 },
+	{    20,   -46,    49,    42,  -344,  1060, -2761, 10565,  9803, -2846,  1176,  -434,    99,    19,   -34,    16 },
+	{    19,   -44,    44,    52,  -360,  1082, -2779, 10439,  9933, -2836,  1159,  -420,    90,    24,   -36,    17 },
+	{    18,   -42,    39,    61,  -375,  1102, -2796, 10317, 10061, -2824,  1141,  -406,    80,    29,   -38,    17 },
+	{    18,   -40,    34,    71,  -391,  1122, -2810, 10187, 10189, -2810,  1122,  -391,    71,    34,   -40,    18 },
+	{    17,   -38,    29,    80,  -406,  1141, -2824, 10061, 10317, -2796,  1102,  -375,    61,    39,   -42,    18 },
+	{    17,   -36,    24,    90,  -420,  1159, -2836,  9933, 10439, -2779,  1082,  -360,    52,    44,   -44,    19 },
+	{    16,   -34,    19,    99,  -434,  1176, -2846,  9803, 10565, -2761,  1060,  -344,    42,    49,   -46,    20 },
+	{    15,   -32,    15,   108,  -448,  1193, -2854,  9673, 10687, -2741,  1038,  -328,    32,    54,   -48,    20 },
+	{    15,   -30,    10,   117,  -462,  1209, -2861,  9541, 10808, -2720,  1016,  -311,    22,    59,   -50,    21 },
+	{    14,   -28,     5,   125,  -475,  1224, -2867,  9409, 10931, -2696,   992,  -294,    11,    64,   -52,    21 },
+	{    14,   -26,     1,   134,  -487,  1238, -2871,  9276, 11047, -2672,   968,  -277,     1,    70,   -54,    22 },
+	{    13,   -24,    -4,   142,  -500,  1252, -2874,  9142, 11167, -2645,   943,  -260,    -9,    75,   -57,    23 },
+	{    12,   -22,    -9,   151,  -512,  1265, -2875,  9007, 11284, -2617,   918,  -242,   -20,    80,   -59,    23 },
+	{    12,   -20,   -13,   159,  -523,  1277, -2874,  8871, 11397, -2587,   891,  -224,   -30,    85,   -61,    24 },
+	{    11,   -18,   -17,   166,  -535,  1288, -2873,  8735, 11513, -2556,   864,  -205,   -41,    91,   -63,    24 },
+	{    11,   -16,   -22,   174,  -545,  1299, -2869,  8598, 11624, -2523,   836,  -187,   -52,    96,   -65,    25 },
+	{    10,   -14,   -26,   182,  -556,  1308, -2865,  8461, 11735, -2488,   808,  -168,   -63,   101,   -67,    26 },
+	{    10,   -13,   -30,   189,  -566,  1317, -2859,  8323, 11843, -2451,   779,  -148,   -74,   107,   -69,    26 },
+	{     9,   -11,   -34,   196,  -576,  1326, -2851,  8184, 11951, -2413,   749,  -129,   -85,   112,   -71,    27 },
+	{     9,    -9,   -38,   203,  -585,  1333, -2843,  8045, 12056, -2372,   718,  -109,   -96,   117,   -73,    28 },
+	{     8,    -7,   -42,   210,  -594,  1340, -2833,  7906, 12160, -2331,   687,   -89,  -107,   123,   -75,    28 },
+	{     8,    -6,   -46,   217,  -602,  1346, -2821,  7766, 12262, -2287,   655,   -69,  -119,   128,   -77,    29 },
+	{     7,    -4,   -50,   223,  -611,  1351, -2809,  7625, 12367, -2242,   623,   -49,  -130,   133,   -79,    29 },
+	{     7,    -2,   -54,   230,  -618,  1356, -2795,  7485, 12460, -2194,   590,   -28,  -141,   139,   -81,    30 },
+	{     6,    -1,   -57,   236,  -626,  1360, -2780,  7344, 12561, -2146,   556,    -7,  -153,   144,   -83,    30 },
+	{     6,     1,   -61,   242,  -633,  1363, -2763,  7203, 12655, -2095,   521,    14,  -164,   149,   -85,    31 },
+	{     5,     3,   -65,   247,  -639,  1365, -2746,  7061, 12751, -2043,   486,    35,  -176,   155,   -87,    32 },
+	{     5,     4,   -68,   253,  -645,  1367, -2727,  6920, 12839, -1988,   451,    57,  -187,   160,   -89,    32 },
+	{     4,     6,   -71,   258,  -651,  1368, -2707,  6778, 12931, -1933,   415,    78,  -199,   165,   -91,    33 },
+	{     4,     7,   -75,   263,  -657,  1368, -2686,  6636, 13021, -1875,   378,   100,  -210,   170,   -93,    33 },
+	{     3,     9,   -78,   268,  -662,  1368, -2664,  6494, 13106, -1815,   340,   122,  -222,   176,   -95,    34 },
+	{     3,    10,   -81,   273,  -666,  1366, -2641,  6352, 13191, -1754,   303,   144,  -234,   181,   -97,    34 },
+	{     2,    12,   -84,   278,  -671,  1365, -2616,  6210, 13271, -1691,   264,   167,  -245,   186,   -99,    35 },
+	{     2,    13,   -87,   282,  -674,  1362, -2591,  6069, 13353, -1627,   225,   189,  -257,   191,  -101,    35 },
+	{     2,    14,   -90,   286,  -678,  1359, -2565,  5927, 13430, -1560,   186,   211,  -268,   196,  -102,    36 },
+	{     1,    16,   -92,   290,  -681,  1355, -2537,  5785, 13506, -1492,   146,   234,  -280,   201,  -104,    36 },
+	{     1,    17,   -95,   294,  -684,  1351, -2509,  5644, 13579, -1422,   105,   257,  -291,   206,  -106,    37 },
+	{     1,    18,   -98,   297,  -686,  1346, -2480,  5503, 13652, -1351,    64,   280,  -303,   211,  -107,    37 },
+	{     0,    19,  -100,   301,  -688,  1340, -2450,  5362, 13722, -1277,    23,   302,  -314,   216,  -109,    37 },
+	{     0,    21,  -103,   304,  -690,  1334, -2419,  5221, 13790, -1202,   -19,   325,  -326,   221,  -111,    38 },
+	{     0,    22,  -105,   307,  -691,  1327, -2387,  5081, 13855, -1126,   -61,   348,  -337,   225,  -112,    38 },
+	{    -1,    23,  -107,   310,  -692,  1319, -2354,  4941, 13917, -1047,  -103,   371,  -348,   230,  -114,    39 },
+	{    -1,    24,  -109,   312,  -692,  1311, -2320,  4801, 13977,  -967,  -146,   394,  -359,   235,  -115,    39 },
+	{    -1,    25,  -111,   315,  -692,  1302, -2286,  4662, 14037,  -885,  -190,   417,  -370,   239,  -117,    39 },
+	{    -2,    26,  -113,   317,  -692,  1293, -2251,  4523, 14095,  -802,  -233,   440,  -382,   244,  -118,    39 },
+	{    -2,    27,  -115,   319,  -691,  1283, -2215,  4385, 14148,  -717,  -277,   463,  -392,   248,  -120,    40 },
+	{    -2,    28,  -117,   321,  -691,  1272, -2178,  4248, 14200,  -630,  -322,   487,  -403,   252,  -121,    40 },
+	{    -3,    29,  -119,   323,  -689,  1261, -2141,  4111, 14249,  -542,  -366,   510,  -414,   257,  -122,    40 },
+	{    -3,    30,  -120,   324,  -688,  1250, -2103,  3974, 14296,  -452,  -411,   533,  -425,   261,  -123,    41 },
+	{    -3,    31,  -122,   325,  -686,  1238, -2064,  3839, 14341,  -360,  -456,   555,  -435,   265,  -125,    41 },
+	{    -3,    32,  -123,   327,  -683,  1225, -2025,  3704, 14383,  -267,  -502,   578,  -446,   269,  -126,    41 },
+	{    -3,    32,  -125,   327,  -681,  1212, -1985,  3569, 14425,  -172,  -547,   601,  -456,   273,  -127,    41 },
+	{    -4,    33,  -126,   328,  -678,  1199, -1945,  3436, 14463,   -76,  -593,   624,  -466,   276,  -128,    41 },
+	{    -4,    34,  -127,   329,  -675,  1185, -1904,  3303, 14498,    22,  -639,   646,  -476,   280,  -129,    41 },
+	{    -4,    34,  -128,   329,  -671,  1170, -1862,  3171, 14530,   121,  -685,   669,  -486,   284,  -130,    42 },
+	{    -4,    35,  -129,   329,  -667,  1155, -1820,  3040, 14560,   222,  -731,   691,  -496,   287,  -130,    42 },
+	{    -4,    36,  -130,   329,  -663,  1140, -1778,  2909, 14590,   325,  -778,   713,  -506,   290,  -131,    42 },
+	{    -5,    36,  -131,   329,  -659,  1124, -1735,  2780, 14617,   428,  -824,   735,  -515,   294,  -132,    42 },
+	{    -5,    37,  -132,   329,  -654,  1108, -1692,  2652, 14637,   534,  -870,   757,  -524,   297,  -132,    42 },
+	{    -5,    37,  -133,   328,  -649,  1091, -1648,  2524, 14661,   640,  -917,   779,  -533,   300,  -133,    42 },
+	{    -5,    38,  -133,   328,  -643,  1074, -1604,  2398, 14677,   749,  -964,   800,  -542,   303,  -134,    42 },
+	{    -5,    38,  -134,   327,  -638,  1056, -1560,  2272, 14696,   858, -1010,   822,  -551,   305,  -134,    42 },
+	{    -5,    39,  -134,   326,  -632,  1039, -1515,  2148, 14707,   969, -1057,   843,  -559,   308,  -134,    41 },
+	{    -5,    39,  -135,   325,  -626,  1020, -1470,  2025, 14721,  1081, -1103,   864,  -568,   310,  -135,    41 },
+	{    -5,    40,  -135,   324,  -619,  1002, -1425,  1903, 14726,  1195, -1149,   884,  -576,   313,  -135,    41 },
+	{    -6,    40,  -135,   322,  -613,   983, -1380,  1782, 14736,  1310, -1196,   904,  -584,   315,  -135,    41 },
+	{    -6,    40,  -135,   321,  -606,   964, -1334,  1662, 14737,  1426, -1242,   925,  -591,   317,  -135,    41 },
+	{     0,    40,  -135,   319,  -598,   944, -1288,  1543, 14734,  1543, -1288,   944,  -598,   319,  -135,    40 },
+};
+
+static const int16_t resampler_taps_down2[RESAMPLER_PHASES + 1][RESAMPLER_TAPS] =
+{
+	{   -23,   115,   225,  -369, -1039,   676,  4926,  7362,  4926,   676, -1039,  -369,   225,   115,   -23,     0 },
+	{   -23,   113,   226,  -362, -1040,   650,  4896,  7364,  4962,   703, -1038,  -377,   224,   117,   -22,    -9 },
+	{   -23,   111,   228,  -355, -1041,   624,  4863,  7365,  4995,   730, -1037,  -385,   223,   118,   -22,   -10 },
+	{   -23,   110,   229,  -347, -1041,   598,  4829,  7363,  5028,   757, -1036,  -392,   221,   120,   -22,   -10 },
+	{   -24,   108,   230,  -340, -1042,   572,  4796,  7363,  5061,   784, -1034,  -400,   220,   122,   -22,   -10 },
+	{   -24,   106,   231,  -333, -1042,   546,  4762,  7360,  5094,   812, -1033,  -407,   219,   124,   -21,   -10 },
+	{   -24,   105,   232,  -325, -1042,   521,  4728,  7359,  5126,   839, -1031,  -415,   217,   125,   -21,   -10 },
+	{   -24,   103,   233,  -318, -1042,   495,  4694,  7357,  5159,   867, -1029,  -422,   216,   127,   -21,   -11 },
+	{   -25,   101,   233,  -311, -1042,   470,  4660,  7357,  5191,   895, -1027,  -430,   214,   129,   -20,   -11 },
+	{   -25,   100,   234,  -303, -1041,   445,  4626,  7353,  5223,   923, -1025,  -438,   212,   131,   -20,   -11 },
+	{   -25,    98,   235,  -296, -1041,   420,  4592,  7348,  5255,   952, -1022,  -445,   211,   132,   -19,   -11 },
+	{   -25,    96,   236,  -289, -1040,   396,  4558,  7346,  5287,   980, -1020,  -453,   209,   134,   -19,   -12 },
+	{   -25,    94,   236,  -282, -1039,   372,  4524,  7341,  5319,  1009, -1017,  -460,   207,   136,   -19,   -12 },
+	{   -25,    93,   237,  -275, -1038,   347,  4489,  7336,  5351,  1038, -1014,  -468,   205,   138,   -18,   -12 },
+	{   -26,    91,   237,  -268, -1037,   323,  4455,  7336,  5382,  1066, -1011,  -476,   203,   139,   -18,   -12 },
+	{   -26,    89,   238,  -260, -1036,   300,  4420,  7327,  5413,  1096, -1007,  -483,   201,   141,   -17,   -12 },
+	{   -26,    88,   238,  -253, -1035,   276,  4385,  7325,  5444,  1125, -1004,  -491,   199,   143,   -17,   -13 },
+	{   -26,    86,   239,  -246, -1033,   253,  4351,  7317,  5475,  1154, -1000,  -499,   197,   145,   -16,   -13 },
+	{   -26,    85,   239,  -239, -1032,   230,  4316,  7311,  5506,  1184,  -996,  -506,   195,   146,   -16,   -13 },
+	{   -26,    83,   239,  -232, -1030,   207,  4281,  7304,  5537,  1214,  -992,  -514,   193,   148,   -15,   -13 },
+	{   -26,    81,   240,  -225, -1028,   184,  4246,  7299,  5567,  1244,  -988,  -522,   191,   150,   -15,   -14 },
+	{   -26,    80,   240,  -219, -1026,   161,  4211,  7292,  5597,  1274,  -983,  -529,   189,   151,   -14,   -14 },
+	{   -26,    78,   240,  -212, -1024,   139,  4176,  7287,  5627,  1304,  -979,  -537,   186,   153,   -14,   -14 },
+	{   -26,    77,   240,  -205, -1021,   117,  4141,  7275,  5657,  1335,  -974,  -544,   184,   155,   -13,   -14 },
+	{   -26,    75,   241,  -198, -1019,    95,  4106,  7268,  5687,  1365,  -969,  -552,   181,   157,   -13,   -14 },
+	{   -26,    73,   241,  -191, -1016,    73,  4071,  7261,  5716,  1396,  -964,  -560,   179,   158,   -12,   -15 },
+	{   -27,    72,   241,  -185, -1014,    52,  4035,  7254,  5746,  1427,  -959,  -567,   176,   160,   -12,   -15 },
+	{   -27,    70,   241,  -178, -1011,    30,  4000,  7244,  5775,  1458,  -953,  -575,   174,   162,   -11,   -15 },
+	{   -27,    69,   241,  -171, -1008,     9,  3965,  7233,  5804,  1489,  -947,  -582,   171,   163,   -10,   -15 },
+	{   -27,    67,   241,  -165, -1005,   -12,  3929,  7227,  5833,  1520,  -941,  -590,   168,   165,   -10,   -16 },
+	{   -27,    66,   240,  -158, -1002,   -32,  3894,  7216,  5861,  1552,  -935,  -598,   165,   167,    -9,   -16 },
+	{   -27,    64,   240,  -152,  -999,   -53,  3859,  7207,  5890,  1583,  -929,  -605,   163,   168,    -9,   -16 },
+	{   -27,    63,   240,  -145,  -995,   -73,  3823,  7194,  5918,  1615,  -922,  -613,   160,   170,    -8,   -16 },
+	{   -27,    61,   240,  -139,  -992,   -93,  3788,  7184,  5946,  1647,  -916,  -620,   157,   172,    -7,   -17 },
+	{   -27,    60,   240,  -132,  -988,  -113,  3752,  7174,  5973,  1679,  -909,  -628,   154,   173,    -7,   -17 },
+	{   -26,    58,   239,  -126,  -985,  -132,  3716,  7162,  6001,  1711,  -902,  -635,   151,   175,    -6,   -17 },
+	{   -26,    57,   239,  -120,  -981,  -152,  3681,  7150,  6028,  1743,  -894,  -643,   147,   177,    -5,   -17 },
+	{   -26,    55,   239,  -114,  -977,  -171,  3645,  7139,  6055,  1775,  -887,  -650,   144,   178,    -4,   -17 },
+	{   -26,    54,   238,  -107,  -973,  -190,  3610,  7125,  6082,  1808,  -879,  -657,   141,   180,    -4,   -18 },
+	{   -26,    52,   238,  -101,  -969,  -209,  3574,  7113,  6109,  1840,  -871,  -665,   138,   182,    -3,   -18 },
+	{   -26,    51,   237,   -95,  -964,  -227,  3538,  7100,  6135,  1873,  -863,  -672,   134,   183,    -2,   -18 },
+	{   -26,    49,   237,   -89,  -960,  -245,  3503,  7084,  6162,  1906,  -855,  -679,   131,   185,    -1,   -18 },
+	{   -26,    48,   236,   -83,  -956,  -264,  3467,  7075,  6188,  1939,  -846,  -687,   127,   186,    -1,   -19 },
+	{   -26,    47,   236,   -77,  -951,  -281,  3432,  7058,  6213,  1972,  -838,  -694,   124,   188,     0,   -19 },
+	{   -26,    45,   235,   -71,  -947,  -299,  3396,  7046,  6239,  2005,  -829,  -701,   120,   189,     1,   -19 },
+	{   -26,    44,   234,   -66,  -942,  -317,  3360,  7032,  6264,  2039,  -820,  -708,   116,   191,     2,   -19 },
+	{   -26,    43,   234,   -60,  -937,  -334,  3325,  7015,  6289,  2072,  -810,  -715,   113,   192,     3,   -20 },
+	{   -26,    41,   233,   -54,  -932,  -351,  3289,  7002,  6314,  2105,  -801,  -723,   109,   194,     4,   -20 },
+	{   -26,    40,   232,   -48,  -927,  -368,  3254,  6985,  6339,  2139,  -791,  -730,   105,   195,     5,   -20 },
+	{   -25,    39,   231,   -43,  -922,  -384,  3218,  6969,  6363,  2173,  -781,  -737,   101,   197,     5,   -20 },
+	{   -25,    37,   231,   -37,  -917,  -401,  3182,  6954,  6387,  2207,  -771,  -744,    97,   198,     6,   -20 },
+	{   -25,    36,   230,   -32,  -912,  -417,  3147,  6939,  6411,  2240,  -761,  -751,    93,   200,     7,   -21 },
+	{   -25,    35,   229,   -26,  -906,  -433,  3111,  6921,  6435,  2274,  -750,  -758,    89,   201,     8,   -21 },
+	{   -25,    34,   228,   -21,  -901,  -448,  3076,  6903,  6458,  2308,  -739,  -764,    85,   202,     9,   -21 },
+	{   -25,    32,   227,   -15,  -895,  -464,  3041,  6884,  6481,  2343,  -728,  -771,    81,   204,    10,   -21 },
+	{   -25,    31,   226,   -10,  -890,  -479,  3005,  6869,  6504,  2377,  -717,  -778,    76,   205,    11,   -21 },
+	{   -24,    30,   225,    -5,  -884,  -494,  2970,  6851,  6526,  2411,  -706,  -785,    72,   207,    12,   -22 },
+	{   -24,    29,   224,     1,  -879,  -509,  2934,  6831,  6549,  2446,  -694,  -791,    68,   208,    13,   -22 },
+	{   -24,    27,   223,     6,  -873,  -524,  2899,  6815,  6571,  2480,  -682,  -798,    63,   209,    14,   -22 },
+	{   -24,    26,   222,    11,  -867,  -538,  2864,  6795,  6592,  2515,  -670,  -805,    59,   211,    15,   -22 },
+	{   -24,    25,   221,    16,  -861,  -552,  2829,  6776,  6614,  2549,  -658,  -811,    54,   212,    16,   -22 },
+	{   -24,    24,   220,    21,  -855,  -566,  2794,  6758,  6635,  2584,  -646,  -818,    50,   213,    17,   -23 },
+	{   -24,    23,   219,    26,  -849,  -580,  2759,  6738,  6656,  2619,  -633,  -824,    45,   214,    18,   -23 },
+	{   -23,    22,   218,    31,  -843,  -594,  2724,  6717,  6677,  2654,  -620,  -830,    40,   215,    19,   -23 },
+	{   -23,    21,   217,    36,  -837,  -607,  2689,  6695,  6697,  2689,  -607,  -837,    36,   217,    21,   -23 },
+	{   -23,    19,   215,    40,  -830,  -620,  2654,  6677,  6717,  2724,  -594,  -843,    31,   218,    22,   -23 },
+	{   -23,    18,   214,    45,  -824,  -633,  2619,  6656,  6738,  2759,  -580,  -849,    26,   219,    23,   -24 },
+	{   -23,    17,   213,    50,  -818,  -646,  2584,  6635,  6758,  2794,  -566,  -855,    21,   220,    24,   -24 },
+	{   -22,    16,   212,    54,  -811,  -658,  2549,  6614,  6776,  2829,  -552,  -861,    16,   221,    25,   -24 },
+	{   -22,    15,   211,    59,  -805,  -670,  2515,  6592,  6795,  2864,  -538,  -867,    11,   222,    26,   -24 },
+	{   -22,    14,   209,    63,  -798,  -682,  2480,  6571,  6815,  2899,  -524,  -873,     6,   223,    27,   -24 },
+	{   -22,    13,   208,    68,  -791,  -694,  2446,  6549,  6831,  2934,  -509,  -879,     1,   224,    29,   -24 },
+	{   -22,    12,   207,    72,  -785,  -706,  2411,  6526,  6851,  2970,  -494,  -884,    -5,   225,    30,   -24 },
+	{   -21,    11,   205,    76,  -778,  -717,  2377,  6504,  6869,  3005,  -479,  -890,   -10,   226,    31,   -25 },
+	{   -21,    10,   204,    81,  -771,  -728,  2343,  6481,  6884,  3041,  -464,  -895,   -15,   227,    32,   -25 },
+	{   -21,     9,   202,    85,  -764,  -739,  2308,  6458,  6903,  3076,  -448,  -901,   -21,   228,    34,   -25 },
+	{   -21,     8,   201,    89,  -758,  -750,  2274,  6435,  6921,  3111,  -433,  -906,   -26,   229,    35,   -25 },
+	{   -21,     7,   200,    93,  -751,  -761,  2240,  6411,  6939,  3147,  -417,  -912,   -32,   230,    36,   -25 },
+	{   -20,     6,   198,    97,  -744,  -771,  2207,  6387,  6954,  3182,  -401,  -917,   -37,   231,    37,   -25 },
+	{   -20,     5,   197,   101,  -737,  -781,  2173,  6363,  6969,  3218,  -384,  -922,   -43,   231,    39,   -25 },
+	{   -20,     5,   195,   105,  -730,  -791,  2139,  6339,  6985,  3254,  -368,  -927,   -48,   232,    40,   -26 },
+	{   -20,     4,   194,   109,  -723,  -801,  2105,  6314,  7002,  3289,  -351,  -932,   -54,   233,    41,   -26 },
+	{   -20,     3,   192,   113,  -715,  -810,  2072,  6289,  7015,  3325,  -334,  -937,   -60,   234,    43,   -26 },
+	{   -19,     2,   191,   116,  -708,  -820,  2039,  6264,  7032,  3360,  -317,  -942,   -66,   234,    44,   -26 },
+	{   -19,     1,   189,   120,  -701,  -829,  2005,  6239,  7046,  3396,  -299,  -947,   -71,   235,    45,   -26 },
+	{   -19,     0,   188,   124,  -694,  -838,  1972,  6213,  7058,  3432,  -281,  -951,   -77,   236,    47,   -26 },
+	{   -19,    -1,   186,   127,  -687,  -846,  1939,  6188,  7075,  3467,  -264,  -956,   -83,   236,    48,   -26 },
+	{   -18,    -1,   185,   131,  -679,  -855,  1906,  6162,  7084,  3503,  -245,  -960,   -89,   237,    49,   -26 },
+	{   -18,    -2,   183,   134,  -672,  -863,  1873,  6135,  7100,  3538,  -227,  -964,   -95,   237,    51,   -26 },
+	{   -18,    -3,   182,   138,  -665,  -871,  1840,  6109,  7113,  3574,  -209,  -969,  -101,   238,    52,   -26 },
+	{   -18,    -4,   180,   141,  -657,  -879,  1808,  6082,  7125,  3610,  -190,  -973,  -107,   238,    54,   -26 },
+	{   -17,    -4,   178,   144,  -650,  -887,  1775,  6055,  7139,  3645,  -171,  -977,  -114,   239,    55,   -26 },
+	{   -17,    -5,   177,   147,  -643,  -894,  1743,  6028,  7150,  3681,  -152,  -981,  -120,   239,    57,   -26 },
+	{   -17,    -6,   175,   151,  -635,  -902,  1711,  6001,  7162,  3716,  -132,  -985,  -126,   239,    58,   -26 },
+	{   -17,    -7,   173,   154,  -628,  -909,  1679,  5973,  7174,  3752,  -113,  -988,  -132,   240,    60,   -27 },
+	{   -17,    -7,   172,   157,  -620,  -916,  1647,  5946,  7184,  3788,   -93,  -992,  -139,   240,    61,   -27 },
+	{   -16,    -8,   170,   160,  -613,  -922,  1615,  5918,  7194,  3823,   -73,  -995,  -145,   240,    63,   -27 },
+	{   -16,    -9,   168,   163,  -605,  -929,  1583,  5890,  7207,  3859,   -53,  -999,  -152,   240,    64,   -27 },
+	{   -16,    -9,   167,   165,  -598,  -935,  1552,  5861,  7216,  3894,   -32, -1002,  -158,   240,    66,   -27 },
+	{   -16,   -10,   165,   168,  -590,  -941,  1520,  5833,  7227,  3929,   -12, -1005,  -165,   241,    67,   -27 },
+	{   -15,   -10,   163,   171,  -582,  -947,  1489,  5804,  7233,  3965,     9, -1008,  -171,   241,    69,   -27 },
+	{   -15,   -11,   162,   174,  -575,  -953,  1458,  5775,  7244,  4000,    30, -1011,  -178,   241,    70,   -27 },
+	{   -15,   -12,   160,   176,  -567,  -959,  1427,  5746,  7254,  4035,    52, -1014,  -185,   241,    72,   -27 },
+	{   -15,   -12,   158,   179,  -560,  -964,  1396,  5716,  7261,  4071,    73, -1016,  -191,   241,    73,   -26 },
+	{   -14,   -13,   157,   181,  -552,  -969,  1365,  5687,  7268,  4106,    95, -1019,  -198,   241,    75,   -26 },
+	{   -14,   -13,   155,   184,  -544,  -974,  1335,  5657,  7275,  4141,   117, -1021,  -205,   240,    77,   -26 },
+	{   -14,   -14,   153,   186,  -537,  -979,  1304,  5627,  7287,  4176,   139, -1024,  -212,   240,    78,   -26 },
+	{   -14,   -14,   151,   189,  -529,  -983,  1274,  5597,  7292,  4211,   161, -1026,  -219,   240,    80,   -26 },
+	{   -14,   -15,   150,   191,  -522,  -988,  1244,  5567,  7299,  4246,   184, -1028,  -225,   240,    81,   -26 },
+	{   -13,   -15,   148,   193,  -514,  -992,  1214,  5537,  7304,  4281,   207, -1030,  -232,   239,    83,   -26 },
+	{   -13,   -16,   146,   195,  -506,  -996,  1184,  5506,  7311,  4316,   230, -1032,  -239,   239,    85,   -26 },
+	{   -13,   -16,   145,   197,  -499, -1000,  1154,  5475,  7317,  4351,   253, -1033,  -246,   239,    86,   -26 },
+	{   -13,   -17,   143,   199,  -491, -1004,  1125,  5444,  7325,  4385,   276, -1035,  -253,   238,    88,   -26 },
+	{   -12,   -17,   141,   201,  -483, -1007,  1096,  5413,  7327,  4420,   300, -1036,  -260,   238,    89,   -26 },
+	{   -12,   -18,   139,   203,  -476, -1011,  1066,  5382,  7336,  4455,   323, -1037,  -268,   237,    91,   -26 },
+	{   -12,   -18,   138,   205,  -468, -1014,  1038,  5351,  7336,  4489,   347, -1038,  -275,   237,    93,   -25 },
+	{   -12,   -19,   136,   207,  -460, -1017,  1009,  5319,  7341,  4524,   372, -1039,  -282,   236,    94,   -25 },
+	{   -12,   -19,   134,   209,  -453, -1020,   980,  5287,  7346,  4558,   396, -1040,  -289,   236,    96,   -25 },
+	{   -11,   -19,   132,   211,  -445, -1022,   952,  5255,  7348,  4592,   420, -1041,  -296,   235,    98,   -25 },
+	{   -11,   -20,   131,   212,  -438, -1025,   923,  5223,  7353,  4626,   445, -1041,  -303,   234,   100,   -25 },
+	{   -11,   -20,   129,   214,  -430, -1027,   895,  5191,  7357,  4660,   470, -1042,  -311,   233,   101,   -25 },
+	{   -11,   -21,   127,   216,  -422, -1029,   867,  5159,  7357,  4694,   495, -1042,  -318,   233,   103,   -24 },
+	{   -10,   -21,   125,   217,  -415, -1031,   839,  5126,  7359,  4728,   521, -1042,  -325,   232,   105,   -24 },
+	{   -10,   -21,   124,   219,  -407, -1033,   812,  5094,  7360,  4762,   546, -1042,  -333,   231,   106,   -24 },
+	{   -10,   -22,   122,   220,  -400, -1034,   784,  5061,  7363,  4796,   572, -1042,  -340,   230,   108,   -24 },
+	{   -10,   -22,   120,   221,  -392, -1036,   757,  5028,  7363,  4829,   598, -1041,  -347,   229,   110,   -23 },
+	{   -10,   -22,   118,   223,  -385, -1037,   730,  4995,  7365,  4863,   624, -1041,  -355,   228,   111,   -23 },
+	{    -9,   -22,   117,   224,  -377, -1038,   703,  4962,  7364,  4896,   650, -1040,  -362,   226,   113,   -23 },
+	{     0,   -23,   115,   225,  -369, -1039,   676,  4926,  7362,  4926,   676, -1039,  -369,   225,   115,   -23 },
+};
+
@@ -0,0 +1,72 @@
+#pragma once
+
+#ifndef SEQUENCER_H__
+#define SEQUENCER_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SEQUENCER_MAX_STEPS     32                          /**< Hits per pattern. */
+#define SEQUENCER_LOOP_FOREVER  0                           /**< Loop count value for an endless pattern. */
+
+/* Pattern wire format (command payload after the opcode):
+ *
+ *   [loops] [tick_ms LSB] [tick_ms MSB] then 2 bytes per step: [delta] [clip << 4 | velocity]
+ *
+ * delta is the time since the previous step in ticks, clip 0 is a rest that only moves time on.
+ * The pattern period is the time of the last step, so a trailing rest sets the loop length.
+ * velocity 0..15 maps linearly to the hit gain, 15 is unity.
+ */
+
+/**@brief One scheduled hit. */
+typedef struct
+{
+	uint32_t  offset;                                       /**< Samples from the start of the pattern. */
+	uint16_t  gain;                                         /**< q15. */
+	uint8_t   clip_id;
+} sequencer_step_t;
+
+/**@brief Callback starting a hit.
+ *
+ * @param[in]   clip_id   Clip to start.
+ * @param[in]   gain      Hit gain, q15.
+ * @param[in]   delay     Samples into the buffer being rendered where the hit starts.
+ */
+typedef void (*sequencer_trigger_t)(uint8_t clip_id, uint16_t gain, uint32_t delay);
+
+/**@brief Function for decoding a pattern and arming it, replaces any running pattern.
+ *
+ * @param[in]   p_data       Pattern in wire format.
+ * @param[in]   length       Length of p_data.
+ * @param[in]   sample_rate  Output sample rate, Hz.
+ * @param[in]   start        Output timeline position of the first tick, samples.
+ *
+ * @return      false if the pattern is malformed, nothing is changed then.
+ */
+bool sequencer_load(uint8_t const * p_data, uint16_t length, uint32_t sample_rate, uint32_t start);
+
+/**@brief Function for stopping the running pattern. Hits already started keep playing. */
+void sequencer_stop(void);
+
+/**@brief Function for checking if a pattern is armed. */
+bool sequencer_active(void);
+
+/**@brief Function for starting every hit that falls into the buffer being rendered.
+ *
+ * @param[in]   timeline   Output timeline position of the first sample of the buffer.
+ * @param[in]   count      Samples in the buffer.
+ * @param[in]   trigger    Called for each hit, in time order.
+ *
+ * @return      true if the pattern played its last loop in this buffer.
+ */
+bool sequencer_process(uint32_t timeline, uint32_t count, sequencer_trigger_t trigger);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SEQUENCER_H__ */
@@ -0,0 +1,89 @@
+#pragma once
+
+#ifndef SOUND_STREAM_H__
+#define SOUND_STREAM_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SOUND_STREAM_BUFFER_SAMPLES   8192                  /**< Jitter buffer, power of two (~0.5 s at 16 kHz). */
+#define SOUND_STREAM_DEPTH_MIN        256                   /**< Smallest playout depth, samples at the stream rate. */
+
+/* Stream frame (audio stream characteristic, write without response):
+ *
+ *   [seq] [flags] [predictor LSB] [predictor MSB] [step index] then the payload
+ *
+ * ADPCM payloads are IMA ADPCM, two samples per byte, low nibble first, decoded from the
+ * predictor and step index of the header so a frame never depends on the one before it.
+ * PCM payloads are 16-bit LE samples, the predictor and step index are ignored.
+ */
+#define SOUND_STREAM_HEADER_LEN       5
+#define SOUND_STREAM_FLAG_PCM         0x01                  /**< Payload is 16-bit PCM instead of ADPCM. */
+#define SOUND_STREAM_FLAG_END         0x02                  /**< Last frame, the stream closes once it has played. */
+
+/**@brief Jitter buffer states. */
+typedef enum
+{
+	SOUND_STREAM_CLOSED,                                    /**< No stream. */
+	SOUND_STREAM_BUFFERING,                                 /**< Waiting for the playout depth before playing. */
+	SOUND_STREAM_PLAYING,
+	SOUND_STREAM_DRAINING,                                  /**< END received, playing what is left. */
+} sound_stream_state_t;
+
+/**@brief Stream statistics, since the stream was opened. */
+typedef struct
+{
+	sound_stream_state_t state;
+	uint16_t  depth;                                        /**< Samples buffered now. */
+	uint16_t  target;                                       /**< Playout depth the buffer adapts to, samples. */
+	uint16_t  jitter;                                       /**< Mean frame arrival deviation, samples. */
+	uint16_t  underruns;                                    /**< Times the buffer ran dry while playing. */
+	uint16_t  late_frames;                                  /**< Frames out of sequence or arriving while the buffer was dry. */
+	uint16_t  lost_frames;                                  /**< Sequence numbers never received. */
+	uint16_t  overflows;                                    /**< Frames dropped on a full buffer. */
+} sound_stream_stats_t;
+
+/**@brief Function for opening a stream, drops anything left from a previous one.
+ *
+ * @param[in]   sample_rate   Stream rate, Hz.
+ * @param[in]   output_rate   Rate sound_stream_read() produces, Hz.
+ *
+ * @return      false if the rate cannot be converted to the output rate.
+ */
+bool sound_stream_open(uint32_t sample_rate, uint32_t output_rate);
+
+/**@brief Function for closing the stream at once. */
+void sound_stream_close(void);
+
+/**@brief Function for adding a received frame to the jitter buffer.
+ *
+ * @param[in]   p_frame   Frame as written by the client.
+ * @param[in]   length    Frame length.
+ *
+ * @return      false if the frame was malformed or dropped.
+ */
+bool sound_stream_frame_put(uint8_t const * p_frame, uint16_t length);
+
+/**@brief Function for reading the stream converted to the output rate, called by the mixer.
+ *
+ * @details Missing samples are silence. Only one context may read.
+ *
+ * @param[out]  p_out   Output samples.
+ * @param[in]   count   Samples wanted, p_out is always filled.
+ *
+ * @return      false once the stream is closed and everything has been played.
+ */
+bool sound_stream_read(int16_t * p_out, uint32_t count);
+
+/**@brief Function for getting the jitter buffer statistics. */
+void sound_stream_stats_get(sound_stream_stats_t * p_stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SOUND_STREAM_H__ */
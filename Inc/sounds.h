@@ -4,13 +4,13 @@
 * No. of channels:	1
 * No. of samples:	50695
 * Bits/Sample:		16
-* static uint16_t sine_claves[]
-* static uint16_t sine_cuica[]
+* static const int16_t sine_claves[]
+* static const int16_t sine_cuica[]
 **********************************************************************/
 
 //Claves.wav
 
-static uint16_t sine_claves[] = {
+static const int16_t sine_claves[] = {
 -56, -69, -54,  -9, 200, 671, 1311, 2189, /* 0-7 */
 3138, 3034, 808, -2631, -6041, -9481, -12231, -13173, /* 8-15 */
 -12263, -9314, -2884, 5301, 12920, 20114, 24676, 23723, /* 16-23 */
@@ -6123,7 +6123,7 @@ static uint16_t sine_claves[] = {
 
 //Cuica
 
-static uint16_t sine_cuica[] = {
+static const int16_t sine_cuica[] = {
 	-96,
 	-71,
 	-59,
@@ -0,0 +1,118 @@
+#pragma once
+
+#ifndef STREAM_FRAME_H__
+#define STREAM_FRAME_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Header in front of every frame of a sample stream, STREAM_FRAME_HEADER_LEN bytes:
+ *
+ *   [stream id] [flags] [sequence LSB] [sequence MSB] [timestamp, 4 bytes LE] [count LSB] [count MSB]
+ *
+ * The sequence goes up by one for every frame built on the stream, also for the frames lost on the
+ * way, so the receiver tells a gap, a duplicate and a frame out of order apart. The timestamp is the
+ * device time of the first sample in STREAM_FRAME_TICK_HZ ticks, count the samples after the header.
+ * The low nibble of the flags is the encoding of the samples.
+ */
+#define STREAM_FRAME_HEADER_LEN       10
+#define STREAM_FRAME_TICK_HZ          32768                 /**< RTC ticks, the 32-bit timestamp wraps after 36 hours. */
+
+#define STREAM_ID_ACEL_NOTIFY         1                     /**< Accelerometer notifications. */
+#define STREAM_ID_ACEL_BURST          2                     /**< Accelerometer bursts on the L2CAP channel. */
+
+#define STREAM_FRAME_ENCODING_RAW     0                     /**< ACEL_SAMPLE_LEN byte samples, left aligned as in the BMA280 registers. */
+#define STREAM_FRAME_ENCODING_DELTA   1                     /**< Key sample and delta groups, see accel_codec.h. */
+#define STREAM_FRAME_ENCODING_PACKED14 2                    /**< 3 x 14 bits, see accel_codec.h. */
+#define STREAM_FRAME_ENCODING_PACKED12 3                    /**< 3 x 12 bits, the 2 low bits dropped. */
+#define STREAM_FRAME_ENCODING_MASK    0x0F
+#define STREAM_FRAME_FLAG_RESUMED     0x80                  /**< The first sample does not follow the last one of the frame before: sampling restarted or a frame in the making was dropped. */
+
+#define STREAM_FRAME_WINDOW           32                    /**< Frames behind the newest one the receiver still places. */
+
+/**@brief Header of a frame. */
+typedef struct
+{
+	uint8_t   stream_id;
+	uint8_t   flags;
+	uint16_t  sequence;
+	uint32_t  timestamp;
+	uint16_t  count;
+} stream_frame_header_t;
+
+/**@brief Sending side of a stream. */
+typedef struct
+{
+	uint8_t   stream_id;
+	uint8_t   resumed;                                      /**< STREAM_FRAME_FLAG_RESUMED for the next frame. */
+	uint16_t  sequence;                                     /**< Of the next frame. */
+	uint32_t  frames;                                       /**< Frames built. */
+	uint32_t  dropped;                                      /**< Frames the sender could not hand over, under backpressure. */
+} stream_frame_tx_t;
+
+/**@brief What the receiver made of a frame. */
+typedef enum
+{
+	STREAM_FRAME_NEXT,                                      /**< The frame after the newest one. */
+	STREAM_FRAME_GAP,                                       /**< Newer, the frames in between are missing. */
+	STREAM_FRAME_LATE,                                      /**< Missing until now, it came out of order. */
+	STREAM_FRAME_DUPLICATE,                                 /**< Already received. */
+	STREAM_FRAME_RESYNC,                                    /**< Too far behind to place, the device restarted: counted afresh from it. */
+} stream_frame_rx_result_t;
+
+/**@brief Receiving side of a stream. */
+typedef struct
+{
+	bool      started;
+	uint16_t  newest;                                       /**< Highest sequence received. */
+	uint32_t  window;                                       /**< Bit n set: newest - 1 - n received. */
+	uint32_t  frames;                                       /**< Frames received, duplicates left out. */
+	uint32_t  lost;                                         /**< Frames missing now. */
+	uint32_t  gaps;
+	uint32_t  late;
+	uint32_t  duplicates;
+	uint32_t  resyncs;
+} stream_frame_rx_t;
+
+/**@brief Function for starting a stream at sequence 0. */
+void stream_frame_tx_init(stream_frame_tx_t * p_tx, uint8_t stream_id);
+
+/**@brief Function for marking the next frame as not following the last one. */
+void stream_frame_tx_resume(stream_frame_tx_t * p_tx);
+
+/**@brief Function for writing the header of the next frame, which takes the next sequence.
+ *
+ * @param[in]   p_tx        Stream.
+ * @param[in]   encoding    STREAM_FRAME_ENCODING_.
+ * @param[in]   timestamp   Device time of the first sample.
+ * @param[in]   count       Samples in the frame.
+ * @param[out]  p_frame     STREAM_FRAME_HEADER_LEN bytes.
+ */
+void stream_frame_header_put(stream_frame_tx_t * p_tx, uint8_t encoding, uint32_t timestamp, uint16_t count, uint8_t * p_frame);
+
+/**@brief Function for reading the header of a frame.
+ *
+ * @return      false if the frame is shorter than a header.
+ */
+bool stream_frame_header_get(uint8_t const * p_frame, uint16_t length, stream_frame_header_t * p_header);
+
+/**@brief Function for starting the receiving side, nothing received. */
+void stream_frame_rx_init(stream_frame_rx_t * p_rx);
+
+/**@brief Function for placing a received frame in the stream.
+ *
+ * @param[in]   p_rx       Stream.
+ * @param[in]   sequence   Sequence of the frame.
+ * @param[out]  p_missed   Frames missing before it on STREAM_FRAME_GAP, may be NULL.
+ */
+stream_frame_rx_result_t stream_frame_rx_put(stream_frame_rx_t * p_rx, uint16_t sequence, uint16_t * p_missed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // STREAM_FRAME_H__
@@ -0,0 +1,90 @@
+#pragma once
+
+#ifndef SYNTH_H__
+#define SYNTH_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SYNTH_ENV_MAX          (1 << 23)                   /**< Envelope full scale (q23). */
+#define SYNTH_HOLD_FOREVER     UINT32_MAX                  /**< Sustain until synth_voice_release(). */
+#define SYNTH_CYCLES_PER_SAMPLE 48                         /**< CPU cycle budget per rendered sample and voice. */
+
+/**@brief Oscillator waveforms. */
+typedef enum
+{
+	SYNTH_WAVE_SINE,                                       /**< 256 point table, linear interpolation. */
+	SYNTH_WAVE_SQUARE,
+	SYNTH_WAVE_SAW,
+	SYNTH_WAVE_TRIANGLE,
+	SYNTH_WAVE_COUNT
+} synth_wave_t;
+
+/**@brief Envelope stages. */
+typedef enum
+{
+	SYNTH_ENV_ATTACK,
+	SYNTH_ENV_DECAY,
+	SYNTH_ENV_SUSTAIN,
+	SYNTH_ENV_RELEASE,
+	SYNTH_ENV_OFF
+} synth_env_stage_t;
+
+/**@brief Tone parameters, as received over BLE. */
+typedef struct
+{
+	uint8_t   waveform;                                    /**< @ref synth_wave_t. */
+	uint16_t  frequency;                                   /**< Hz. */
+	uint16_t  duration_ms;                                 /**< Attack to release start, 0 sustains until released. */
+	uint16_t  attack_ms;
+	uint16_t  decay_ms;
+	uint16_t  sustain;                                     /**< Sustain level, q15. */
+	uint16_t  release_ms;                                  /**< Time to fall from full scale to silence. */
+} synth_params_t;
+
+/**@brief DDS oscillator with ADSR envelope. */
+typedef struct
+{
+	uint32_t           phase;                              /**< Phase accumulator, a full turn is 2^32. */
+	uint32_t           phase_inc;                          /**< Phase step per sample. */
+	uint8_t            waveform;
+	synth_env_stage_t  stage;
+	int32_t            env;                                /**< Envelope level, q23. */
+	int32_t            attack_inc;                         /**< Envelope steps per sample pair. */
+	int32_t            decay_dec;
+	int32_t            sustain_level;
+	int32_t            release_dec;
+	uint32_t           hold;                               /**< Sample pairs left in sustain. */
+} synth_voice_t;
+
+/**@brief Function for setting up a voice for a new note.
+ *
+ * @param[out]  p_voice      Voice to set up.
+ * @param[in]   p_params     Tone parameters.
+ * @param[in]   sample_rate  Output sample rate, Hz.
+ */
+void synth_voice_init(synth_voice_t * p_voice, synth_params_t const * p_params, uint32_t sample_rate);
+
+/**@brief Function for entering the release stage early. */
+void synth_voice_release(synth_voice_t * p_voice);
+
+/**@brief Function for rendering a voice straight into the mix accumulator.
+ *
+ * @param[in]   p_voice   Voice to render.
+ * @param[out]  p_acc     Accumulator, the voice is added to it.
+ * @param[in]   count     Samples to render, even.
+ * @param[in]   gain      Voice gain, q15.
+ *
+ * @return      false once the release has finished and the voice is silent.
+ */
+bool synth_voice_mix(synth_voice_t * p_voice, int32_t * p_acc, uint32_t count, int32_t gain);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SYNTH_H__ */
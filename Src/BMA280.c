@@ -130,17 +130,18 @@ void BMA280_Turn_On_Slow(void)
 
 }  
 
+// * @brief Function for suspending the sensor, range and bandwidth are kept for BMA280_Wake
 void BMA280_Turn_Off(void)
 {
-	/*
-	uint8_t packet[3]; 
-	packet[0] = (uint8_t)VEML6040_CONF;
-	packet[1] = (uint8_t)(IT_1280 << 4 | 0x01); // Bit 3 must be 0, bit 0 is 0 for run and 1 for shutdown, LS Byte
-	packet[2] = (uint8_t)0x00;
-	writeBytes(VEML6040_ADDRESS, packet, 3);
-	*/
+	writeByte(BMA280_ADDRESS, BMA280_PMU_LPW, suspend_Mode << 5);
 }    
 
+// * @brief Function for going back to normal mode after BMA280_Turn_Off, data is valid after the 1.8 ms wake-up time
+void BMA280_Wake(void)
+{
+	writeByte(BMA280_ADDRESS, BMA280_PMU_LPW, normal_Mode << 5 | sleep_500ms << 1);
+}
+
 void BMA280_Get_Data(int16_t * dest, uint8_t *raw_acel)
 {
 	uint8_t rawData[6];  // x/y/z accel register data stored here
@@ -163,6 +164,17 @@ void BMA280_Get_Data(int16_t * dest, uint8_t *raw_acel)
 //		SEGGER_RTT_printf(0, "BMA280:%d %d %d\n", dest[0], dest[1], dest[2]);
 }
 
+// * @brief Function for reading x/y/z only, as signed 14-bit counts (one burst, no temperature read)
+void BMA280_Get_Accel(int16_t * dest)
+{
+	uint8_t rawData[6];  // x/y/z accel register data stored here
+
+	readBytes(BMA280_ADDRESS, BMA280_ACCD_X_LSB, rawData, 6);
+	dest[0] = (int16_t)(((uint16_t)rawData[1] << 8) | rawData[0]) >> 2;  // left aligned, drop the two flag bits
+	dest[1] = (int16_t)(((uint16_t)rawData[3] << 8) | rawData[2]) >> 2;
+	dest[2] = (int16_t)(((uint16_t)rawData[5] << 8) | rawData[4]) >> 2;
+}
+
 void BMA280_Calibrate(void)
 {
 	//must be in normal power mode, and set to +/- 2g
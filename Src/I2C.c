@@ -30,7 +30,7 @@ void I2C_init(void)
 	{
 		.scl = BA_SCL_PIN,
 		.sda = BA_SDA_PIN,
-		.frequency = NRF_TWI_FREQ_100K,
+		.frequency = NRF_TWI_FREQ_400K,   // a 6-byte burst in ~0.25 ms, read at the gesture rate
 		.interrupt_priority = APP_IRQ_PRIORITY_LOW,
 		.clear_bus_init = false
 	};
@@ -1,62 +1,1308 @@
-
+#include <string.h>
 #include "I2S.h"
+#include "nordic_common.h"
+#include "app_util_platform.h"
+#include "app_timer.h"
+#include "synth.h"
+#include "sequencer.h"
+#include "resampler.h"
+#include "sound_stream.h"
+#include "clip_store.h"
+#include "output_dsp.h"
+#include "sounds.h"
+
+/*@brief Sound clip descriptor
+*/
+typedef struct
+{
+    uint8_t          clip_id;
+    int16_t const *  p_data;
+    uint32_t         length;            // samples
+    uint32_t         sample_rate;       // Hz, resampled to I2S_SAMPLE_RATE when different
+    uint32_t         loop_start;        // first sample of the loop
+    uint32_t         loop_end;          // sample after the loop, 0 if the clip does not loop
+    uint8_t          priority;          // sound_priority_t
+} sound_clip_t;
+
+/*@brief Voice sources
+*/
+typedef enum
+{
+    SOUND_SOURCE_NONE,                  // voice is free
+    SOUND_SOURCE_CLIP,                  // PCM clip
+    SOUND_SOURCE_TONE,                  // DDS oscillator
+    SOUND_SOURCE_STREAM,                // BLE audio stream through the jitter buffer
+} sound_source_t;
+
+/*@brief Mixer voice, one clip or tone being played
+*/
+typedef struct
+{
+    sound_source_t   source;
+    int16_t const *  p_data;
+    uint32_t         length;            // samples
+    uint32_t         position;          // next sample to mix
+    int32_t          gain;              // current ramped gain, q15
+    int32_t          gain_target;       // gain the ramp is heading to, q15
+    uint16_t         volume;            // per-voice gain set by the client, q15
+    uint8_t          clip_id;
+    uint8_t          priority;          // sound_priority_t, a voice only takes over voices of lower or equal priority
+    bool             looping;           // wraps from loop_end to loop_start until released
+    uint32_t         loop_start;
+    uint32_t         loop_end;
+    bool             started;           // START event sent
+    bool             sequenced;         // hit started by the sequencer, no events
+    uint32_t         delay;             // samples of silence before the first sample in the next buffer
+    uint32_t         trigger;           // RTC ticks when the play call came in, for the latency statistic
+    bool             resampled;         // clip rate is not I2S_SAMPLE_RATE
+    resampler_t      resampler;         // rate converter state for resampled clips
+    synth_voice_t    synth;             // oscillator state for SOUND_SOURCE_TONE
+} sound_voice_t;
+
+#define I2S_FADE_STEP   ((I2S_GAIN_UNITY / (I2S_FADE_SAMPLES / 2)) + 1)    // gain change per sample pair
+
+#define I2S_EVT_QUEUE_SIZE      8                                               // power of two
+#define I2S_BUFFER_TICKS        APP_TIMER_TICKS((1000 * I2S_BUFFER_SAMPLES) / I2S_SAMPLE_RATE)
+#define I2S_SYNTH_CYCLES_BUDGET (SYNTH_CYCLES_PER_SAMPLE * I2S_BUFFER_SAMPLES)
+#define I2S_TICKS_TO_US(TICKS)  ((uint32_t)(((uint64_t)(TICKS) * 1000000) / APP_TIMER_TICKS(1000)))
+#define I2S_DRAIN_BUFFERS       ((I2S_DRAIN_MS * I2S_SAMPLE_RATE) / (1000 * I2S_BUFFER_SAMPLES))
+
+static const sound_clip_t m_clips[] =
+{
+    { SOUND_CLIP_CUICA,  sine_cuica,   sizeof(sine_cuica) / sizeof(sine_cuica[0]),   I2S_SAMPLE_RATE, 0, 0, SOUND_PRIORITY_NORMAL },
+    { SOUND_CLIP_CLAVES, sine_claves,  sizeof(sine_claves) / sizeof(sine_claves[0]), I2S_SAMPLE_RATE, 0, 0, SOUND_PRIORITY_NORMAL },
+};
+
+static uint32_t      m_buffer[2][I2S_BUFFER_WORDS];
+static int32_t       m_mix[I2S_BUFFER_SAMPLES];
+static uint32_t      m_early[I2S_BUFFER_WORDS];             // pending buffer with a voice mixed early, see voice_mix_early()
+static int16_t       m_resampled[I2S_BUFFER_SAMPLES];       // one resampled clip or stream voice, before its gain
+static uint8_t       m_buffer_index;
+static volatile sound_state_t m_state = SOUND_STATE_IDLE;
+static bool          m_stop_issued;                         // TASKS_STOP given, waiting for EVENTS_STOPPED
+static bool          m_restart;                             // voice queued after TASKS_STOP
+static uint32_t      m_timeline;                            // output position of the buffer being rendered, samples
+static uint32_t      m_last_update;                         // RTC ticks at the previous TXPTRUPD
+static bool          m_prearm;                              // keep streaming silence when no voice is left
+static uint32_t      m_drain_left;                          // silent buffers left before the I2S is stopped
+static bool          m_cold_start;                          // stream started from a disabled I2S, first latency is a cold one
+static uint8_t       m_render_index;                        // buffer being rendered, for the latency marks
+static uint32_t      m_latency_trigger[2];                  // earliest trigger whose first sample is in the buffer
+static bool          m_latency_pending[2];
+
+static sound_evt_handler_t m_evt_handler;
+static sound_evt_t   m_evt_queue[I2S_EVT_QUEUE_SIZE];
+static volatile uint8_t m_evt_head;
+static volatile uint8_t m_evt_tail;
+
+static sound_voice_t m_voices[I2S_VOICE_COUNT];
+static int32_t       m_master_gain        = I2S_GAIN_UNITY;
+static int32_t       m_master_gain_target = I2S_GAIN_UNITY;
+static sound_stats_t m_stats;
+
+/*@brief Step a q15 gain one sample pair towards its target
+*/
+static __INLINE int32_t gain_ramp(int32_t gain, int32_t target)
+{
+    if (gain < target)
+    {
+        gain += I2S_FADE_STEP;
+        return (gain > target) ? target : gain;
+    }
+    if (gain > target)
+    {
+        gain -= I2S_FADE_STEP;
+        return (gain < target) ? target : gain;
+    }
+    return gain;
+}
+
+/*@brief Queue a player event for sound_process(), called from the interrupt or with it masked
+*/
+static void evt_push(sound_evt_type_t type, sound_voice_t const * p_voice, uint32_t sample_time, uint32_t duration)
+{
+    uint8_t head = m_evt_head;
+
+    if ((uint8_t)(head - m_evt_tail) >= I2S_EVT_QUEUE_SIZE)
+    {
+        return;
+    }
+
+    sound_evt_t * p_evt = &m_evt_queue[head & (I2S_EVT_QUEUE_SIZE - 1)];
+
+    p_evt->evt_type    = type;
+    p_evt->state       = m_state;
+    p_evt->clip_id     = (p_voice != NULL) ? p_voice->clip_id : SOUND_CLIP_NONE;
+    p_evt->voice       = (p_voice != NULL) ? (uint8_t)(p_voice - m_voices) : 0xFF;
+    p_evt->sample_time = sample_time;
+    p_evt->duration    = duration;
+    p_evt->timestamp   = app_timer_cnt_get();
+
+    m_evt_head = head + 1;
+}
+
+/*@brief Fade a voice out: clips ramp their gain down, tones enter the envelope release
+*/
+static void voice_fade_out(sound_voice_t * p_voice)
+{
+    p_voice->gain_target = 0;
+
+    if (p_voice->source == SOUND_SOURCE_TONE)
+    {
+        synth_voice_release(&p_voice->synth);
+    }
+}
+
+/*@brief Mix a run of clip samples that does not cross the clip or loop end, gain ramped per sample pair
+ *
+ * @return gain at the end of the ramp.
+*/
+static int32_t clip_span_mix(int16_t const * p_data, int32_t * p_acc, uint32_t count, int32_t gain, int32_t target)
+{
+    uint32_t i;
+
+    for (i = 0; i + 1 < count; i += 2)
+    {
+        gain = gain_ramp(gain, target);
+
+        // two samples per load, gain in the bottom half-word of the multiplier
+        uint32_t pair = __UNALIGNED_UINT32_READ(&p_data[i]);
+        p_acc[i]     += (int32_t)__SMULBB(pair, (uint32_t)gain) >> 15;
+        p_acc[i + 1] += (int32_t)__SMULTB(pair, (uint32_t)gain) >> 15;
+    }
+
+    // odd sample at the end of the run
+    if (i < count)
+    {
+        p_acc[i] += (p_data[i] * gain) >> 15;
+    }
+
+    return gain;
+}
+
+/*@brief Mix one clip voice into the accumulator, applying its gain ramp on the way
+ *
+ * @details The buffer is filled in runs up to the end of the clip or of the loop. A looping voice
+ *          goes back to the loop start in the middle of the buffer, straight from the clip data.
+*/
+static void clip_mix(sound_voice_t * p_voice, int32_t * p_acc)
+{
+    int16_t const * p_data   = p_voice->p_data;
+    uint32_t        position = p_voice->position;
+    int32_t         gain     = p_voice->gain;
+    int32_t         target   = p_voice->gain_target;
+    uint32_t        i        = p_voice->delay;
+
+    p_voice->delay = 0;
+
+    while (i < I2S_BUFFER_SAMPLES)
+    {
+        uint32_t end = p_voice->looping ? p_voice->loop_end : p_voice->length;
+        uint32_t count;
+
+        if (position >= end)
+        {
+            if (p_voice->looping)
+            {
+                position = p_voice->loop_start;
+                continue;
+            }
+
+            p_voice->source = SOUND_SOURCE_NONE;
+            if (!p_voice->sequenced)
+            {
+                evt_push(SOUND_EVT_FINISHED, p_voice, m_timeline + i, position);
+            }
+            return;
+        }
+
+        count = MIN(end - position, I2S_BUFFER_SAMPLES - i);
+        gain  = clip_span_mix(&p_data[position], &p_acc[i], count, gain, target);
+
+        position += count;
+        i        += count;
+    }
+
+    p_voice->position = position;
+    p_voice->gain     = gain;
+
+    // fade-out finished
+    if ((gain == 0) && (target == 0))
+    {
+        p_voice->source = SOUND_SOURCE_NONE;
+        if (!p_voice->sequenced)
+        {
+            evt_push(SOUND_EVT_STOPPED, p_voice, m_timeline + I2S_BUFFER_SAMPLES, position);
+        }
+    }
+}
+
+/*@brief Mix samples [start, end) of the resampled scratch buffer, start even, with a gain ramp
+ *
+ * @return gain at the end of the ramp.
+*/
+static int32_t scratch_mix(int32_t * p_acc, uint32_t start, uint32_t end, int32_t gain, int32_t target)
+{
+    uint32_t i;
+
+    for (i = start; i < end; i += 2)
+    {
+        gain = gain_ramp(gain, target);
+
+        uint32_t pair = __UNALIGNED_UINT32_READ(&m_resampled[i]);
+        p_acc[i]     += (int32_t)__SMULBB(pair, (uint32_t)gain) >> 15;
+        p_acc[i + 1] += (int32_t)__SMULTB(pair, (uint32_t)gain) >> 15;
+    }
+
+    return gain;
+}
+
+/*@brief Mix one clip voice recorded at another rate, converted to I2S_SAMPLE_RATE first
+ *
+ * @details position counts output samples here, the resampler keeps the read position in the clip.
+*/
+static void clip_resample_mix(sound_voice_t * p_voice, int32_t * p_acc)
+{
+    uint32_t start  = p_voice->delay;
+    int32_t  gain   = p_voice->gain;
+    int32_t  target = p_voice->gain_target;
+    uint32_t count;
+
+    p_voice->delay = 0;
+
+    memset(m_resampled, 0, start * sizeof(m_resampled[0]));
+    if (p_voice->looping)
+    {
+        count = I2S_BUFFER_SAMPLES - start;
+        resampler_process_loop(&p_voice->resampler, p_voice->p_data, p_voice->loop_start, p_voice->loop_end,
+                               &m_resampled[start], count);
+    }
+    else
+    {
+        count = resampler_process(&p_voice->resampler, p_voice->p_data, p_voice->length,
+                                  &m_resampled[start], I2S_BUFFER_SAMPLES - start);
+    }
+    memset(&m_resampled[start + count], 0, (I2S_BUFFER_SAMPLES - start - count) * sizeof(m_resampled[0]));
+
+    gain = scratch_mix(p_acc, start & ~1u, start + count, gain, target);
+
+    p_voice->position += count;
+    p_voice->gain      = gain;
+
+    if (start + count < I2S_BUFFER_SAMPLES)
+    {
+        p_voice->source = SOUND_SOURCE_NONE;
+        if (!p_voice->sequenced)
+        {
+            evt_push(SOUND_EVT_FINISHED, p_voice, m_timeline + start + count, p_voice->position);
+        }
+    }
+    else if ((gain == 0) && (target == 0))
+    {
+        p_voice->source = SOUND_SOURCE_NONE;
+        if (!p_voice->sequenced)
+        {
+            evt_push(SOUND_EVT_STOPPED, p_voice, m_timeline + I2S_BUFFER_SAMPLES, p_voice->position);
+        }
+    }
+}
+
+/*@brief Mix the BLE audio stream, the jitter buffer gives silence while it is filling up
+*/
+static void stream_mix(sound_voice_t * p_voice, int32_t * p_acc)
+{
+    int32_t target = p_voice->gain_target;
+    bool    active = sound_stream_read(m_resampled, I2S_BUFFER_SAMPLES);
+
+    p_voice->gain      = scratch_mix(p_acc, 0, I2S_BUFFER_SAMPLES, p_voice->gain, target);
+    p_voice->position += I2S_BUFFER_SAMPLES;
+
+    if (!active)
+    {
+        p_voice->source = SOUND_SOURCE_NONE;
+        evt_push(SOUND_EVT_FINISHED, p_voice, m_timeline + I2S_BUFFER_SAMPLES, p_voice->position);
+    }
+    else if ((p_voice->gain == 0) && (target == 0))
+    {
+        p_voice->source = SOUND_SOURCE_NONE;
+        sound_stream_close();
+        evt_push(SOUND_EVT_STOPPED, p_voice, m_timeline + I2S_BUFFER_SAMPLES, p_voice->position);
+    }
+}
+
+/*@brief Render one tone voice straight into the accumulator and keep its cycle count
+*/
+static void tone_mix(sound_voice_t * p_voice, int32_t * p_acc)
+{
+    uint32_t start  = DWT->CYCCNT;
+    bool     active = synth_voice_mix(&p_voice->synth, p_acc, I2S_BUFFER_SAMPLES, p_voice->gain);
+    uint32_t cycles = DWT->CYCCNT - start;
+
+    m_stats.synth_cycles_max = MAX(m_stats.synth_cycles_max, cycles);
+    if (cycles > I2S_SYNTH_CYCLES_BUDGET)
+    {
+        m_stats.synth_budget_overruns++;
+    }
+
+    // position counts rendered samples for the events
+    p_voice->position += I2S_BUFFER_SAMPLES;
+
+    if (!active)
+    {
+        p_voice->source = SOUND_SOURCE_NONE;
+        evt_push((p_voice->gain_target == 0) ? SOUND_EVT_STOPPED : SOUND_EVT_FINISHED,
+                 p_voice, m_timeline + I2S_BUFFER_SAMPLES, p_voice->position);
+    }
+}
+
+/*@brief Mix one voice of any source into the accumulator
+*/
+static void voice_mix(sound_voice_t * p_voice, int32_t * p_acc)
+{
+    if (!p_voice->started)
+    {
+        p_voice->started = true;
+        if (!p_voice->sequenced)
+        {
+            evt_push(SOUND_EVT_STARTED, p_voice, m_timeline + p_voice->delay, p_voice->length);
+
+            // first sample of a triggered voice is at the start of this buffer, measured when it is latched,
+            // a stream starts on silence while its jitter buffer fills and is not a trigger,
+            // the earlier of two triggers is the one with the shorter distance to the other on the RTC
+            if ((p_voice->source != SOUND_SOURCE_STREAM) &&
+                (!m_latency_pending[m_render_index] ||
+                 (app_timer_cnt_diff_compute(m_latency_trigger[m_render_index], p_voice->trigger) <
+                  app_timer_cnt_diff_compute(p_voice->trigger, m_latency_trigger[m_render_index]))))
+            {
+                m_latency_trigger[m_render_index] = p_voice->trigger;
+                m_latency_pending[m_render_index] = true;
+            }
+        }
+    }
+
+    if (p_voice->source == SOUND_SOURCE_TONE)
+    {
+        tone_mix(p_voice, p_acc);
+    }
+    else if (p_voice->source == SOUND_SOURCE_STREAM)
+    {
+        stream_mix(p_voice, p_acc);
+    }
+    else if (p_voice->resampled)
+    {
+        clip_resample_mix(p_voice, p_acc);
+    }
+    else
+    {
+        clip_mix(p_voice, p_acc);
+    }
+}
+
+static sound_voice_t * voice_alloc(bool fade_others, uint8_t priority);
+
+/*@brief Look up a clip by its identifier, built-in clips first, then the clips uploaded to flash
+*/
+static bool clip_find(uint8_t clip_id, sound_clip_t * p_clip)
+{
+    clip_store_info_t info;
+    uint32_t          i;
+
+    for (i = 0; i < ARRAY_SIZE(m_clips); i++)
+    {
+        if (m_clips[i].clip_id == clip_id)
+        {
+            *p_clip = m_clips[i];
+            return true;
+        }
+    }
+
+    if (!clip_store_find(clip_id, &p_clip->p_data, &p_clip->length, &info))
+    {
+        return false;
+    }
+
+    p_clip->clip_id     = clip_id;
+    p_clip->sample_rate = info.sample_rate;
+    p_clip->loop_start  = info.loop_start;
+    p_clip->loop_end    = info.loop_end;
+    p_clip->priority    = (info.priority > SOUND_PRIORITY_ALARM) ? SOUND_PRIORITY_NORMAL : info.priority;
+
+    return true;
+}
+
+/*@brief Point a voice at a clip, with a rate converter when the clip is not at the output rate
+ *
+ * @return false if the clip rate cannot be converted, the voice is left free.
+*/
+static bool voice_clip_set(sound_voice_t * p_voice, sound_clip_t const * p_clip)
+{
+    p_voice->source    = SOUND_SOURCE_CLIP;
+    p_voice->p_data    = p_clip->p_data;
+    p_voice->length    = p_clip->length;
+    p_voice->clip_id   = p_clip->clip_id;
+    p_voice->resampled = (p_clip->sample_rate != I2S_SAMPLE_RATE);
+
+    // loop points are checked here, a bad pair plays the clip once
+    p_voice->looping    = (p_clip->loop_end <= p_clip->length) && (p_clip->loop_start < p_clip->loop_end);
+    p_voice->loop_start = p_clip->loop_start;
+    p_voice->loop_end   = p_clip->loop_end;
+
+    if (p_voice->resampled && !resampler_init(&p_voice->resampler, p_clip->sample_rate, I2S_SAMPLE_RATE))
+    {
+        p_voice->source = SOUND_SOURCE_NONE;
+        return false;
+    }
+
+    return true;
+}
+
+/*@brief Sequencer hit, starts a clip at an exact sample of the buffer being rendered
+ *
+ * @details No fade-in, the attack of a percussion clip is the point of the hit.
+*/
+static void sequencer_hit(uint8_t clip_id, uint16_t gain, uint32_t delay)
+{
+    sound_clip_t    clip;
+    sound_voice_t * p_voice;
+
+    if (!clip_find(clip_id, &clip))
+    {
+        return;
+    }
+
+    p_voice = voice_alloc(false, clip.priority);
+    if ((p_voice == NULL) || !voice_clip_set(p_voice, &clip))
+    {
+        return;
+    }
+
+    p_voice->gain        = (gain * p_voice->volume) >> 15;
+    p_voice->gain_target = p_voice->gain;
+    p_voice->sequenced   = true;
+    p_voice->looping     = false;           // a pattern hit plays the clip once
+    p_voice->delay       = delay;
+}
+
+/*@brief Render one DMA buffer: mix all voices, apply the master gain and pack to 16-bit pairs
+ *
+ * @return true if any voice is still active after this buffer.
+*/
+static bool buffer_render(uint32_t * p_buffer)
+{
+    int32_t  master = m_master_gain;
+    int32_t  target = m_master_gain_target;
+    bool     active = false;
+    uint32_t start  = DWT->CYCCNT;
+    uint32_t dsp_start;
+    uint32_t dsp_cycles;
+    uint32_t i;
+
+    m_render_index = (p_buffer == m_buffer[1]) ? 1 : 0;
+    m_latency_pending[m_render_index] = false;
+
+    memset(m_mix, 0, sizeof(m_mix));
+
+    if (sequencer_process(m_timeline, I2S_BUFFER_SAMPLES, sequencer_hit))
+    {
+        evt_push(SOUND_EVT_PATTERN_DONE, NULL, m_timeline, 0);
+    }
+    active = sequencer_active();
+
+    for (i = 0; i < I2S_VOICE_COUNT; i++)
+    {
+        if (m_voices[i].source != SOUND_SOURCE_NONE)
+        {
+            voice_mix(&m_voices[i], m_mix);
+            active |= (m_voices[i].source != SOUND_SOURCE_NONE);
+        }
+    }
+
+    for (i = 0; i < I2S_BUFFER_SAMPLES; i += 2)
+    {
+        master = gain_ramp(master, target);
+
+        // SMULWB gives (acc * gain) >> 16, shift back up for q15, the headroom is kept for the limiter
+        m_mix[i]     = __SMULWB(m_mix[i], master) << 1;
+        m_mix[i + 1] = __SMULWB(m_mix[i + 1], master) << 1;
+    }
+
+    dsp_start = DWT->CYCCNT;
+    output_dsp_process(m_mix, I2S_BUFFER_SAMPLES);
+    dsp_cycles = DWT->CYCCNT - dsp_start;
+
+    m_stats.dsp_cycles_max = MAX(m_stats.dsp_cycles_max, dsp_cycles);
+    if (dsp_cycles > output_dsp_cycles_budget(I2S_BUFFER_SAMPLES))
+    {
+        m_stats.dsp_budget_overruns++;
+    }
+
+    for (i = 0; i < I2S_BUFFER_WORDS; i++)
+    {
+        p_buffer[i] = __PKHBT(__SSAT(m_mix[2 * i], 16), __SSAT(m_mix[2 * i + 1], 16), 16);
+    }
+
+    m_master_gain = master;
+    m_timeline   += I2S_BUFFER_SAMPLES;
+
+    m_stats.render_cycles_max = MAX(m_stats.render_cycles_max, DWT->CYCCNT - start);
+
+    return active;
+}
+
+/*@brief Mix a voice that was just triggered into the buffer queued for the EasyDMA but not latched yet
+ *
+ * @details The pending buffer is already rendered, the new voice is added on top of it with
+ *          saturation so that the trigger is heard after the buffer playing now instead of the
+ *          one after it. The other voices are not touched, their fades start with the next render.
+ *
+ *          The sum is built in m_early and only copied over the pending buffer if TXPTRUPD is still
+ *          clear once it is ready. If the EasyDMA latched the buffer meanwhile, the voice, its events
+ *          and the latency mark are put back and the interrupt renders the voice from its start.
+ *
+ * @note Call with the I2S interrupt masked.
+*/
+static void voice_mix_early(sound_voice_t * p_voice)
+{
+    uint32_t *    p_buffer = m_buffer[m_buffer_index];
+    int32_t       master   = m_master_gain;
+    int32_t       limiter  = (int32_t)output_dsp_gain_get();
+    sound_voice_t voice;
+    uint8_t       evt_head;
+    uint32_t      latency_trigger;
+    bool          latency_pending;
+    uint32_t      i;
+
+    // already in a cold-started stream, or TXPTRUPD set: the pending buffer is being played
+    // and the interrupt renders the voice
+    if (p_voice->started || (m_state != SOUND_STATE_PLAYING) || NRF_I2S->EVENTS_TXPTRUPD)
+    {
+        return;
+    }
+
+    memset(m_mix, 0, sizeof(m_mix));
+
+    // the pending buffer starts one buffer before the render position
+    m_render_index  = m_buffer_index;
+    voice           = *p_voice;
+    evt_head        = m_evt_head;
+    latency_trigger = m_latency_trigger[m_render_index];
+    latency_pending = m_latency_pending[m_render_index];
+    m_timeline     -= I2S_BUFFER_SAMPLES;
+    voice_mix(p_voice, m_mix);
+    m_timeline     += I2S_BUFFER_SAMPLES;
+
+    // the post-mix stage has run on the pending buffer, the new voice only gets the limiter gain
+    // of the moment, it goes through the equalizer from the next buffer on
+    master = (int32_t)(((int64_t)master * limiter) >> 16);
+
+    for (i = 0; i < I2S_BUFFER_WORDS; i++)
+    {
+        int32_t left  = __SSAT(__SMULWB(m_mix[2 * i], master) << 1, 16);
+        int32_t right = __SSAT(__SMULWB(m_mix[2 * i + 1], master) << 1, 16);
+        m_early[i] = __QADD16(p_buffer[i], __PKHBT(left, right, 16));
+    }
+
+    // the EasyDMA reads one word per sample period from the latch on, the copy runs ahead of it
+    if (NRF_I2S->EVENTS_TXPTRUPD)
+    {
+        *p_voice                          = voice;
+        m_evt_head                        = evt_head;
+        m_latency_trigger[m_render_index] = latency_trigger;
+        m_latency_pending[m_render_index] = latency_pending;
+        return;
+    }
+
+    memcpy(p_buffer, m_early, sizeof(m_early));
+}
+
+/*@brief Trigger-to-output latency of the buffer just latched by the EasyDMA
+ *
+ * @details Timed on the app_timer RTC, it keeps counting while the CPU sleeps in nrf_pwr_mgmt_run()
+ *          where the DWT cycle counter stops. The resolution is one RTC tick, about 61 us.
+*/
+static void latency_measure(uint8_t index)
+{
+    if (m_latency_pending[index])
+    {
+        uint32_t latency = I2S_TICKS_TO_US(app_timer_cnt_diff_compute(app_timer_cnt_get(), m_latency_trigger[index]));
+
+        m_latency_pending[index]          = false;
+        m_stats.trigger_latency_last      = latency;
+        m_stats.trigger_latency_max       = MAX(m_stats.trigger_latency_max, latency);
+        if (latency > I2S_TRIGGER_LATENCY_TARGET_US)
+        {
+            m_stats.trigger_latency_misses++;
+        }
+        if (m_cold_start)
+        {
+            m_stats.cold_latency_max = MAX(m_stats.cold_latency_max, latency);
+        }
+    }
+
+    m_cold_start = false;
+}
+
+/*@brief Start streaming the double buffer, the clip data is never given to the EasyDMA directly
+ *
+ * @details The I2S is enabled here when it was powered down, it takes the HFCLK from TASKS_START on.
+*/
+static void stream_start(void)
+{
+    m_cold_start = (NRF_I2S->ENABLE == 0);
+    if (m_cold_start)
+    {
+        NRF_I2S->ENABLE = 1;
+        m_stats.power_ups++;
+    }
+
+    m_buffer_index = 0;
+    m_drain_left   = I2S_DRAIN_BUFFERS;
+    buffer_render(m_buffer[0]);
+
+    // Configure data pointer
+    NRF_I2S->TXD.PTR = (uint32_t)m_buffer[0];
+
+    // Start transmitting I2S data
+    NRF_I2S->EVENTS_TXPTRUPD = 0;
+    NRF_I2S->EVENTS_STOPPED  = 0;
+    m_last_update = app_timer_cnt_get();
+    m_stop_issued = false;
+    m_state       = SOUND_STATE_PLAYING;
+    NRF_I2S->TASKS_START = 1;
+}
+
+/*@brief I2S interrupt, hands the next buffer to the EasyDMA as soon as the current one is latched
+ *
+ * @details PLAYING renders until no voice is left, STOPPING lets the last (silent) buffer start
+ *          and then stops the peripheral, IDLE is entered on EVENTS_STOPPED.
+*/
+void I2S_IRQHandler(void)
+{
+    if (NRF_I2S->EVENTS_TXPTRUPD)
+    {
+        NRF_I2S->EVENTS_TXPTRUPD = 0;
+        (void)NRF_I2S->EVENTS_TXPTRUPD;
+
+        uint32_t now     = app_timer_cnt_get();
+        uint32_t elapsed = app_timer_cnt_diff_compute(now, m_last_update);
+        m_last_update = now;
+
+        // a late refill means the EasyDMA has already replayed the previous buffer
+        if (elapsed > (I2S_BUFFER_TICKS + I2S_BUFFER_TICKS / 2))
+        {
+            evt_push(SOUND_EVT_UNDERRUN, NULL, m_timeline, elapsed);
+        }
+
+        // the pending buffer has just been latched, its first sample is going out now
+        latency_measure(m_buffer_index);
+
+        if (m_state == SOUND_STATE_STOPPING)
+        {
+            if (!m_stop_issued)
+            {
+                m_stop_issued = true;
+                NRF_I2S->TASKS_STOP = 1;
+            }
+        }
+        else
+        {
+            m_buffer_index ^= 1;
+            if (buffer_render(m_buffer[m_buffer_index]))
+            {
+                m_state      = SOUND_STATE_PLAYING;
+                m_drain_left = I2S_DRAIN_BUFFERS;
+            }
+            else if (m_prearm || (m_drain_left > 0))
+            {
+                // keep the stream running on silence, a trigger only has to add a voice
+                if (m_state == SOUND_STATE_PLAYING)
+                {
+                    m_state = SOUND_STATE_ARMED;
+                    evt_push(SOUND_EVT_IDLE, NULL, m_timeline, 0);
+                }
+                if (!m_prearm)
+                {
+                    m_drain_left--;
+                }
+            }
+            else
+            {
+                // the buffer just rendered is silent, stop once it has been latched
+                m_state = SOUND_STATE_STOPPING;
+            }
+            NRF_I2S->TXD.PTR = (uint32_t)m_buffer[m_buffer_index];
+        }
+    }
+
+    if (NRF_I2S->EVENTS_STOPPED)
+    {
+        NRF_I2S->EVENTS_STOPPED = 0;
+        (void)NRF_I2S->EVENTS_STOPPED;
+
+        m_state = SOUND_STATE_IDLE;
+        evt_push(SOUND_EVT_IDLE, NULL, m_timeline, 0);
+
+        if (m_restart)
+        {
+            m_restart = false;
+            stream_start();
+        }
+        else
+        {
+            // disabled, the I2S no longer keeps the HFCLK running
+            NRF_I2S->ENABLE = 0;
+        }
+    }
+}
 
 /*@brief I2S configuration
+ *
+ * @param[in] evt_handler  Called from sound_process() for every player event, may be NULL.
 */
-void I2S_init()
+void I2S_init(sound_evt_handler_t evt_handler)
 {
+    uint32_t i;
+
     // Enable transmission
     NRF_I2S->CONFIG.TXEN = (I2S_CONFIG_TXEN_TXEN_ENABLE << I2S_CONFIG_TXEN_TXEN_Pos);
-  
-    // Enable MCK generator
+
+    // Enable MCK generator, SCK and LRCK are divided from it in master mode
     NRF_I2S->CONFIG.MCKEN = (I2S_CONFIG_MCKEN_MCKEN_ENABLE << I2S_CONFIG_MCKEN_MCKEN_Pos);
-  
+
     // MCKFREQ = 4 MHz
     NRF_I2S->CONFIG.MCKFREQ = I2S_CONFIG_MCKFREQ_MCKFREQ_32MDIV21  << I2S_CONFIG_MCKFREQ_MCKFREQ_Pos;
-  
-    // Ratio = 64 
+
+    // Ratio = 64
     NRF_I2S->CONFIG.RATIO = I2S_CONFIG_RATIO_RATIO_128X << I2S_CONFIG_RATIO_RATIO_Pos;
-    
+
     // Master mode, 16Bit, left aligned
     NRF_I2S->CONFIG.MODE = I2S_CONFIG_MODE_MODE_MASTER << I2S_CONFIG_MODE_MODE_Pos;
     NRF_I2S->CONFIG.SWIDTH = I2S_CONFIG_SWIDTH_SWIDTH_16BIT << I2S_CONFIG_SWIDTH_SWIDTH_Pos;
     NRF_I2S->CONFIG.ALIGN = I2S_CONFIG_ALIGN_ALIGN_LEFT << I2S_CONFIG_ALIGN_ALIGN_Pos;
-  
+
     // Format = I2S
     NRF_I2S->CONFIG.FORMAT = I2S_CONFIG_FORMAT_FORMAT_I2S << I2S_CONFIG_FORMAT_FORMAT_Pos;
-  
-    // Use stereo 
+
+    // Use stereo
     NRF_I2S->CONFIG.CHANNELS = I2S_CONFIG_CHANNELS_CHANNELS_STEREO << I2S_CONFIG_CHANNELS_CHANNELS_Pos;
-  
+
     // Configure pins
+#if I2S_MCK_OUTPUT
     NRF_I2S->PSEL.MCK = (PIN_MCK << I2S_PSEL_MCK_PIN_Pos);
-    NRF_I2S->PSEL.SCK = (PIN_SCK << I2S_PSEL_SCK_PIN_Pos); 
-    NRF_I2S->PSEL.LRCK = (PIN_LRCK << I2S_PSEL_LRCK_PIN_Pos); 
+#else
+    NRF_I2S->PSEL.MCK = (I2S_PSEL_MCK_CONNECT_Disconnected << I2S_PSEL_MCK_CONNECT_Pos);
+#endif
+    NRF_I2S->PSEL.SCK = (PIN_SCK << I2S_PSEL_SCK_PIN_Pos);
+    NRF_I2S->PSEL.LRCK = (PIN_LRCK << I2S_PSEL_LRCK_PIN_Pos);
     NRF_I2S->PSEL.SDOUT = (PIN_SDOUT << I2S_PSEL_SDOUT_PIN_Pos);
-    
-    NRF_I2S->ENABLE = 1;
+
+    // Every buffer has the same size, only the pointer changes
+    NRF_I2S->RXTXD.MAXCNT = I2S_BUFFER_WORDS;
+
+    for (i = 0; i < I2S_VOICE_COUNT; i++)
+    {
+        m_voices[i].source = SOUND_SOURCE_NONE;
+        m_voices[i].volume = I2S_GAIN_UNITY;
+    }
+
+    output_dsp_init(I2S_SAMPLE_RATE);
+
+    // Cycle counter for the render budgets
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;
+
+    m_evt_handler = evt_handler;
+
+    // Refill the buffers and track the stop from the interrupt
+    NRF_I2S->INTENSET = I2S_INTENSET_TXPTRUPD_Msk | I2S_INTENSET_STOPPED_Msk;
+    NVIC_SetPriority(I2S_IRQn, APP_IRQ_PRIORITY_HIGH);
+    NVIC_ClearPendingIRQ(I2S_IRQn);
+    NVIC_EnableIRQ(I2S_IRQn);
+
+    // enabled by stream_start() when there is something to play
+    NRF_I2S->ENABLE = 0;
+}
+
+/*@brief Get a voice for a new sound, a free one or the one that matters least
+ *
+ * @details Only voices of the same or a lower priority are faded out or taken over: lower priority
+ *          first, then the one closest to silence.
+ *
+ * @param[in] fade_others  Fade out the voices the new sound replaces.
+ * @param[in] priority     sound_priority_t of the new sound.
+ *
+ * @return NULL if every voice plays something of a higher priority.
+*/
+static sound_voice_t * voice_alloc(bool fade_others, uint8_t priority)
+{
+    sound_voice_t * p_free = NULL;
+    uint32_t        i;
+
+    for (i = 0; i < I2S_VOICE_COUNT; i++)
+    {
+        sound_voice_t * p_voice = &m_voices[i];
+
+        if (p_voice->source == SOUND_SOURCE_NONE)
+        {
+            if ((p_free == NULL) || (p_free->source != SOUND_SOURCE_NONE))
+            {
+                p_free = p_voice;
+            }
+        }
+        else if (p_voice->priority <= priority)
+        {
+            if (fade_others)
+            {
+                voice_fade_out(p_voice);
+            }
+
+            // all voices busy so far: take over the lowest priority, then the one closest to silence
+            if ((p_free == NULL) ||
+                ((p_free->source != SOUND_SOURCE_NONE) &&
+                 ((p_voice->priority < p_free->priority) ||
+                  ((p_voice->priority == p_free->priority) && (p_voice->gain < p_free->gain)))))
+            {
+                p_free = p_voice;
+            }
+        }
+    }
+
+    if (p_free == NULL)
+    {
+        return NULL;
+    }
+
+    if (p_free->source != SOUND_SOURCE_NONE)
+    {
+        evt_push(SOUND_EVT_STOPPED, p_free, m_timeline, p_free->position);
+    }
+
+    p_free->source    = SOUND_SOURCE_NONE;
+    p_free->position  = 0;
+    p_free->started   = false;
+    p_free->sequenced = false;
+    p_free->looping   = false;
+    p_free->delay     = 0;
+    p_free->priority  = priority;
+
+    return p_free;
+}
+
+/*@brief Get the stream going for a voice that was just set up
+ *
+ * @note Call with the I2S interrupt masked.
+*/
+static void stream_request(void)
+{
+    if (m_state == SOUND_STATE_IDLE)
+    {
+        stream_start();
+    }
+    else if (m_state == SOUND_STATE_ARMED)
+    {
+        m_state = SOUND_STATE_PLAYING;
+    }
+    else if (m_state == SOUND_STATE_STOPPING)
+    {
+        if (m_stop_issued)
+        {
+            // start again on EVENTS_STOPPED
+            m_restart = true;
+        }
+        else
+        {
+            // only the silent tail is queued, keep streaming
+            m_state = SOUND_STATE_PLAYING;
+        }
+    }
+}
+
+/*@brief Play a clip at the priority stored with it, see sound_play_priority()
+*/
+void sound_play(uint8_t clip_id)
+{
+    sound_play_priority(clip_id, SOUND_PRIORITY_CLIP);
+}
+
+/*@brief Play a clip, what is playing at the same or a lower priority fades out while the new clip fades in
+ *
+ * @details Sounds of a higher priority play on and the clip is dropped if they hold every voice.
+ *
+ * @param[in] priority  sound_priority_t, SOUND_PRIORITY_CLIP for the priority stored with the clip.
+*/
+void sound_play_priority(uint8_t clip_id, uint8_t priority)
+{
+    uint32_t        trigger = app_timer_cnt_get();
+    sound_clip_t    clip;
+    sound_voice_t * p_voice;
+
+    if (!clip_find(clip_id, &clip))
+    {
+        return;
+    }
+
+    if (priority != SOUND_PRIORITY_CLIP)
+    {
+        clip.priority = MIN(priority, SOUND_PRIORITY_ALARM);
+    }
+
+    CRITICAL_REGION_ENTER();
+
+    p_voice = voice_alloc(true, clip.priority);
+
+    if ((p_voice != NULL) && voice_clip_set(p_voice, &clip))
+    {
+        p_voice->gain        = 0;
+        p_voice->gain_target = p_voice->volume;
+        p_voice->trigger     = trigger;
+
+        stream_request();
+        voice_mix_early(p_voice);
+    }
+
+    CRITICAL_REGION_EXIT();
+}
+
+/*@brief Start a clip on top of whatever is playing, at the given gain and without fade-in
+ *
+ * @details For clips played like an instrument: the attack is kept and earlier hits ring on.
+*/
+void sound_hit(uint8_t clip_id, uint16_t gain)
+{
+    uint32_t        trigger = app_timer_cnt_get();
+    sound_clip_t    clip;
+    sound_voice_t * p_voice;
+
+    if (!clip_find(clip_id, &clip))
+    {
+        return;
+    }
+
+    CRITICAL_REGION_ENTER();
+
+    p_voice = voice_alloc(false, clip.priority);
+
+    if ((p_voice != NULL) && voice_clip_set(p_voice, &clip))
+    {
+        p_voice->gain        = (MIN(gain, I2S_GAIN_UNITY) * p_voice->volume) >> 15;
+        p_voice->gain_target = p_voice->gain;
+        p_voice->trigger     = trigger;
+
+        stream_request();
+        voice_mix_early(p_voice);
+    }
+
+    CRITICAL_REGION_EXIT();
+}
+
+/*@brief Start a synthesized tone on a voice just allocated
+*/
+static void sound_tone_start(sound_voice_t * p_voice, synth_params_t const * p_params, uint32_t trigger)
+{
+    synth_voice_init(&p_voice->synth, p_params, I2S_SAMPLE_RATE);
+
+    // the envelope does the fades, the gain stays at the voice volume
+    p_voice->source      = SOUND_SOURCE_TONE;
+    p_voice->p_data      = NULL;
+    p_voice->length      = 0;
+    p_voice->gain        = p_voice->volume;
+    p_voice->gain_target = p_voice->volume;
+    p_voice->clip_id     = SOUND_CLIP_TONE;
+    p_voice->trigger     = trigger;
+
+    stream_request();
+    voice_mix_early(p_voice);
+}
+
+/*@brief Play a synthesized tone on top of whatever is playing
+*/
+void sound_tone(synth_params_t const * p_params)
+{
+    uint32_t        trigger = app_timer_cnt_get();
+    sound_voice_t * p_voice;
+
+    CRITICAL_REGION_ENTER();
+
+    p_voice = voice_alloc(false, SOUND_PRIORITY_NORMAL);
+
+    if (p_voice != NULL)
+    {
+        sound_tone_start(p_voice, p_params, trigger);
+    }
+
+    CRITICAL_REGION_EXIT();
+}
+
+/*@brief Open the BLE audio stream and give it a voice, frames go to sound_stream_frame_put()
+ *
+ * @param[in] sample_rate  Rate of the stream, Hz.
+ *
+ * @return false if the rate cannot be converted.
+*/
+bool sound_stream_play(uint32_t sample_rate)
+{
+    sound_voice_t * p_voice;
+    bool            opened;
+    uint32_t        i;
+
+    CRITICAL_REGION_ENTER();
+
+    // one stream at a time, a new one takes over the voice of the old one
+    for (i = 0; i < I2S_VOICE_COUNT; i++)
+    {
+        if (m_voices[i].source == SOUND_SOURCE_STREAM)
+        {
+            m_voices[i].source = SOUND_SOURCE_NONE;
+        }
+    }
+
+    opened = sound_stream_open(sample_rate, I2S_SAMPLE_RATE);
+    p_voice = opened ? voice_alloc(false, SOUND_PRIORITY_NORMAL) : NULL;
+    if (p_voice == NULL)
+    {
+        // every voice plays something more important
+        if (opened)
+        {
+            sound_stream_close();
+            opened = false;
+        }
+    }
+    else
+    {
+        p_voice->source      = SOUND_SOURCE_STREAM;
+        p_voice->p_data      = NULL;
+        p_voice->length      = 0;
+        p_voice->gain        = 0;
+        p_voice->gain_target = p_voice->volume;
+        p_voice->clip_id     = SOUND_CLIP_STREAM;
+
+        stream_request();
+    }
+
+    CRITICAL_REGION_EXIT();
+
+    return opened;
+}
+
+/*@brief Play a percussion pattern, hits are placed on exact samples of the output
+ *
+ * @return false if the pattern is malformed.
+*/
+bool sound_pattern_play(uint8_t const * p_data, uint16_t length)
+{
+    bool loaded;
+
+    CRITICAL_REGION_ENTER();
+
+    // the first tick lands on the first sample of the next buffer rendered
+    loaded = sequencer_load(p_data, length, I2S_SAMPLE_RATE, m_timeline);
+    if (loaded)
+    {
+        stream_request();
+    }
+
+    CRITICAL_REGION_EXIT();
+
+    return loaded;
+}
+
+/*@brief Keep the I2S streaming silence between sounds so a trigger does not wait for a cold start
+ *
+ * @details Enabling starts the silent stream right away, disabling lets it drain for I2S_DRAIN_MS
+ *          once no voice is left and power down.
+*/
+void sound_prearm_set(bool enable)
+{
+    CRITICAL_REGION_ENTER();
+
+    m_prearm = enable;
+
+    if (enable && (m_state == SOUND_STATE_IDLE))
+    {
+        stream_start();
+        m_state = SOUND_STATE_ARMED;
+    }
+    else if (!enable && (m_state == SOUND_STATE_ARMED))
+    {
+        // drain from now on, the I2S powers down if no trigger comes
+        m_drain_left = I2S_DRAIN_BUFFERS;
+    }
+
+    CRITICAL_REGION_EXIT();
+}
+
+/*@brief Fade out all voices and stop the pattern, the I2S stops after the fade
+*/
+void sound_stop(void)
+{
+    uint32_t i;
+
+    CRITICAL_REGION_ENTER();
+
+    sequencer_stop();
+
+    for (i = 0; i < I2S_VOICE_COUNT; i++)
+    {
+        if (m_voices[i].source != SOUND_SOURCE_NONE)
+        {
+            voice_fade_out(&m_voices[i]);
+        }
+    }
+
+    CRITICAL_REGION_EXIT();
+}
+
+/*@brief End the loops and held tones, each voice plays its tail out and finishes on its own
+ *
+ * @details A looping clip plays on from where it is to the end of the clip, past the loop end.
+*/
+void sound_release(void)
+{
+    uint32_t i;
+
+    CRITICAL_REGION_ENTER();
+
+    for (i = 0; i < I2S_VOICE_COUNT; i++)
+    {
+        sound_voice_t * p_voice = &m_voices[i];
+
+        if (p_voice->source == SOUND_SOURCE_TONE)
+        {
+            synth_voice_release(&p_voice->synth);
+        }
+        else if (p_voice->source != SOUND_SOURCE_NONE)
+        {
+            p_voice->looping = false;
+        }
+    }
+
+    CRITICAL_REGION_EXIT();
+}
+
+/*@brief Silence at once the voices playing uploaded clips, before the store erases their flash
+ *
+ * @details A fade would go on reading the clip while its pages are erased, erased flash on the
+ *          output is a click of its own. The buffers already rendered play out unchanged.
+ *
+ * @param[in] clip_id  Uploaded clip to cut, SOUND_CLIP_NONE for every uploaded clip.
+*/
+void sound_store_cut(uint8_t clip_id)
+{
+    uint32_t i;
+
+    CRITICAL_REGION_ENTER();
+
+    for (i = 0; i < I2S_VOICE_COUNT; i++)
+    {
+        sound_voice_t * p_voice = &m_voices[i];
+
+        if ((p_voice->source == SOUND_SOURCE_CLIP) &&
+            (p_voice->clip_id >= CLIP_STORE_ID_FIRST) && (p_voice->clip_id <= CLIP_STORE_ID_LAST) &&
+            ((clip_id == SOUND_CLIP_NONE) || (p_voice->clip_id == clip_id)))
+        {
+            p_voice->source = SOUND_SOURCE_NONE;
+            evt_push(SOUND_EVT_STOPPED, p_voice, m_timeline, p_voice->position);
+        }
+    }
+
+    CRITICAL_REGION_EXIT();
+}
+
+/*@brief Set the master gain (q15), ramped in the output stage
+*/
+void sound_master_gain_set(uint16_t gain)
+{
+    m_master_gain_target = MIN(gain, I2S_GAIN_UNITY);
+}
+
+/*@brief Set one equalizer stage of the post-mix stage, NULL ends the cascade at that stage
+*/
+bool sound_eq_set(uint8_t stage, output_dsp_biquad_t const * p_biquad)
+{
+    bool done;
+
+    CRITICAL_REGION_ENTER();
+    done = output_dsp_biquad_set(stage, p_biquad);
+    CRITICAL_REGION_EXIT();
+
+    return done;
+}
+
+/*@brief Change the output limiter settings
+*/
+void sound_limiter_set(output_dsp_limiter_t const * p_limiter)
+{
+    CRITICAL_REGION_ENTER();
+    output_dsp_limiter_set(p_limiter);
+    CRITICAL_REGION_EXIT();
+}
+
+/*@brief Set the gain (q15) of one voice, a playing voice ramps to it
+*/
+void sound_voice_gain_set(uint8_t voice, uint16_t gain)
+{
+    if (voice >= I2S_VOICE_COUNT)
+    {
+        return;
+    }
+
+    CRITICAL_REGION_ENTER();
+
+    m_voices[voice].volume = MIN(gain, I2S_GAIN_UNITY);
+    if ((m_voices[voice].source != SOUND_SOURCE_NONE) && (m_voices[voice].gain_target != 0))
+    {
+        m_voices[voice].gain_target = m_voices[voice].volume;
+        if (m_voices[voice].source == SOUND_SOURCE_TONE)
+        {
+            m_voices[voice].gain = m_voices[voice].volume;
+        }
+    }
+
+    CRITICAL_REGION_EXIT();
+}
+
+/*@brief Current player state
+*/
+sound_state_t sound_state_get(void)
+{
+    return m_state;
+}
+
+/*@brief Copy the render statistics
+*/
+void sound_stats_get(sound_stats_t * p_stats)
+{
+    CRITICAL_REGION_ENTER();
+    *p_stats = m_stats;
+    CRITICAL_REGION_EXIT();
+}
+
+/*@brief Deliver queued player events, call from the main loop
+*/
+void sound_process(void)
+{
+    while (m_evt_tail != m_evt_head)
+    {
+        sound_evt_t evt = m_evt_queue[m_evt_tail & (I2S_EVT_QUEUE_SIZE - 1)];
+        m_evt_tail++;
+
+        if (m_evt_handler != NULL)
+        {
+            m_evt_handler(&evt);
+        }
+    }
 }
 
 /*@brief sound cuica start
 */
 void sound_cuica_start()
 {
-	// Configure data pointer
-	NRF_I2S->TXD.PTR = (uint32_t)&sine_cuica[0];
-	NRF_I2S->RXTXD.MAXCNT = sizeof(sine_cuica) / sizeof(uint32_t);
-  
-	// Start transmitting I2S data
-	NRF_I2S->TASKS_START = 1;
+	sound_play(SOUND_CLIP_CUICA);
 }
 
 /*@brief sound_claves_start
 */
 void sound_claves_start()
 {
-	// Configure data pointer
-	NRF_I2S->TXD.PTR = (uint32_t)&sine_claves[0];
-	NRF_I2S->RXTXD.MAXCNT = sizeof(sine_claves) / sizeof(uint32_t);
-  
-	// Start transmitting I2S data
-	NRF_I2S->TASKS_START = 1;
+	sound_play(SOUND_CLIP_CLAVES);
 }
@@ -0,0 +1,301 @@
+#include <string.h>
+#include "accel_codec.h"
+
+#define ACCEL_CODEC_HEADER_LEN    2                         // bit widths and sample count of a group
+#define ACCEL_CODEC_WIDTH_16      15                        // width nibble of a 16-bit delta
+
+static inline uint16_t zigzag(int16_t delta)
+{
+	return (uint16_t)(((uint16_t)delta << 1) ^ (uint16_t)(delta >> 15));
+}
+
+static inline int16_t unzigzag(uint16_t value)
+{
+	return (int16_t)((value >> 1) ^ (uint16_t)(0 - (value & 1)));
+}
+
+/*@brief Width nibble of the largest of the values ORed together
+*/
+static inline uint8_t width_nibble(uint16_t bits)
+{
+	uint8_t width = (bits == 0) ? 0 : (uint8_t)(32 - __builtin_clz(bits));
+
+	return (width >= ACCEL_CODEC_WIDTH_16) ? ACCEL_CODEC_WIDTH_16 : width;
+}
+
+static inline uint8_t nibble_bits(uint8_t nibble)
+{
+	return (nibble == ACCEL_CODEC_WIDTH_16) ? 16 : nibble;
+}
+
+static void key_write(accel_codec_t * p_codec, int16_t const * p_sample)
+{
+	uint8_t i;
+
+	for (i = 0; i < 3; i++)
+	{
+		p_codec->p_frame[2 * i]     = (uint8_t)p_sample[i];
+		p_codec->p_frame[2 * i + 1] = (uint8_t)((uint16_t)p_sample[i] >> 8);
+		p_codec->last[i]            = p_sample[i];
+	}
+	p_codec->length = ACCEL_CODEC_KEY_LEN;
+	p_codec->count  = 1;
+}
+
+/*@brief Encode the longest start of the waiting group that fits the frame
+ *
+ * @return true if the frame is complete.
+*/
+static bool group_encode(accel_codec_t * p_codec)
+{
+	uint16_t  zz[ACCEL_CODEC_GROUP][3];
+	uint16_t  bits[3] = { 0, 0, 0 };
+	uint8_t   widths[3] = { 0, 0, 0 };
+	uint8_t   fit = 0;
+	uint8_t   i, axis;
+	int16_t const * p_base = p_codec->last;
+
+	for (i = 0; i < p_codec->group_count; i++)
+	{
+		uint8_t  nibbles[3];
+		uint32_t sample_bits = 0;
+		uint32_t size;
+
+		for (axis = 0; axis < 3; axis++)
+		{
+			zz[i][axis]    = zigzag((int16_t)(p_codec->group[i][axis] - p_base[axis]));
+			bits[axis]    |= zz[i][axis];
+			nibbles[axis]  = width_nibble(bits[axis]);
+			sample_bits   += nibble_bits(nibbles[axis]);
+		}
+		p_base = p_codec->group[i];
+
+		// the widths only grow, once a prefix does not fit no longer one does
+		size = ACCEL_CODEC_HEADER_LEN + ((i + 1) * sample_bits + 7) / 8;
+		if (p_codec->length + size > p_codec->size)
+		{
+			break;
+		}
+		fit = i + 1;
+		memcpy(widths, nibbles, sizeof(widths));
+	}
+
+	if (fit > 0)
+	{
+		uint8_t * p_out = &p_codec->p_frame[p_codec->length];
+		uint32_t  acc   = 0;
+		uint8_t   used  = 0;
+
+		*p_out++ = (uint8_t)(widths[0] | (widths[1] << 4));
+		*p_out++ = (uint8_t)(widths[2] | ((fit - 1) << 4));
+
+		for (i = 0; i < fit; i++)
+		{
+			for (axis = 0; axis < 3; axis++)
+			{
+				acc  |= (uint32_t)zz[i][axis] << used;
+				used += nibble_bits(widths[axis]);
+				while (used >= 8)
+				{
+					*p_out++ = (uint8_t)acc;
+					acc    >>= 8;
+					used    -= 8;
+				}
+			}
+		}
+		if (used > 0)
+		{
+			*p_out++ = (uint8_t)acc;
+		}
+
+		p_codec->length = (uint16_t)(p_out - p_codec->p_frame);
+		p_codec->count += fit;
+		memcpy(p_codec->last, p_codec->group[fit - 1], sizeof(p_codec->last));
+
+		p_codec->group_count -= fit;
+		memmove(p_codec->group[0], p_codec->group[fit], p_codec->group_count * sizeof(p_codec->group[0]));
+	}
+
+	return (p_codec->group_count > 0) || (p_codec->length + ACCEL_CODEC_HEADER_LEN >= p_codec->size);
+}
+
+void accel_codec_init(accel_codec_t * p_codec, uint8_t * p_frame, uint16_t size)
+{
+	memset(p_codec, 0, sizeof(*p_codec));
+	p_codec->p_frame = p_frame;
+	p_codec->size    = size;
+}
+
+bool accel_codec_put(accel_codec_t * p_codec, int16_t const * p_sample)
+{
+	if (p_codec->count == 0)
+	{
+		key_write(p_codec, p_sample);
+		return false;
+	}
+
+	memcpy(p_codec->group[p_codec->group_count], p_sample, sizeof(p_codec->group[0]));
+	p_codec->group_count++;
+
+	if (p_codec->group_count < ACCEL_CODEC_GROUP)
+	{
+		return false;
+	}
+	return group_encode(p_codec);
+}
+
+uint16_t accel_codec_flush(accel_codec_t * p_codec)
+{
+	if (p_codec->group_count > 0)
+	{
+		(void)group_encode(p_codec);
+	}
+	return (p_codec->count > 0) ? p_codec->length : 0;
+}
+
+void accel_codec_next(accel_codec_t * p_codec)
+{
+	p_codec->length = 0;
+	p_codec->count  = 0;
+
+	// the first sample that did not fit is the key of this frame
+	if (p_codec->group_count > 0)
+	{
+		key_write(p_codec, p_codec->group[0]);
+		p_codec->group_count--;
+		memmove(p_codec->group[0], p_codec->group[1], p_codec->group_count * sizeof(p_codec->group[0]));
+	}
+}
+
+uint16_t accel_codec_decode(uint8_t const * p_frame, uint16_t length, int16_t (* p_out)[3], uint16_t max)
+{
+	uint16_t pos = ACCEL_CODEC_KEY_LEN;
+	uint16_t count;
+	uint8_t  axis;
+
+	if ((length < ACCEL_CODEC_KEY_LEN) || (max == 0))
+	{
+		return 0;
+	}
+
+	for (axis = 0; axis < 3; axis++)
+	{
+		p_out[0][axis] = (int16_t)(p_frame[2 * axis] | (p_frame[2 * axis + 1] << 8));
+	}
+	count = 1;
+
+	while (pos < length)
+	{
+		uint8_t  widths[3];
+		uint8_t  samples;
+		uint32_t acc  = 0;
+		uint8_t  have = 0;
+		uint32_t sample_bits;
+		uint8_t  i;
+
+		if (pos + ACCEL_CODEC_HEADER_LEN > length)
+		{
+			return 0;
+		}
+		widths[0] = nibble_bits(p_frame[pos] & 0x0F);
+		widths[1] = nibble_bits(p_frame[pos] >> 4);
+		widths[2] = nibble_bits(p_frame[pos + 1] & 0x0F);
+		samples   = (uint8_t)((p_frame[pos + 1] >> 4) + 1);
+		pos      += ACCEL_CODEC_HEADER_LEN;
+
+		sample_bits = widths[0] + widths[1] + widths[2];
+		if ((pos + (samples * sample_bits + 7) / 8 > length) || (samples > ACCEL_CODEC_GROUP) || (count + samples > max))
+		{
+			return 0;
+		}
+
+		for (i = 0; i < samples; i++)
+		{
+			for (axis = 0; axis < 3; axis++)
+			{
+				uint16_t value;
+
+				while (have < widths[axis])
+				{
+					acc  |= (uint32_t)p_frame[pos++] << have;
+					have += 8;
+				}
+				value  = (uint16_t)(acc & ((1UL << widths[axis]) - 1));
+				acc  >>= widths[axis];
+				have  -= widths[axis];
+
+				p_out[count][axis] = (int16_t)(p_out[count - 1][axis] + unzigzag(value));
+			}
+			count++;
+		}
+	}
+
+	return count;
+}
+
+uint16_t accel_codec_pack(int16_t const * p_sample, uint8_t bits, uint8_t * p_frame, uint16_t count)
+{
+	uint32_t bit  = (uint32_t)count * 3 * bits;
+	uint16_t mask = (uint16_t)((1UL << bits) - 1);
+	uint8_t  axis;
+
+	for (axis = 0; axis < 3; axis++)
+	{
+		uint16_t value = (uint16_t)(p_sample[axis] >> (ACCEL_CODEC_PACK_BITS_MAX - bits)) & mask;
+		uint8_t  shift = bit & 7;
+		uint32_t word  = (uint32_t)value << shift;
+		uint8_t * p_out = &p_frame[bit >> 3];
+
+		// keep the bits of the value before in the first byte, the others are new
+		p_out[0] = (uint8_t)((p_out[0] & ((1 << shift) - 1)) | word);
+		if (shift + bits > 8)
+		{
+			p_out[1] = (uint8_t)(word >> 8);
+		}
+		if (shift + bits > 16)
+		{
+			p_out[2] = (uint8_t)(word >> 16);
+		}
+		bit += bits;
+	}
+
+	return (uint16_t)((bit + 7) / 8);
+}
+
+uint16_t accel_codec_unpack(uint8_t const * p_frame, uint16_t length, uint8_t bits, int16_t (* p_out)[3], uint16_t max)
+{
+	uint16_t count = (uint16_t)(((uint32_t)length * 8) / (3 * bits));
+	uint32_t bit   = 0;
+	uint16_t i;
+	uint8_t  axis;
+
+	if (count > max)
+	{
+		return 0;
+	}
+
+	for (i = 0; i < count; i++)
+	{
+		for (axis = 0; axis < 3; axis++)
+		{
+			uint32_t pos  = bit >> 3;
+			uint32_t word = p_frame[pos];
+
+			if ((bit & 7) + bits > 8)
+			{
+				word |= (uint32_t)p_frame[pos + 1] << 8;
+			}
+			if ((bit & 7) + bits > 16)
+			{
+				word |= (uint32_t)p_frame[pos + 2] << 16;
+			}
+
+			// sign extend from the top bit of the value, then back to 14-bit counts
+			word = (word >> (bit & 7)) << (32 - bits);
+			p_out[i][axis] = (int16_t)(((int32_t)word >> (32 - bits)) * (1 << (ACCEL_CODEC_PACK_BITS_MAX - bits)));
+			bit += bits;
+		}
+	}
+
+	return count;
+}
@@ -0,0 +1,92 @@
+#include "adpcm.h"
+
+#define ADPCM_STEP_INDEX_MAX    88
+
+static const int16_t m_steps[ADPCM_STEP_INDEX_MAX + 1] =
+{
+	    7,     8,     9,    10,    11,    12,    13,    14,    16,    17,
+	   19,    21,    23,    25,    28,    31,    34,    37,    41,    45,
+	   50,    55,    60,    66,    73,    80,    88,    97,   107,   118,
+	  130,   143,   157,   173,   190,   209,   230,   253,   279,   307,
+	  337,   371,   408,   449,   494,   544,   598,   658,   724,   796,
+	  876,   963,  1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+	 2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,
+	 5894,  6484,  7132,  7845,  8630,  9493, 10442, 11487, 12635, 13899,
+	15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+static const int8_t m_index_adjust[8] = { -1, -1, -1, -1, 2, 4, 6, 8 };
+
+/*@brief One nibble, updates the state and returns the decoded sample
+*/
+static inline int16_t nibble_decode(adpcm_state_t * p_state, uint8_t nibble)
+{
+	int32_t step  = m_steps[p_state->step_index];
+	int32_t diff  = step >> 3;
+	int32_t value = p_state->predictor;
+	int32_t index = p_state->step_index + m_index_adjust[nibble & 7];
+
+	if (nibble & 4) diff += step;
+	if (nibble & 2) diff += step >> 1;
+	if (nibble & 1) diff += step >> 2;
+
+	value += (nibble & 8) ? -diff : diff;
+	value  = (value > INT16_MAX) ? INT16_MAX : ((value < INT16_MIN) ? INT16_MIN : value);
+	index  = (index < 0) ? 0 : ((index > ADPCM_STEP_INDEX_MAX) ? ADPCM_STEP_INDEX_MAX : index);
+
+	p_state->predictor  = (int16_t)value;
+	p_state->step_index = (uint8_t)index;
+
+	return (int16_t)value;
+}
+
+void adpcm_decode(adpcm_state_t * p_state, uint8_t const * p_in, uint32_t length, int16_t * p_out)
+{
+	uint32_t i;
+
+	if (p_state->step_index > ADPCM_STEP_INDEX_MAX)
+	{
+		p_state->step_index = ADPCM_STEP_INDEX_MAX;
+	}
+
+	for (i = 0; i < length; i++)
+	{
+		*p_out++ = nibble_decode(p_state, p_in[i] & 0x0F);
+		*p_out++ = nibble_decode(p_state, p_in[i] >> 4);
+	}
+}
+
+/*@brief One sample, the nibble is decoded again so the encoder tracks the decoder exactly
+*/
+static inline uint8_t nibble_encode(adpcm_state_t * p_state, int16_t sample)
+{
+	int32_t step   = m_steps[p_state->step_index];
+	int32_t diff   = sample - p_state->predictor;
+	uint8_t nibble = 0;
+
+	if (diff < 0)
+	{
+		nibble = 8;
+		diff   = -diff;
+	}
+	if (diff >= step)        { nibble |= 4; diff -= step; }
+	if (diff >= (step >> 1)) { nibble |= 2; diff -= step >> 1; }
+	if (diff >= (step >> 2)) { nibble |= 1; }
+
+	(void)nibble_decode(p_state, nibble);
+
+	return nibble;
+}
+
+void adpcm_encode(adpcm_state_t * p_state, int16_t const * p_in, uint32_t length, uint8_t * p_out)
+{
+	uint32_t i;
+
+	for (i = 0; i < length; i++)
+	{
+		uint8_t low  = nibble_encode(p_state, *p_in++);
+		uint8_t high = nibble_encode(p_state, *p_in++);
+
+		p_out[i] = (uint8_t)(low | (high << 4));
+	}
+}
@@ -0,0 +1,121 @@
+#include <stdlib.h>
+#include <string.h>
+#include "beacon.h"
+#include "nordic_common.h"
+#include "app_util.h"
+#include "nrf_saadc.h"
+
+#define BEACON_SUPPLY_RANGE_MV        3600                  // internal 0.6 V reference at a gain of 1/6
+#define BEACON_SUPPLY_FULL_SCALE      1024                  // 10-bit conversion
+
+static int16_t   m_accel[3];                                // latest sample
+static bool      m_primed;                                  // m_accel is recent enough to take changes from
+static bool      m_fresh;                                   // a sample came in this window
+static uint32_t  m_change;                                  // sum of the changes over the window, counts
+static uint32_t  m_changes;                                 // changes in the window
+static uint8_t   m_sequence;
+
+void beacon_init(void)
+{
+	memset(m_accel, 0, sizeof(m_accel));
+	m_primed   = false;
+	m_fresh    = false;
+	m_change   = 0;
+	m_changes  = 0;
+	m_sequence = 0;
+}
+
+void beacon_sample_put(int16_t const * p_accel)
+{
+	uint8_t i;
+
+	for (i = 0; i < 3; i++)
+	{
+		if (m_primed)
+		{
+			m_change += (uint32_t)abs(p_accel[i] - m_accel[i]);
+		}
+		m_accel[i] = p_accel[i];
+	}
+	m_changes += m_primed ? 1 : 0;
+	m_primed   = true;
+	m_fresh    = true;
+}
+
+uint16_t beacon_supply_read(void)
+{
+	nrf_saadc_channel_config_t const config =
+	{
+		.resistor_p = NRF_SAADC_RESISTOR_DISABLED,
+		.resistor_n = NRF_SAADC_RESISTOR_DISABLED,
+		.gain       = NRF_SAADC_GAIN1_6,
+		.reference  = NRF_SAADC_REFERENCE_INTERNAL,
+		.acq_time   = NRF_SAADC_ACQTIME_10US,
+		.mode       = NRF_SAADC_MODE_SINGLE_ENDED,
+		.burst      = NRF_SAADC_BURST_DISABLED,
+		.pin_p      = NRF_SAADC_INPUT_VDD,
+		.pin_n      = NRF_SAADC_INPUT_DISABLED,
+	};
+	nrf_saadc_value_t value = 0;
+
+	nrf_saadc_resolution_set(NRF_SAADC_RESOLUTION_10BIT);
+	nrf_saadc_oversample_set(NRF_SAADC_OVERSAMPLE_DISABLED);
+	nrf_saadc_channel_init(0, &config);
+	nrf_saadc_buffer_init(&value, 1);
+	nrf_saadc_enable();
+
+	nrf_saadc_task_trigger(NRF_SAADC_TASK_START);
+	while (!nrf_saadc_event_check(NRF_SAADC_EVENT_STARTED))
+	{
+	}
+	nrf_saadc_event_clear(NRF_SAADC_EVENT_STARTED);
+
+	nrf_saadc_task_trigger(NRF_SAADC_TASK_SAMPLE);
+	while (!nrf_saadc_event_check(NRF_SAADC_EVENT_END))
+	{
+	}
+	nrf_saadc_event_clear(NRF_SAADC_EVENT_END);
+
+	nrf_saadc_task_trigger(NRF_SAADC_TASK_STOP);
+	while (!nrf_saadc_event_check(NRF_SAADC_EVENT_STOPPED))
+	{
+	}
+	nrf_saadc_event_clear(NRF_SAADC_EVENT_STOPPED);
+
+	// the channel left connected would keep the SAADC drawing current
+	nrf_saadc_channel_input_set(0, NRF_SAADC_INPUT_DISABLED, NRF_SAADC_INPUT_DISABLED);
+	nrf_saadc_disable();
+
+	return (uint16_t)(((uint32_t)MAX(value, 0) * BEACON_SUPPLY_RANGE_MV) / BEACON_SUPPLY_FULL_SCALE);
+}
+
+void beacon_encode(uint8_t flags, uint8_t * p_data)
+{
+	uint32_t activity = 0;
+	uint8_t  i;
+
+	if (m_changes > 0)
+	{
+		activity = (m_change / m_changes) >> BEACON_ACTIVITY_SHIFT;
+	}
+	if (!m_fresh)
+	{
+		// a sample from before the accelerometer was suspended says nothing of the next change
+		flags   |= BEACON_FLAG_STALE;
+		m_primed = false;
+	}
+
+	p_data[0] = BEACON_VERSION;
+	p_data[1] = m_sequence++;
+	for (i = 0; i < 3; i++)
+	{
+		(void)uint16_encode((uint16_t)m_accel[i], &p_data[2 + 2 * i]);
+	}
+	p_data[8]  = (uint8_t)MIN(activity, UINT8_MAX);
+	p_data[9]  = (uint8_t)MIN(beacon_supply_read() / BEACON_BATTERY_STEP_MV, UINT8_MAX);
+	p_data[10] = flags;
+
+	m_change  = 0;
+	m_changes = 0;
+	m_fresh   = false;
+}
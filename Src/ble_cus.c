@@ -11,8 +11,88 @@
 #include "app_error.h"
 #include "ble_cus.h"
 
-#include "common_var.h"
 
+/**@brief Function for reading whether a client has notifications on, from the CCCD of this connection.
+ *
+ * @param[in]   conn_handle   Connection.
+ * @param[in]   cccd_handle   CCCD of the characteristic.
+ *
+ * @return      true if notifications are enabled.
+ */
+static bool cccd_notify_get(uint16_t conn_handle, uint16_t cccd_handle)
+{
+    uint8_t           cccd[BLE_CCCD_VALUE_LEN] = {0};
+    ble_gatts_value_t gatts_value;
+
+    if (cccd_handle == BLE_GATT_HANDLE_INVALID)
+    {
+        return false;
+    }
+
+    memset(&gatts_value, 0, sizeof(gatts_value));
+    gatts_value.len     = sizeof(cccd);
+    gatts_value.offset  = 0;
+    gatts_value.p_value = cccd;
+
+    if (sd_ble_gatts_value_get(conn_handle, cccd_handle, &gatts_value) != NRF_SUCCESS)
+    {
+        return false;
+    }
+    return ble_srv_is_notification_enabled(cccd);
+}
+
+/**@brief Function for finding the subscriptions of a connection.
+ *
+ * @param[in]   p_cus         Custom service structure.
+ * @param[in]   conn_handle   Connection, BLE_CONN_HANDLE_INVALID finds a free entry.
+ *
+ * @return      The entry, NULL if there is none.
+ */
+static ble_cus_link_t * link_find(ble_cus_t * p_cus, uint16_t conn_handle)
+{
+    uint8_t i;
+
+    for (i = 0; i < BLE_CUS_LINK_COUNT; i++)
+    {
+        if (p_cus->links[i].conn_handle == conn_handle)
+        {
+            return &p_cus->links[i];
+        }
+    }
+    return NULL;
+}
+
+/**@brief Function for loading the subscriptions of the connection.
+ *
+ * @details A bonded client finds its CCCDs as it left them, the Peer Manager restores them without
+ *          a write. Called on connection and once the link is secured, the application hears of
+ *          every change as if the client had written it.
+ *
+ * @param[in]   p_cus       Custom service structure.
+ * @param[in]   p_link      Subscriptions of the connection.
+ */
+static void subscriptions_load(ble_cus_t * p_cus, ble_cus_link_t * p_link)
+{
+    ble_cus_evt_t evt;
+    bool          acel_notify  = cccd_notify_get(p_link->conn_handle, p_cus->temperature_value_handles.cccd_handle);
+    bool          sound_notify = cccd_notify_get(p_link->conn_handle, p_cus->sound_status_handles.cccd_handle);
+
+    evt.conn_handle = p_link->conn_handle;
+
+    if (acel_notify != p_link->acel_notify)
+    {
+        p_link->acel_notify = acel_notify;
+        evt.evt_type = acel_notify ? BLE_TEMP_NOTIFICATION_ENABLED : BLE_TEMP_NOTIFICATION_DISABLED;
+        p_cus->evt_handler(p_cus, &evt);
+    }
+
+    if (sound_notify != p_link->sound_status_notify)
+    {
+        p_link->sound_status_notify = sound_notify;
+        evt.evt_type = sound_notify ? BLE_SOUND_STATUS_NOTIFICATION_ENABLED : BLE_SOUND_STATUS_NOTIFICATION_DISABLED;
+        p_cus->evt_handler(p_cus, &evt);
+    }
+}
 
 /**@brief Function for handling the Connect event.
  *
@@ -21,16 +101,26 @@
  */
 static void on_connect(ble_cus_t * p_cus, ble_evt_t const * p_ble_evt)
 {
-    UNUSED_PARAMETER(p_ble_evt);
+    ble_cus_link_t * p_link = link_find(p_cus, BLE_CONN_HANDLE_INVALID);
 
-    p_cus->conn_handle = p_ble_evt->evt.gap_evt.conn_handle;
+    // the SoftDevice takes no more connections than there are entries
+    if (p_link == NULL)
+    {
+        return;
+    }
+
+    p_link->conn_handle         = p_ble_evt->evt.gap_evt.conn_handle;
+    p_link->acel_notify         = false;
+    p_link->sound_status_notify = false;
 
     ble_cus_evt_t evt;
 
-    evt.evt_type = BLE_CUS_EVT_CONNECTED;
+    evt.evt_type    = BLE_CUS_EVT_CONNECTED;
+    evt.conn_handle = p_link->conn_handle;
 
     p_cus->evt_handler(p_cus, &evt);
 
+    subscriptions_load(p_cus, p_link);
 }
 
 /**@brief Function for handling the Disconnect event.
@@ -40,13 +130,19 @@ static void on_connect(ble_cus_t * p_cus, ble_evt_t const * p_ble_evt)
  */
 static void on_disconnect(ble_cus_t * p_cus, ble_evt_t const * p_ble_evt)
 {
-    UNUSED_PARAMETER(p_ble_evt);
+    ble_cus_link_t * p_link = link_find(p_cus, p_ble_evt->evt.gap_evt.conn_handle);
 
-    p_cus->conn_handle = BLE_CONN_HANDLE_INVALID; 
+    if (p_link != NULL)
+    {
+        p_link->conn_handle         = BLE_CONN_HANDLE_INVALID;
+        p_link->sound_status_notify = false;
+        p_link->acel_notify         = false;
+    }
       
     ble_cus_evt_t evt;
 
-    evt.evt_type = BLE_CUS_EVT_DISCONNECTED;
+    evt.evt_type    = BLE_CUS_EVT_DISCONNECTED;
+    evt.conn_handle = p_ble_evt->evt.gap_evt.conn_handle;
 
     p_cus->evt_handler(p_cus, &evt);
 
@@ -61,8 +157,33 @@ static void on_disconnect(ble_cus_t * p_cus, ble_evt_t const * p_ble_evt)
 static void on_write(ble_cus_t * p_cus, ble_evt_t const * p_ble_evt)
 {
     ble_gatts_evt_write_t const * p_evt_write = &p_ble_evt->evt.gatts_evt.params.write;
+    ble_cus_link_t              * p_link      = link_find(p_cus, p_ble_evt->evt.gatts_evt.conn_handle);
     ble_cus_evt_t                 evt;
 
+    evt.conn_handle = p_ble_evt->evt.gatts_evt.conn_handle;
+
+    // audio stream frame, written without response
+    if ((p_evt_write->handle == p_cus->audio_stream_handles.value_handle) && (p_cus->evt_handler != NULL))
+    {
+        evt.params_command.command_data.p_data = p_evt_write->data;
+        evt.params_command.command_data.length = p_evt_write->len;
+        evt.evt_type = BLE_CUS_EVT_AUDIO_RX;
+
+        p_cus->evt_handler(p_cus, &evt);
+        return;
+    }
+
+    // clip upload block, written without response
+    if ((p_evt_write->handle == p_cus->clip_upload_handles.value_handle) && (p_cus->evt_handler != NULL))
+    {
+        evt.params_command.command_data.p_data = p_evt_write->data;
+        evt.params_command.command_data.length = p_evt_write->len;
+        evt.evt_type = BLE_CUS_EVT_CLIP_RX;
+
+        p_cus->evt_handler(p_cus, &evt);
+        return;
+    }
+
     // writing to the command characteristic
    if ( p_evt_write->handle == p_cus->command_value_handles.value_handle)
     { 
@@ -72,11 +193,6 @@ static void on_write(ble_cus_t * p_cus, ble_evt_t const * p_ble_evt)
 
         p_cus->evt_handler(p_cus, &evt);
     }
-    
-	if (p_evt_write->handle == 0x0014)
-	{
-		set_play_sound_condition(p_evt_write->data[0]);//p_ble_evt->evt.gatts_evt.params.write.data[0]);		
-	}
 
 	if (p_evt_write->handle == p_cus->temperature_value_handles.value_handle)
 	{
@@ -85,26 +201,36 @@ static void on_write(ble_cus_t * p_cus, ble_evt_t const * p_ble_evt)
     // writing to the temperature characteristic
    if ((p_evt_write->handle == p_cus->temperature_value_handles.cccd_handle)
         && (p_evt_write->len == 2)
+        && (p_link != NULL)
        )
     {
+        p_link->acel_notify = ble_srv_is_notification_enabled(p_evt_write->data);
+
         // CCCD written, call application event handler
         if (p_cus->evt_handler != NULL)
         {
-
-            if (ble_srv_is_notification_enabled(p_evt_write->data))
-            {
-	            enableNotificationAcel = 1;
-                evt.evt_type = BLE_TEMP_NOTIFICATION_ENABLED;
-            }
-            else
-            {
-//	            enableNotificationAcel = 0;
-                evt.evt_type = BLE_TEMP_NOTIFICATION_DISABLED;
-            }
+            evt.evt_type = p_link->acel_notify ? BLE_TEMP_NOTIFICATION_ENABLED
+                                               : BLE_TEMP_NOTIFICATION_DISABLED;
             // Call the application event handler.
             p_cus->evt_handler(p_cus, &evt);
         }
     }
+
+    // writing to the sound status cccd
+   if ((p_evt_write->handle == p_cus->sound_status_handles.cccd_handle)
+        && (p_evt_write->len == 2)
+        && (p_link != NULL)
+       )
+    {
+        p_link->sound_status_notify = ble_srv_is_notification_enabled(p_evt_write->data);
+
+        if (p_cus->evt_handler != NULL)
+        {
+            evt.evt_type = p_link->sound_status_notify ? BLE_SOUND_STATUS_NOTIFICATION_ENABLED
+                                                       : BLE_SOUND_STATUS_NOTIFICATION_DISABLED;
+            p_cus->evt_handler(p_cus, &evt);
+        }
+    }
 }
 
 /**@brief Function for handling the Custom servie ble events.
@@ -134,6 +260,16 @@ void ble_cus_on_ble_evt( ble_evt_t const * p_ble_evt, void * p_context)
             on_write(p_cus, p_ble_evt);
             break;
 
+        case BLE_GAP_EVT_CONN_SEC_UPDATE:
+        {
+            ble_cus_link_t * p_link = link_find(p_cus, p_ble_evt->evt.gap_evt.conn_handle);
+
+            if (p_link != NULL)
+            {
+                subscriptions_load(p_cus, p_link);
+            }
+        } break;
+
         default:
             // No implementation needed.
             break;
@@ -157,8 +293,8 @@ static uint32_t temperature_char_add(ble_cus_t * p_cus, const ble_cus_init_t * p
     ble_uuid_t          ble_uuid;
     ble_gatts_attr_md_t attr_md;
 
-    uint8_t char_len = 6;
-    uint8_t init_value[6] = {0x12, 0x34, 0x56, 0x78, 0x88, 0x99};
+    uint8_t char_len = ACEL_SAMPLE_LEN;
+    uint8_t init_value[ACEL_SAMPLE_LEN] = {0x12, 0x34, 0x56, 0x78, 0x88, 0x99};
 
     // Add Custom Value characteristic
     memset(&cccd_md, 0, sizeof(cccd_md));
@@ -190,14 +326,15 @@ static uint32_t temperature_char_add(ble_cus_t * p_cus, const ble_cus_init_t * p
     attr_md.vloc       = BLE_GATTS_VLOC_STACK;
     attr_md.rd_auth    = 0;
     attr_md.wr_auth    = 0;
-    attr_md.vlen       = 0;
+    attr_md.vlen       = 1;
 
     memset(&attr_char_value, 0, sizeof(attr_char_value));
 
+    // one sample until the first notification, up to a full MTU of samples after
     attr_char_value.p_uuid    = &ble_uuid;
     attr_char_value.p_attr_md = &attr_md;
     attr_char_value.init_len  = char_len;
-    attr_char_value.max_len   = char_len;
+    attr_char_value.max_len   = ACEL_VALUE_CHAR_MAX_LEN;
     attr_char_value.p_value   = init_value;
 
     err_code = sd_ble_gatts_characteristic_add(p_cus->service_handle, 
@@ -251,14 +388,14 @@ static uint32_t command_char_add(ble_cus_t * p_cus, const ble_cus_init_t * p_cus
     attr_md.vloc       = BLE_GATTS_VLOC_STACK;
     attr_md.rd_auth    = 0;
     attr_md.wr_auth    = 0;
-    attr_md.vlen       = 0;
+    attr_md.vlen       = 1;
 
     memset(&attr_char_value, 0, sizeof(attr_char_value));
 
     attr_char_value.p_uuid    = &ble_uuid;
     attr_char_value.p_attr_md = &attr_md;
     attr_char_value.init_len  = char_len;
-    attr_char_value.max_len   = char_len;
+    attr_char_value.max_len   = COMMAND_CHAR_MAX_LEN;
     attr_char_value.p_value   = init_value;
 
     err_code = sd_ble_gatts_characteristic_add(p_cus->service_handle, 
@@ -275,6 +412,177 @@ static uint32_t command_char_add(ble_cus_t * p_cus, const ble_cus_init_t * p_cus
 }
 
 
+/**@brief Function for adding the Sound status characteristic.
+ *
+ * @param[in]   p_cus        Custom service structure.
+ * @param[in]   p_cus_init   Information needed to initialize the service.
+ *
+ * @return      NRF_SUCCESS on success, otherwise an error code.
+ */
+static uint32_t sound_status_char_add(ble_cus_t * p_cus, const ble_cus_init_t * p_cus_init)
+{
+
+    uint32_t            err_code;
+    ble_gatts_char_md_t char_md;
+    ble_gatts_attr_md_t cccd_md;
+    ble_gatts_attr_t    attr_char_value;
+    ble_uuid_t          ble_uuid;
+    ble_gatts_attr_md_t attr_md;
+
+    uint8_t init_value[SOUND_STATUS_CHAR_LEN] = {0};
+
+    memset(&cccd_md, 0, sizeof(cccd_md));
+
+    BLE_GAP_CONN_SEC_MODE_SET_OPEN(&cccd_md.read_perm); 
+    cccd_md.write_perm = p_cus_init->temperature_char_attr_md.cccd_write_perm;
+    cccd_md.vloc       = BLE_GATTS_VLOC_STACK;
+
+    memset(&char_md, 0, sizeof(char_md));
+
+    char_md.char_props.read   = 1;
+    char_md.char_props.write  = 0;
+    char_md.char_props.notify = 1;
+    char_md.p_char_user_desc  = NULL;
+    char_md.p_char_pf         = NULL;
+    char_md.p_user_desc_md    = NULL;
+    char_md.p_cccd_md         = &cccd_md; 
+    char_md.p_sccd_md         = NULL;
+
+    ble_uuid.type = p_cus->uuid_type;
+    ble_uuid.uuid = SOUND_STATUS_CHAR_UUID;
+
+    memset(&attr_md, 0, sizeof(attr_md));
+
+    attr_md.read_perm  = p_cus_init->temperature_char_attr_md.read_perm;
+    attr_md.write_perm = p_cus_init->temperature_char_attr_md.write_perm;
+    attr_md.vloc       = BLE_GATTS_VLOC_STACK;
+    attr_md.rd_auth    = 0;
+    attr_md.wr_auth    = 0;
+    attr_md.vlen       = 0;
+
+    memset(&attr_char_value, 0, sizeof(attr_char_value));
+
+    attr_char_value.p_uuid    = &ble_uuid;
+    attr_char_value.p_attr_md = &attr_md;
+    attr_char_value.init_len  = SOUND_STATUS_CHAR_LEN;
+    attr_char_value.max_len   = SOUND_STATUS_CHAR_LEN;
+    attr_char_value.p_value   = init_value;
+
+    return sd_ble_gatts_characteristic_add(p_cus->service_handle, 
+                                           &char_md,
+                                           &attr_char_value,
+                                           &p_cus->sound_status_handles);
+}
+
+
+/**@brief Function for adding the Audio stream characteristic.
+ *
+ * @param[in]   p_cus        Custom service structure.
+ * @param[in]   p_cus_init   Information needed to initialize the service.
+ *
+ * @return      NRF_SUCCESS on success, otherwise an error code.
+ */
+static uint32_t audio_stream_char_add(ble_cus_t * p_cus, const ble_cus_init_t * p_cus_init)
+{
+    ble_gatts_char_md_t char_md;
+    ble_gatts_attr_t    attr_char_value;
+    ble_uuid_t          ble_uuid;
+    ble_gatts_attr_md_t attr_md;
+    uint8_t init_value[1] = {0};
+
+    memset(&char_md, 0, sizeof(char_md));
+
+    char_md.char_props.read          = 0;
+    char_md.char_props.write         = 0;
+    char_md.char_props.write_wo_resp = 1;
+    char_md.char_props.notify        = 0;
+    char_md.p_char_user_desc         = NULL;
+    char_md.p_char_pf                = NULL;
+    char_md.p_user_desc_md           = NULL;
+    char_md.p_cccd_md                = NULL;
+    char_md.p_sccd_md                = NULL;
+
+    ble_uuid.type = p_cus->uuid_type;
+    ble_uuid.uuid = AUDIO_STREAM_CHAR_UUID;
+
+    memset(&attr_md, 0, sizeof(attr_md));
+
+    attr_md.read_perm  = p_cus_init->command_char_attr_md.read_perm;
+    attr_md.write_perm = p_cus_init->command_char_attr_md.write_perm;
+    attr_md.vloc       = BLE_GATTS_VLOC_STACK;
+    attr_md.rd_auth    = 0;
+    attr_md.wr_auth    = 0;
+    attr_md.vlen       = 1;
+
+    memset(&attr_char_value, 0, sizeof(attr_char_value));
+
+    attr_char_value.p_uuid    = &ble_uuid;
+    attr_char_value.p_attr_md = &attr_md;
+    attr_char_value.init_len  = sizeof(init_value);
+    attr_char_value.max_len   = AUDIO_STREAM_CHAR_MAX_LEN;
+    attr_char_value.p_value   = init_value;
+
+    return sd_ble_gatts_characteristic_add(p_cus->service_handle, 
+                                           &char_md,
+                                           &attr_char_value,
+                                           &p_cus->audio_stream_handles);
+}
+
+
+/**@brief Function for adding the Clip upload characteristic.
+ *
+ * @param[in]   p_cus        Custom service structure.
+ * @param[in]   p_cus_init   Information needed to initialize the service.
+ *
+ * @return      NRF_SUCCESS on success, otherwise an error code.
+ */
+static uint32_t clip_upload_char_add(ble_cus_t * p_cus, const ble_cus_init_t * p_cus_init)
+{
+    ble_gatts_char_md_t char_md;
+    ble_gatts_attr_t    attr_char_value;
+    ble_uuid_t          ble_uuid;
+    ble_gatts_attr_md_t attr_md;
+    uint8_t init_value[1] = {0};
+
+    memset(&char_md, 0, sizeof(char_md));
+
+    char_md.char_props.read          = 0;
+    char_md.char_props.write         = 0;
+    char_md.char_props.write_wo_resp = 1;
+    char_md.char_props.notify        = 0;
+    char_md.p_char_user_desc         = NULL;
+    char_md.p_char_pf                = NULL;
+    char_md.p_user_desc_md           = NULL;
+    char_md.p_cccd_md                = NULL;
+    char_md.p_sccd_md                = NULL;
+
+    ble_uuid.type = p_cus->uuid_type;
+    ble_uuid.uuid = CLIP_UPLOAD_CHAR_UUID;
+
+    memset(&attr_md, 0, sizeof(attr_md));
+
+    attr_md.read_perm  = p_cus_init->command_char_attr_md.read_perm;
+    attr_md.write_perm = p_cus_init->command_char_attr_md.write_perm;
+    attr_md.vloc       = BLE_GATTS_VLOC_STACK;
+    attr_md.rd_auth    = 0;
+    attr_md.wr_auth    = 0;
+    attr_md.vlen       = 1;
+
+    memset(&attr_char_value, 0, sizeof(attr_char_value));
+
+    attr_char_value.p_uuid    = &ble_uuid;
+    attr_char_value.p_attr_md = &attr_md;
+    attr_char_value.init_len  = sizeof(init_value);
+    attr_char_value.max_len   = CLIP_UPLOAD_CHAR_MAX_LEN;
+    attr_char_value.p_value   = init_value;
+
+    return sd_ble_gatts_characteristic_add(p_cus->service_handle, 
+                                           &char_md,
+                                           &attr_char_value,
+                                           &p_cus->clip_upload_handles);
+}
+
+
 /**@brief Function for initializing the Custom ble service.
  *
  * @param[in]   p_cus       Custom service structure.
@@ -292,7 +600,11 @@ uint32_t ble_cus_init(ble_cus_t * p_cus, ble_cus_t *p_acel, const ble_cus_init_t
 #pragma region CUS_SERVICE_UUID_BASE
     // Initializing the  service structure
     p_cus->evt_handler               = p_cus_init->evt_handler;
-    p_cus->conn_handle               = BLE_CONN_HANDLE_INVALID;
+    memset(p_cus->links, 0, sizeof(p_cus->links));
+    for (uint8_t i = 0; i < BLE_CUS_LINK_COUNT; i++)
+    {
+        p_cus->links[i].conn_handle  = BLE_CONN_HANDLE_INVALID;
+    }
 
 	// Add the Custom bel Service UUID
 	ble_uuid128_t base_uuid = CUS_SERVICE_UUID_BASE;
@@ -321,7 +633,11 @@ uint32_t ble_cus_init(ble_cus_t * p_cus, ble_cus_t *p_acel, const ble_cus_init_t
 //--------------------------------------------------------------------------
     // Initializing the  service structure
     p_acel->evt_handler        = p_acel_init->evt_handler;
-	  p_acel->conn_handle        = BLE_CONN_HANDLE_INVALID;
+    memset(p_acel->links, 0, sizeof(p_acel->links));
+    for (uint8_t i = 0; i < BLE_CUS_LINK_COUNT; i++)
+    {
+        p_acel->links[i].conn_handle = BLE_CONN_HANDLE_INVALID;
+    }
 
 	// Add the Custom bel Service UUID
 	ble_uuid128_t acel_base_uuid = ACEL_SERVICE_UUID_BASE;
@@ -347,77 +663,172 @@ uint32_t ble_cus_init(ble_cus_t * p_cus, ble_cus_t *p_acel, const ble_cus_init_t
  err_code =  command_char_add(p_acel, p_acel_init);
 	APP_ERROR_CHECK(err_code);				  
 
+	// Add the sound status characteristic
+	err_code =  sound_status_char_add(p_acel, p_acel_init);
+	APP_ERROR_CHECK(err_code);
+
+	// Add the audio stream characteristic
+	err_code =  audio_stream_char_add(p_acel, p_acel_init);
+	APP_ERROR_CHECK(err_code);
+
+	// Add the clip upload characteristic
+	err_code =  clip_upload_char_add(p_acel, p_acel_init);
+	APP_ERROR_CHECK(err_code);
+
    return NRF_SUCCESS;
 
 }
 
 /**@brief Function for updating the temperature data.
  *
- * @note 
+ * @note    The value is a stream frame header, see stream_frame.h, then the samples in its encoding,
+ *          as many as fit the negotiated MTU.
  *       
  * @param[in]   p_cus          Custom Service structure.
+ * @param[in]   conn_handle    connection to notify
  * @param[in]   p_data         data array
  * @param[in]   p_length       length
  *
- * @return      NRF_SUCCESS on success, otherwise an error code.
+ * @return      NRF_SUCCESS on success, NRF_ERROR_INVALID_STATE if that client does not listen, otherwise an error code.
  */
 
-uint32_t acelerometer_value_update(ble_cus_t * p_cus, uint8_t  * p_data, uint16_t  p_length)
+uint32_t acelerometer_value_update(ble_cus_t * p_cus, uint16_t conn_handle, uint8_t  * p_data, uint16_t  p_length)
 {
-    uint32_t   err_code;
+    ble_gatts_hvx_params_t hvx_params;
+    ble_cus_link_t       * p_link;
+    uint16_t               len = p_length;
 
     if (p_cus == NULL)
     {                                                                                          
         return NRF_ERROR_NULL;
     }
 
-    ble_gatts_value_t   gatts_value;
-    ble_cus_evt_t               evt;
+    // Notify the host, if connected and notifications are enabled.
+    p_link = (conn_handle != BLE_CONN_HANDLE_INVALID) ? link_find(p_cus, conn_handle) : NULL;
+    if ((p_link == NULL) || !p_link->acel_notify)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    memset(&hvx_params, 0, sizeof(hvx_params));
+
+    // the notification updates the attribute value as well, no sd_ble_gatts_value_set() per frame
+    hvx_params.handle = p_cus->temperature_value_handles.value_handle;
+    hvx_params.type   = BLE_GATT_HVX_NOTIFICATION;
+    hvx_params.offset = 0;
+    hvx_params.p_len  = &len;
+    hvx_params.p_data = p_data;
+
+    // NRF_ERROR_RESOURCES while the SoftDevice queue is full, sent on a later try
+    return sd_ble_gatts_hvx(conn_handle, &hvx_params);
+}
+
+/**@brief Function for notifying a frame on the sound status characteristic, to one client.
+ *
+ * @param[in]   p_cus          Custom Service structure.
+ * @param[in]   p_link         client
+ * @param[in]   p_data         frame
+ * @param[in]   p_length       length
+ *
+ * @return      NRF_SUCCESS on success, NRF_ERROR_INVALID_STATE if the client does not listen, otherwise an error code.
+ */
+static uint32_t sound_status_hvx(ble_cus_t * p_cus, ble_cus_link_t const * p_link, uint8_t * p_data, uint16_t p_length)
+{
+    ble_gatts_hvx_params_t hvx_params;
+    uint16_t               len = p_length;
+
+    if ((p_link->conn_handle == BLE_CONN_HANDLE_INVALID) || !p_link->sound_status_notify)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    memset(&hvx_params, 0, sizeof(hvx_params));
+
+    hvx_params.handle = p_cus->sound_status_handles.value_handle;
+    hvx_params.type   = BLE_GATT_HVX_NOTIFICATION;
+    hvx_params.offset = 0;
+    hvx_params.p_len  = &len;
+    hvx_params.p_data = p_data;
+
+    return sd_ble_gatts_hvx(p_link->conn_handle, &hvx_params);
+}
+
+/**@brief Function for notifying a player event on the sound status characteristic, to every client listening.
+ *
+ * @param[in]   p_cus          Custom Service structure.
+ * @param[in]   p_data         encoded event
+ * @param[in]   p_length       length
+ *
+ * @return      NRF_SUCCESS on success, NRF_ERROR_INVALID_STATE if no client listens, otherwise the error of a client.
+ */
+
+uint32_t sound_status_update(ble_cus_t * p_cus, uint8_t  * p_data, uint16_t  p_length)
+{
+    uint32_t               err_code;
+    uint32_t               link_err;
+    ble_gatts_value_t      gatts_value;
+    uint8_t                i;
+
+    if (p_cus == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
 
-    // Initialize value struct.
     memset(&gatts_value, 0, sizeof(gatts_value));
 
     gatts_value.len     = p_length;
     gatts_value.offset  = 0;
     gatts_value.p_value = p_data;
 
-    // Update database.
-    err_code = sd_ble_gatts_value_set(p_cus->conn_handle,
-                                      p_cus->temperature_value_handles.value_handle,
+    // Keep the last event readable.
+    err_code = sd_ble_gatts_value_set(BLE_CONN_HANDLE_INVALID,
+                                      p_cus->sound_status_handles.value_handle,
                                       &gatts_value);
     if (err_code != NRF_SUCCESS)
     {
         return err_code;
     }
 
+    // the same event to every client, a client with full TX slots misses it alone
+    err_code = NRF_ERROR_INVALID_STATE;
+    for (i = 0; i < BLE_CUS_LINK_COUNT; i++)
+    {
+        link_err = sound_status_hvx(p_cus, &p_cus->links[i], p_data, p_length);
+        if (link_err == NRF_ERROR_INVALID_STATE)
+        {
+            continue;
+        }
+        if ((err_code == NRF_ERROR_INVALID_STATE) || (link_err != NRF_SUCCESS))
+        {
+            err_code = link_err;
+        }
+    }
+    return err_code;
+}
 
+/**@brief Function for notifying a reply on the sound status characteristic, to one client.
+ *
+ * @param[in]   p_cus          Custom Service structure.
+ * @param[in]   conn_handle    client
+ * @param[in]   p_data         encoded reply
+ * @param[in]   p_length       length
+ *
+ * @return      NRF_SUCCESS on success, NRF_ERROR_INVALID_STATE if the client does not listen, otherwise an error code.
+ */
 
-	// Notify the host, if connected and notifications are enabled.
-	//    if ((p_cus->conn_handle != BLE_CONN_HANDLE_INVALID) 
-	//         && (evt.evt_type == BLE_TEMP_NOTIFICATION_ENABLED))
-	  if(evt.evt_type == BLE_TEMP_NOTIFICATION_ENABLED)
-	  {
-		  if ((p_cus->conn_handle != BLE_CONN_HANDLE_INVALID)) 
-		  {
-			  ble_gatts_hvx_params_t hvx_params;
-
-			  memset(&hvx_params, 0, sizeof(hvx_params));
-			  //	    rand();
-			  hvx_params.handle = p_cus->temperature_value_handles.value_handle;
-			  hvx_params.type   = BLE_GATT_HVX_NOTIFICATION;
-			  hvx_params.offset = gatts_value.offset;
-			  hvx_params.p_len  = &gatts_value.len;
-			  hvx_params.p_data = gatts_value.p_value;
-
-			  err_code = sd_ble_gatts_hvx(p_cus->conn_handle, &hvx_params);
-			  // Make sure the above function reports a BLE_GATTS_EVT_HVN_TX_COMPLETE
-		  }
-		  else
-		  {
-			  err_code = NRF_ERROR_INVALID_STATE;
-		  }
-		}
+uint32_t sound_status_reply(ble_cus_t * p_cus, uint16_t conn_handle, uint8_t  * p_data, uint16_t  p_length)
+{
+    ble_cus_link_t * p_link;
 
-    return err_code;
+    if (p_cus == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
 
+    p_link = (conn_handle != BLE_CONN_HANDLE_INVALID) ? link_find(p_cus, conn_handle) : NULL;
+    if (p_link == NULL)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    return sound_status_hvx(p_cus, p_link, p_data, p_length);
 }
@@ -0,0 +1,133 @@
+#include <string.h>
+#include "broadcast.h"
+#include "nordic_common.h"
+#include "app_util.h"
+#include "accel_codec.h"
+#include "nrf_log.h"
+
+STATIC_ASSERT(BROADCAST_HEADER_LEN + (BROADCAST_SAMPLES * 3 * BROADCAST_BITS + 7) / 8 <= BROADCAST_DATA_MAX);
+
+static uint8_t           m_data[2][BROADCAST_DATA_MAX];     // advertised and being packed, swapped on a full batch
+static uint8_t           m_packing;                         // index of the buffer being packed
+static uint16_t          m_count;                           // samples packed
+static uint16_t          m_length;                          // advertising data length with them
+static uint8_t           m_sequence;
+static uint8_t           m_adv_handle = BLE_GAP_ADV_SET_HANDLE_NOT_SET;
+static broadcast_stats_t m_stats;
+
+/*@brief Write the AD structure header of a batch, its length byte leaves out itself
+*/
+static void batch_header_set(uint8_t * p_data, uint16_t length, uint16_t count)
+{
+	p_data[0] = (uint8_t)(length - 1);
+	p_data[1] = BLE_GAP_AD_TYPE_MANUFACTURER_SPECIFIC_DATA;
+	(void)uint16_encode(BROADCAST_COMPANY_ID, &p_data[2]);
+	p_data[4] = BROADCAST_VERSION;
+	p_data[5] = m_sequence;
+	p_data[6] = (uint8_t)count;
+}
+
+/*@brief Hand the data to the advertising set, configured without new parameters while it advertises
+*/
+static ret_code_t batch_configure(uint8_t * p_data, uint16_t length, ble_gap_adv_params_t const * p_params)
+{
+	ble_gap_adv_data_t adv_data;
+
+	memset(&adv_data, 0, sizeof(adv_data));
+	adv_data.adv_data.p_data = p_data;
+	adv_data.adv_data.len    = length;
+	return sd_ble_gap_adv_set_configure(&m_adv_handle, &adv_data, p_params);
+}
+
+void broadcast_init(void)
+{
+	m_packing  = 1;
+	m_count    = 0;
+	m_length   = BROADCAST_HEADER_LEN;
+	m_sequence = 0;
+	memset(&m_stats, 0, sizeof(m_stats));
+}
+
+ret_code_t broadcast_start(uint8_t * p_adv_handle)
+{
+	ble_gap_adv_params_t params;
+	ret_code_t           err_code;
+
+	memset(&params, 0, sizeof(params));
+	params.properties.type = BLE_GAP_ADV_TYPE_EXTENDED_NONCONNECTABLE_NONSCANNABLE_UNDIRECTED;
+	params.filter_policy   = BLE_GAP_ADV_FP_ANY;
+	params.interval        = BROADCAST_INTERVAL;
+	params.duration        = BLE_GAP_ADV_TIMEOUT_GENERAL_UNLIMITED;
+	params.primary_phy     = BROADCAST_PRIMARY_PHY;
+	params.secondary_phy   = BROADCAST_SECONDARY_PHY;
+
+	// an empty batch until the first one is full
+	m_adv_handle = *p_adv_handle;
+	m_packing    = 1;
+	m_count      = 0;
+	m_length     = BROADCAST_HEADER_LEN;
+	batch_header_set(m_data[0], BROADCAST_HEADER_LEN, 0);
+
+	err_code = batch_configure(m_data[0], BROADCAST_HEADER_LEN, &params);
+	if (err_code == NRF_SUCCESS)
+	{
+		*p_adv_handle = m_adv_handle;
+		err_code = sd_ble_gap_adv_start(m_adv_handle, BLE_CONN_CFG_TAG_DEFAULT);
+	}
+
+	m_stats.on = (err_code == NRF_SUCCESS);
+	return err_code;
+}
+
+void broadcast_stop(void)
+{
+	if (!m_stats.on)
+	{
+		return;
+	}
+
+	(void)sd_ble_gap_adv_stop(m_adv_handle);
+	m_stats.on = false;
+}
+
+void broadcast_sample_put(int16_t const * p_accel)
+{
+	uint8_t *  p_data = m_data[m_packing];
+	ret_code_t err_code;
+
+	if (!m_stats.on)
+	{
+		return;
+	}
+
+	m_length = BROADCAST_HEADER_LEN + accel_codec_pack(p_accel, BROADCAST_BITS, &p_data[BROADCAST_HEADER_LEN], m_count);
+	m_count++;
+	if (m_count < BROADCAST_SAMPLES)
+	{
+		return;
+	}
+
+	m_sequence++;
+	batch_header_set(p_data, m_length, m_count);
+
+	// the other buffer is still on the air until the SoftDevice takes this one
+	err_code = batch_configure(p_data, m_length, NULL);
+	if (err_code == NRF_SUCCESS)
+	{
+		m_packing ^= 1;
+		m_stats.batches++;
+		m_stats.samples += m_count;
+	}
+	else
+	{
+		m_stats.refused++;
+		NRF_LOG_WARNING("Broadcast batch refused, error %u", err_code);
+	}
+	m_count  = 0;
+	m_length = BROADCAST_HEADER_LEN;
+}
+
+void broadcast_stats_get(broadcast_stats_t * p_stats)
+{
+	*p_stats = m_stats;
+}
@@ -0,0 +1,518 @@
+#include <stddef.h>
+#include <string.h>
+#include "clip_store.h"
+#include "nordic_common.h"
+#include "app_util.h"
+#include "sdk_macros.h"
+#include "nrf_fstorage.h"
+#include "nrf_fstorage_sd.h"
+#include "crc16.h"
+
+#define CLIP_STORE_MAGIC        0x32504C43                  // "CLP2"
+#define CLIP_STORE_MAGIC_V1     0x50494C43                  // "CLIP", header without the loop points
+#define CLIP_STORE_CHUNK        1024                        // bytes per flash write
+#define CLIP_STORE_CHUNKS       4                           // staging buffers, one filling while the others are written
+#define CLIP_STORE_ALIGN(x)     (((x) + 3) & ~3u)
+
+/**@brief Clip header in flash, the clip data follows. */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t sample_rate;
+    uint32_t size;                                          // clip bytes
+    uint16_t crc;                                           // CRC16-CCITT of the clip bytes
+    uint8_t  clip_id;
+    uint8_t  priority;                                      // 0xFF in "CLIP" headers
+    uint32_t committed;                                     // 0xFFFFFFFF until verified, then 0
+    uint32_t loop_start;                                    // samples, "CLP2" headers only
+    uint32_t loop_end;
+} clip_store_header_t;
+
+/**@brief Registered clip. */
+typedef struct
+{
+    uint32_t          data_addr;                            // 0 if no clip has this identifier
+    uint32_t          size;
+    clip_store_info_t info;
+} clip_store_entry_t;
+
+typedef enum
+{
+    CLIP_STORE_IDLE,
+    CLIP_STORE_UPLOADING,                                   // taking blocks
+    CLIP_STORE_FINISHING,                                   // last chunks going to flash
+    CLIP_STORE_COMMITTING,                                  // CRC checked, committed word going to flash
+    CLIP_STORE_ERASING,
+    CLIP_STORE_DRAINING,                                    // aborted, chunks still queued for flash
+} clip_store_state_t;
+
+static void fs_evt_handler(nrf_fstorage_evt_t * p_evt);
+
+NRF_FSTORAGE_DEF(nrf_fstorage_t m_fs) =
+{
+    .evt_handler = fs_evt_handler,
+    .start_addr  = CLIP_STORE_START,
+    .end_addr    = CLIP_STORE_END,
+};
+
+static clip_store_evt_handler_t m_evt_handler;
+static clip_store_entry_t m_entries[CLIP_STORE_ID_LAST + 1];
+static clip_store_state_t m_state = CLIP_STORE_IDLE;
+
+static uint32_t m_write_addr;                               // where the next clip header goes
+static uint32_t m_erased_end;                               // pages from here on are erased before they are written
+static uint32_t m_erase_addr;                               // next page of an erase of the store
+
+static clip_store_header_t m_header;                        // clip being uploaded
+static uint32_t m_header_addr;
+static uint32_t m_flash_addr;                               // where the next chunk goes
+static uint32_t m_expected;                                 // next clip byte offset
+static uint32_t m_written;                                  // bytes in flash, header included
+
+static uint32_t m_chunk[CLIP_STORE_CHUNKS][CLIP_STORE_CHUNK / 4];
+static uint8_t  m_fill;                                     // chunk being filled
+static uint32_t m_fill_len;
+static uint8_t  m_busy;                                     // chunks queued for flash
+
+static const uint32_t m_committed = 0;
+
+
+uint32_t clip_store_free_get(void)
+{
+    uint32_t used = m_write_addr + sizeof(clip_store_header_t);
+
+    return (used < CLIP_STORE_END) ? (CLIP_STORE_END - used) : 0;
+}
+
+static void evt_send(clip_store_evt_type_t type, uint32_t offset, ret_code_t error)
+{
+    clip_store_evt_t evt;
+
+    if (m_evt_handler == NULL)
+    {
+        return;
+    }
+
+    evt.evt_type = type;
+    evt.clip_id  = m_header.clip_id;
+    evt.offset   = offset;
+    evt.error    = error;
+    evt.free     = clip_store_free_get();
+
+    m_evt_handler(&evt);
+}
+
+/**@brief Give up the upload, its space is only reclaimed by an erase.
+ *
+ * @details Chunks already queued are still read by the SoftDevice, the store takes no new upload
+ *          or erase until their results are in.
+ */
+static void upload_abort(ret_code_t error)
+{
+    // nothing is in flash yet if the header chunk never completed, the next clip reuses the space
+    if ((m_written > 0) || (m_busy > 0))
+    {
+        m_write_addr = CLIP_STORE_ALIGN(m_header_addr + sizeof(clip_store_header_t) + m_header.size);
+    }
+
+    m_state = (m_busy > 0) ? CLIP_STORE_DRAINING : CLIP_STORE_IDLE;
+    evt_send(CLIP_STORE_EVT_ERROR, m_expected, error);
+}
+
+/**@brief Queue the chunk being filled for flash, erasing the pages it reaches first.
+ */
+static ret_code_t chunk_flush(void)
+{
+    uint32_t   len = CLIP_STORE_ALIGN(m_fill_len);
+    ret_code_t err_code;
+
+    memset((uint8_t *)m_chunk[m_fill] + m_fill_len, 0xFF, len - m_fill_len);
+
+    while (m_flash_addr + len > m_erased_end)
+    {
+        err_code = nrf_fstorage_erase(&m_fs, m_erased_end, 1, NULL);
+        VERIFY_SUCCESS(err_code);
+        m_erased_end += CLIP_STORE_PAGE_SIZE;
+    }
+
+    err_code = nrf_fstorage_write(&m_fs, m_flash_addr, m_chunk[m_fill], len, NULL);
+    VERIFY_SUCCESS(err_code);
+
+    m_flash_addr += len;
+    m_busy++;
+    m_fill     = (m_fill + 1) % CLIP_STORE_CHUNKS;
+    m_fill_len = 0;
+
+    return NRF_SUCCESS;
+}
+
+/**@brief Check the clip in flash against the CRC of the upload and commit it.
+ */
+static void upload_commit(void)
+{
+    uint32_t   data_addr = m_header_addr + sizeof(clip_store_header_t);
+    ret_code_t err_code;
+
+    if (crc16_compute((uint8_t const *)data_addr, m_header.size, NULL) != m_header.crc)
+    {
+        upload_abort(NRF_ERROR_INVALID_DATA);
+        return;
+    }
+
+    err_code = nrf_fstorage_write(&m_fs, m_header_addr + offsetof(clip_store_header_t, committed),
+                                  &m_committed, sizeof(m_committed), NULL);
+    if (err_code != NRF_SUCCESS)
+    {
+        upload_abort(err_code);
+        return;
+    }
+
+    m_state = CLIP_STORE_COMMITTING;
+}
+
+static void fs_evt_handler(nrf_fstorage_evt_t * p_evt)
+{
+    // results of an aborted upload only count down, they must not reach the next one
+    if (m_state == CLIP_STORE_DRAINING)
+    {
+        if ((p_evt->id == NRF_FSTORAGE_EVT_WRITE_RESULT) && (--m_busy == 0))
+        {
+            m_state = CLIP_STORE_IDLE;
+        }
+        return;
+    }
+
+    if (p_evt->result != NRF_SUCCESS)
+    {
+        if (m_state == CLIP_STORE_ERASING)
+        {
+            m_state = CLIP_STORE_IDLE;
+            evt_send(CLIP_STORE_EVT_ERROR, 0, p_evt->result);
+        }
+        else if (m_state != CLIP_STORE_IDLE)
+        {
+            // a failed chunk is out of the queue as well
+            if ((p_evt->id == NRF_FSTORAGE_EVT_WRITE_RESULT) &&
+                ((m_state == CLIP_STORE_UPLOADING) || (m_state == CLIP_STORE_FINISHING)))
+            {
+                m_busy--;
+            }
+            upload_abort(p_evt->result);
+        }
+        return;
+    }
+
+    switch (p_evt->id)
+    {
+        case NRF_FSTORAGE_EVT_WRITE_RESULT:
+            if (m_state == CLIP_STORE_COMMITTING)
+            {
+                clip_store_entry_t * p_entry = &m_entries[m_header.clip_id];
+
+                p_entry->data_addr        = m_header_addr + sizeof(clip_store_header_t);
+                p_entry->size             = m_header.size;
+                p_entry->info.sample_rate = m_header.sample_rate;
+                p_entry->info.priority    = m_header.priority;
+                p_entry->info.loop_start  = m_header.loop_start;
+                p_entry->info.loop_end    = m_header.loop_end;
+
+                m_write_addr = m_flash_addr;
+                m_state      = CLIP_STORE_IDLE;
+                evt_send(CLIP_STORE_EVT_DONE, m_header.size, NRF_SUCCESS);
+            }
+            else if ((m_state == CLIP_STORE_UPLOADING) || (m_state == CLIP_STORE_FINISHING))
+            {
+                m_busy--;
+                m_written += p_evt->len;
+                evt_send(CLIP_STORE_EVT_ACK, MIN(m_written - sizeof(clip_store_header_t), m_header.size), NRF_SUCCESS);
+
+                if ((m_state == CLIP_STORE_FINISHING) && (m_busy == 0))
+                {
+                    upload_commit();
+                }
+            }
+            break;
+
+        case NRF_FSTORAGE_EVT_ERASE_RESULT:
+            if (m_state == CLIP_STORE_ERASING)
+            {
+                // one page at a time keeps the SoftDevice flash queue free for the radio
+                m_erase_addr += CLIP_STORE_PAGE_SIZE;
+                if (m_erase_addr < m_erased_end)
+                {
+                    ret_code_t err_code = nrf_fstorage_erase(&m_fs, m_erase_addr, 1, NULL);
+                    if (err_code != NRF_SUCCESS)
+                    {
+                        m_state = CLIP_STORE_IDLE;
+                        evt_send(CLIP_STORE_EVT_ERROR, 0, err_code);
+                    }
+                }
+                else
+                {
+                    m_write_addr = CLIP_STORE_START;
+                    m_state      = CLIP_STORE_IDLE;
+                    evt_send(CLIP_STORE_EVT_ERASED, 0, NRF_SUCCESS);
+                }
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+ret_code_t clip_store_init(clip_store_evt_handler_t evt_handler)
+{
+    uint32_t   addr = CLIP_STORE_START;
+    ret_code_t err_code;
+
+    m_evt_handler = evt_handler;
+
+    err_code = nrf_fstorage_init(&m_fs, &nrf_fstorage_sd, NULL);
+    VERIFY_SUCCESS(err_code);
+
+    memset(m_entries, 0, sizeof(m_entries));
+
+    // clips follow each other, the first blank header ends the store, later clips replace earlier ones
+    while (addr + sizeof(clip_store_header_t) <= CLIP_STORE_END)
+    {
+        clip_store_header_t const * p_header = (clip_store_header_t const *)addr;
+        uint32_t                    header_len;
+
+        // "CLIP" headers end at the committed word, a clip uploaded before loop points keeps playing once
+        if (p_header->magic == CLIP_STORE_MAGIC)
+        {
+            header_len = sizeof(clip_store_header_t);
+        }
+        else if (p_header->magic == CLIP_STORE_MAGIC_V1)
+        {
+            header_len = offsetof(clip_store_header_t, loop_start);
+        }
+        else
+        {
+            break;
+        }
+
+        if (p_header->size > CLIP_STORE_END - addr - header_len)
+        {
+            break;
+        }
+
+        if ((p_header->committed == 0) &&
+            (p_header->clip_id >= CLIP_STORE_ID_FIRST) && (p_header->clip_id <= CLIP_STORE_ID_LAST))
+        {
+            clip_store_entry_t * p_entry = &m_entries[p_header->clip_id];
+
+            p_entry->data_addr        = addr + header_len;
+            p_entry->size             = p_header->size;
+            p_entry->info.sample_rate = p_header->sample_rate;
+            p_entry->info.priority    = p_header->priority;
+            p_entry->info.loop_start  = (header_len == sizeof(clip_store_header_t)) ? p_header->loop_start : 0;
+            p_entry->info.loop_end    = (header_len == sizeof(clip_store_header_t)) ? p_header->loop_end : 0;
+        }
+
+        addr = CLIP_STORE_ALIGN(addr + header_len + p_header->size);
+    }
+
+    m_write_addr = addr;
+    m_erased_end = (addr + CLIP_STORE_PAGE_SIZE - 1) & ~(CLIP_STORE_PAGE_SIZE - 1);
+
+    return NRF_SUCCESS;
+}
+
+ret_code_t clip_store_begin(uint8_t clip_id, clip_store_info_t const * p_info, uint32_t size, uint16_t crc)
+{
+    if (m_state != CLIP_STORE_IDLE)
+    {
+        return NRF_ERROR_BUSY;
+    }
+
+    if ((clip_id < CLIP_STORE_ID_FIRST) || (clip_id > CLIP_STORE_ID_LAST) ||
+        (size == 0) || ((size & 1) != 0) || (p_info->sample_rate == 0))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    if ((p_info->loop_end != 0) &&
+        ((p_info->loop_start >= p_info->loop_end) || (p_info->loop_end > size / sizeof(int16_t))))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    if (size > clip_store_free_get())
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    m_header.magic       = CLIP_STORE_MAGIC;
+    m_header.sample_rate = p_info->sample_rate;
+    m_header.size        = size;
+    m_header.crc         = crc;
+    m_header.clip_id     = clip_id;
+    m_header.priority    = p_info->priority;
+    m_header.committed   = 0xFFFFFFFF;
+    m_header.loop_start  = p_info->loop_start;
+    m_header.loop_end    = p_info->loop_end;
+
+    m_header_addr = m_write_addr;
+    m_flash_addr  = m_write_addr;
+    m_expected    = 0;
+    m_written     = 0;
+    m_busy        = 0;
+    m_fill        = 0;
+
+    // the header goes to flash with the first chunk
+    memcpy(m_chunk[0], &m_header, sizeof(m_header));
+    m_fill_len = sizeof(m_header);
+
+    m_state = CLIP_STORE_UPLOADING;
+
+    return NRF_SUCCESS;
+}
+
+ret_code_t clip_store_block_put(uint8_t const * p_block, uint16_t length)
+{
+    uint8_t const * p_payload = &p_block[CLIP_STORE_BLOCK_HEADER_LEN];
+    uint32_t        offset;
+    uint32_t        size;
+    ret_code_t      err_code = NRF_SUCCESS;
+
+    if (m_state != CLIP_STORE_UPLOADING)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    if (length <= CLIP_STORE_BLOCK_HEADER_LEN)
+    {
+        err_code = NRF_ERROR_INVALID_LENGTH;
+    }
+    else
+    {
+        offset = uint32_decode(&p_block[0]);
+        size   = length - CLIP_STORE_BLOCK_HEADER_LEN;
+
+        if (offset != m_expected)
+        {
+            err_code = NRF_ERROR_INVALID_ADDR;
+        }
+        else if (crc16_compute(p_payload, size, NULL) != uint16_decode(&p_block[4]))
+        {
+            err_code = NRF_ERROR_INVALID_DATA;
+        }
+        else if (size > m_header.size - m_expected)
+        {
+            err_code = NRF_ERROR_INVALID_LENGTH;
+        }
+        else if (size > (CLIP_STORE_CHUNKS - m_busy) * CLIP_STORE_CHUNK - m_fill_len)
+        {
+            // flash is behind the radio, the client resends from the expected offset
+            err_code = NRF_ERROR_NO_MEM;
+        }
+    }
+
+    if (err_code != NRF_SUCCESS)
+    {
+        evt_send(CLIP_STORE_EVT_NACK, m_expected, err_code);
+        return err_code;
+    }
+
+    m_expected += size;
+
+    while (size > 0)
+    {
+        uint32_t part = MIN(size, CLIP_STORE_CHUNK - m_fill_len);
+
+        memcpy((uint8_t *)m_chunk[m_fill] + m_fill_len, p_payload, part);
+        m_fill_len += part;
+        p_payload  += part;
+        size       -= part;
+
+        if (m_fill_len == CLIP_STORE_CHUNK)
+        {
+            err_code = chunk_flush();
+            if (err_code != NRF_SUCCESS)
+            {
+                upload_abort(err_code);
+                return err_code;
+            }
+        }
+    }
+
+    return NRF_SUCCESS;
+}
+
+ret_code_t clip_store_end(void)
+{
+    ret_code_t err_code;
+
+    if (m_state != CLIP_STORE_UPLOADING)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    if (m_expected != m_header.size)
+    {
+        upload_abort(NRF_ERROR_INVALID_LENGTH);
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    if (m_fill_len > 0)
+    {
+        err_code = chunk_flush();
+        if (err_code != NRF_SUCCESS)
+        {
+            upload_abort(err_code);
+            return err_code;
+        }
+    }
+
+    m_state = CLIP_STORE_FINISHING;
+    if (m_busy == 0)
+    {
+        upload_commit();
+    }
+
+    return NRF_SUCCESS;
+}
+
+ret_code_t clip_store_erase(void)
+{
+    ret_code_t err_code;
+
+    if (m_state != CLIP_STORE_IDLE)
+    {
+        return NRF_ERROR_BUSY;
+    }
+
+    memset(m_entries, 0, sizeof(m_entries));
+
+    // pages above m_erased_end were never written since they were last erased
+    if (m_erased_end == CLIP_STORE_START)
+    {
+        m_write_addr = CLIP_STORE_START;
+        evt_send(CLIP_STORE_EVT_ERASED, 0, NRF_SUCCESS);
+        return NRF_SUCCESS;
+    }
+
+    m_erase_addr = CLIP_STORE_START;
+    err_code     = nrf_fstorage_erase(&m_fs, m_erase_addr, 1, NULL);
+    VERIFY_SUCCESS(err_code);
+
+    m_state = CLIP_STORE_ERASING;
+
+    return NRF_SUCCESS;
+}
+
+bool clip_store_find(uint8_t clip_id, int16_t const ** pp_data, uint32_t * p_length, clip_store_info_t * p_info)
+{
+    if ((clip_id < CLIP_STORE_ID_FIRST) || (clip_id > CLIP_STORE_ID_LAST) || (m_entries[clip_id].data_addr == 0))
+    {
+        return false;
+    }
+
+    *pp_data       = (int16_t const *)m_entries[clip_id].data_addr;
+    *p_length      = m_entries[clip_id].size / sizeof(int16_t);
+    *p_info        = m_entries[clip_id].info;
+
+    return true;
+}
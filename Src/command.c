@@ -0,0 +1,106 @@
+#include <string.h>
+#include "command.h"
+#include "nordic_common.h"
+
+static command_t const *   m_table;
+static uint8_t             m_count;
+static command_ack_send_t  m_ack_send;
+
+/*@brief Look the opcode up and run it
+*/
+static command_result_t command_run(uint16_t conn_handle, uint8_t opcode, uint8_t const * p_value, uint8_t length)
+{
+	uint8_t i;
+
+	for (i = 0; i < m_count; i++)
+	{
+		if (m_table[i].opcode == opcode)
+		{
+			if (length < m_table[i].min_length)
+			{
+				return COMMAND_RESULT_LENGTH;
+			}
+			return m_table[i].handler(conn_handle, p_value, length);
+		}
+	}
+	return COMMAND_RESULT_UNKNOWN;
+}
+
+/*@brief Count a result into the acknowledgement
+*/
+static void ack_add(command_ack_t * p_ack, command_result_t result)
+{
+	if (p_ack->count < COMMAND_ACK_RESULTS)
+	{
+		p_ack->results[p_ack->count] = (uint8_t)result;
+	}
+	if (result != COMMAND_RESULT_OK)
+	{
+		p_ack->failed++;
+	}
+	p_ack->count++;
+}
+
+void command_init(command_t const * p_table, uint8_t count, command_ack_send_t ack_send)
+{
+	m_table    = p_table;
+	m_count    = count;
+	m_ack_send = ack_send;
+}
+
+void command_write(uint16_t conn_handle, uint8_t const * p_data, uint16_t length)
+{
+	command_ack_t ack;
+	uint16_t      offset = COMMAND_FRAME_HEADER_LEN;
+
+	if (length == 0)
+	{
+		return;
+	}
+
+	// one command the old way, no version byte and no acknowledgement
+	if ((p_data[0] & COMMAND_FRAME_VERSION_MASK) != (COMMAND_FRAME_V1 & COMMAND_FRAME_VERSION_MASK))
+	{
+		(void)command_run(conn_handle, p_data[0], &p_data[1], (uint8_t)MIN(length - 1, UINT8_MAX));
+		return;
+	}
+
+	memset(&ack, 0, sizeof(ack));
+	ack.version  = p_data[0];
+	ack.sequence = (length > 1) ? p_data[1] : 0;
+
+	if ((p_data[0] != COMMAND_FRAME_V1) || (length < COMMAND_FRAME_HEADER_LEN))
+	{
+		ack_add(&ack, (p_data[0] != COMMAND_FRAME_V1) ? COMMAND_RESULT_VERSION : COMMAND_RESULT_TRUNCATED);
+	}
+	else
+	{
+		while (offset < length)
+		{
+			uint8_t opcode;
+			uint8_t value_length;
+
+			if (length - offset < COMMAND_HEADER_LEN)
+			{
+				ack_add(&ack, COMMAND_RESULT_TRUNCATED);
+				break;
+			}
+			opcode       = p_data[offset];
+			value_length = p_data[offset + 1];
+			offset      += COMMAND_HEADER_LEN;
+
+			if (value_length > length - offset)
+			{
+				ack_add(&ack, COMMAND_RESULT_TRUNCATED);
+				break;
+			}
+			ack_add(&ack, command_run(conn_handle, opcode, &p_data[offset], value_length));
+			offset += value_length;
+		}
+	}
+
+	if (m_ack_send != NULL)
+	{
+		m_ack_send(conn_handle, &ack);
+	}
+}
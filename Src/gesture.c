@@ -0,0 +1,295 @@
+#include <stdlib.h>
+#include <string.h>
+#include "gesture.h"
+
+#define GESTURE_ORIENT_MIN      ((GESTURE_COUNTS_PER_G * 7) / 10)   // gravity share an axis needs to be the orientation
+#define GESTURE_GRAVITY_SHIFT   3                                   // low-pass for the orientation, ~20 ms
+#define GESTURE_STRENGTH_MIN    4096                                // tap gain at the threshold, q15
+#define GESTURE_NONE            0xFF
+
+/*@brief Detector and rule state
+*/
+typedef struct
+{
+	gesture_handler_t  handler;
+	gesture_rule_t     rules[GESTURE_RULES_MAX];
+	bool               above[GESTURE_RULES_MAX];            // THRESHOLD rules: past the level, waiting to re-arm
+	uint32_t           tap_threshold;
+	uint32_t           shock_samples;
+	uint32_t           double_samples;
+	uint32_t           orient_samples;
+	int16_t            last[3];                             // previous sample
+	int32_t            gravity[3];                          // low-passed sample
+	uint32_t           shock;                               // samples left in the tap dead time
+	uint32_t           since_tap;                           // samples since the last tap, 0 when no tap is pending
+	uint8_t            orientation;
+	uint8_t            candidate;                           // orientation waiting to hold
+	uint32_t           candidate_samples;
+	bool               primed;                              // one sample seen, the tap detector has a difference
+} gesture_t;
+
+static gesture_t m_gesture;
+
+static const gesture_rule_t m_default_rules[] =
+{
+	{ GESTURE_EVT_TAP,         0,                     0, GESTURE_ACTION_HIT,  0x02, 0      },
+	{ GESTURE_EVT_DOUBLE_TAP,  0,                     0, GESTURE_ACTION_HIT,  0x01, 0x7FFF },
+	{ GESTURE_EVT_ORIENTATION, GESTURE_ORIENT_Z_DOWN, 0, GESTURE_ACTION_STOP, 0x00, 0      },
+};
+
+/*@brief Milliseconds to samples, at least one
+*/
+static uint32_t ms_to_samples(uint32_t ms)
+{
+	uint32_t samples = (ms * GESTURE_SAMPLE_RATE) / 1000;
+
+	return (samples == 0) ? 1 : samples;
+}
+
+void gesture_config_set(gesture_config_t const * p_config)
+{
+	m_gesture.tap_threshold  = (p_config->tap_threshold == 0) ? 1 : p_config->tap_threshold;
+	m_gesture.shock_samples  = ms_to_samples(p_config->tap_shock_ms);
+	m_gesture.double_samples = ms_to_samples(p_config->double_tap_ms);
+	m_gesture.orient_samples = ms_to_samples(p_config->orientation_ms);
+}
+
+void gesture_init(gesture_handler_t handler)
+{
+	gesture_config_t config =
+	{
+		.tap_threshold  = GESTURE_COUNTS_PER_G / 2,
+		.tap_shock_ms   = 50,
+		.double_tap_ms  = 300,
+		.orientation_ms = 200,
+	};
+	uint8_t i;
+
+	memset(&m_gesture, 0, sizeof(m_gesture));
+	m_gesture.handler     = handler;
+	m_gesture.orientation = GESTURE_NONE;
+	m_gesture.candidate   = GESTURE_NONE;
+
+	gesture_config_set(&config);
+
+	for (i = 0; i < sizeof(m_default_rules) / sizeof(m_default_rules[0]); i++)
+	{
+		(void)gesture_rule_set(i, &m_default_rules[i]);
+	}
+}
+
+bool gesture_rule_set(uint8_t index, gesture_rule_t const * p_rule)
+{
+	if ((index >= GESTURE_RULES_MAX) ||
+	    (p_rule->event > GESTURE_EVT_ORIENTATION) ||
+	    (p_rule->action > GESTURE_ACTION_STOP) ||
+	    ((p_rule->event == GESTURE_EVT_THRESHOLD) && ((p_rule->match > 2) || (p_rule->level == 0))))
+	{
+		return false;
+	}
+
+	m_gesture.rules[index] = *p_rule;
+	m_gesture.above[index] = false;
+
+	return true;
+}
+
+bool gesture_rules_active(void)
+{
+	uint8_t i;
+
+	for (i = 0; i < GESTURE_RULES_MAX; i++)
+	{
+		if (m_gesture.rules[i].event != GESTURE_EVT_NONE)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/*@brief Run the rules of one event
+ *
+ * @param[in] match      Orientation for ORIENTATION, unused otherwise.
+ * @param[in] strength   Tap strength, q15.
+*/
+static void rules_run(gesture_evt_type_t event, uint8_t match, uint16_t strength)
+{
+	uint8_t i;
+
+	for (i = 0; i < GESTURE_RULES_MAX; i++)
+	{
+		gesture_rule_t const * p_rule = &m_gesture.rules[i];
+
+		if ((p_rule->event != event) ||
+		    ((event == GESTURE_EVT_ORIENTATION) && (p_rule->match != GESTURE_ORIENT_ANY) && (p_rule->match != match)))
+		{
+			continue;
+		}
+
+		if (m_gesture.handler != NULL)
+		{
+			m_gesture.handler(i, p_rule, (p_rule->gain == 0) ? strength : p_rule->gain);
+		}
+	}
+}
+
+/*@brief Threshold rules, each re-arms once its axis is back an eighth of the level towards zero
+*/
+static void thresholds_run(int16_t const * p_accel)
+{
+	uint8_t i;
+
+	for (i = 0; i < GESTURE_RULES_MAX; i++)
+	{
+		gesture_rule_t const * p_rule = &m_gesture.rules[i];
+		int32_t                value;
+		int32_t                level;
+
+		if (p_rule->event != GESTURE_EVT_THRESHOLD)
+		{
+			continue;
+		}
+
+		// fold negative levels over so the crossing is always upwards
+		value = (p_rule->level > 0) ? p_accel[p_rule->match] : -p_accel[p_rule->match];
+		level = abs(p_rule->level);
+
+		if (!m_gesture.above[i] && (value >= level))
+		{
+			m_gesture.above[i] = true;
+			if (m_gesture.handler != NULL)
+			{
+				m_gesture.handler(i, p_rule, (p_rule->gain == 0) ? 0x7FFF : p_rule->gain);
+			}
+		}
+		else if (m_gesture.above[i] && (value < level - level / 8))
+		{
+			m_gesture.above[i] = false;
+		}
+	}
+}
+
+/*@brief Tap detector: largest change of one axis between two samples
+*/
+static void tap_run(int16_t const * p_accel)
+{
+	uint32_t jerk = 0;
+	uint32_t i;
+
+	for (i = 0; i < 3; i++)
+	{
+		uint32_t delta = (uint32_t)abs(p_accel[i] - m_gesture.last[i]);
+
+		jerk = (delta > jerk) ? delta : jerk;
+	}
+
+	if (m_gesture.since_tap > 0)
+	{
+		if (++m_gesture.since_tap > m_gesture.double_samples)
+		{
+			m_gesture.since_tap = 0;
+		}
+	}
+
+	if (m_gesture.shock > 0)
+	{
+		m_gesture.shock--;
+		return;
+	}
+
+	if (m_gesture.primed && (jerk > m_gesture.tap_threshold))
+	{
+		// threshold gives GESTURE_STRENGTH_MIN, four times the threshold full scale
+		uint32_t strength = GESTURE_STRENGTH_MIN +
+		                    ((jerk - m_gesture.tap_threshold) * (0x7FFF - GESTURE_STRENGTH_MIN)) / (3 * m_gesture.tap_threshold);
+
+		strength = (strength > 0x7FFF) ? 0x7FFF : strength;
+		m_gesture.shock = m_gesture.shock_samples;
+
+		rules_run(GESTURE_EVT_TAP, 0, (uint16_t)strength);
+
+		if (m_gesture.since_tap > 0)
+		{
+			m_gesture.since_tap = 0;
+			rules_run(GESTURE_EVT_DOUBLE_TAP, 0, (uint16_t)strength);
+		}
+		else
+		{
+			m_gesture.since_tap = 1;
+		}
+	}
+}
+
+/*@brief Orientation detector: axis with the most of the low-passed gravity, held for a while
+*/
+static void orientation_run(int16_t const * p_accel)
+{
+	uint8_t  orientation = GESTURE_NONE;
+	int32_t  largest     = GESTURE_ORIENT_MIN;
+	uint32_t i;
+
+	for (i = 0; i < 3; i++)
+	{
+		if (m_gesture.primed)
+		{
+			m_gesture.gravity[i] += (p_accel[i] - m_gesture.gravity[i]) >> GESTURE_GRAVITY_SHIFT;
+		}
+		else
+		{
+			m_gesture.gravity[i] = p_accel[i];
+		}
+
+		if (abs(m_gesture.gravity[i]) > largest)
+		{
+			largest     = abs(m_gesture.gravity[i]);
+			orientation = (uint8_t)(i * 2 + ((m_gesture.gravity[i] < 0) ? 1 : 0));
+		}
+	}
+
+	// in between two axes or moving: keep the last orientation
+	if ((orientation == GESTURE_NONE) || (orientation == m_gesture.orientation))
+	{
+		m_gesture.candidate = GESTURE_NONE;
+		return;
+	}
+
+	if (orientation != m_gesture.candidate)
+	{
+		m_gesture.candidate         = orientation;
+		m_gesture.candidate_samples = 0;
+	}
+
+	if (++m_gesture.candidate_samples >= m_gesture.orient_samples)
+	{
+		bool first = (m_gesture.orientation == GESTURE_NONE);
+
+		m_gesture.orientation = orientation;
+		m_gesture.candidate   = GESTURE_NONE;
+
+		// the orientation at power-up is not a gesture
+		if (!first)
+		{
+			rules_run(GESTURE_EVT_ORIENTATION, orientation, 0x7FFF);
+		}
+	}
+}
+
+void gesture_resume(void)
+{
+	m_gesture.primed            = false;
+	m_gesture.shock             = 0;
+	m_gesture.since_tap         = 0;
+	m_gesture.candidate         = GESTURE_NONE;
+	m_gesture.candidate_samples = 0;
+}
+
+void gesture_process(int16_t const * p_accel)
+{
+	tap_run(p_accel);
+	thresholds_run(p_accel);
+	orientation_run(p_accel);
+
+	memcpy(m_gesture.last, p_accel, sizeof(m_gesture.last));
+	m_gesture.primed = true;
+}
@@ -0,0 +1,310 @@
+#include <string.h>
+#include "l2cap_channel.h"
+#include "nordic_common.h"
+#include "app_util_platform.h"
+#include "nrf_log.h"
+
+#define L2CAP_CHANNEL_TX_MASK     (L2CAP_CHANNEL_TX_SDUS - 1)
+
+#if (L2CAP_CHANNEL_TX_SDUS & L2CAP_CHANNEL_TX_MASK) != 0
+#error "L2CAP_CHANNEL_TX_SDUS must be a power of two"
+#endif
+
+typedef struct
+{
+	uint16_t           conn_handle;                     // BLE_CONN_HANDLE_INVALID for a free entry
+	uint16_t           cid;                             // local channel id, set up from the request
+	bool               open;
+	uint16_t           tx_mtu;                          // largest SDU the central takes
+	volatile uint32_t  tx_head;                         // SDUs given to the SoftDevice
+	volatile uint32_t  tx_tail;                         // SDUs sent
+	uint8_t            tx_buf[L2CAP_CHANNEL_TX_SDUS][L2CAP_CHANNEL_SDU_MAX];
+	uint8_t            rx_buf[L2CAP_CHANNEL_SDU_MAX];
+} l2cap_channel_t;
+
+static l2cap_channel_t             m_channels[L2CAP_CHANNEL_LINKS];
+static l2cap_channel_evt_handler_t m_evt_handler;
+static l2cap_channel_stats_t       m_stats;
+
+NRF_SDH_BLE_OBSERVER(m_l2cap_channel_obs, L2CAP_CHANNEL_BLE_OBSERVER_PRIO, l2cap_channel_on_ble_evt, NULL);
+
+static l2cap_channel_t * channel_find(uint16_t conn_handle)
+{
+	uint32_t i;
+
+	for (i = 0; i < L2CAP_CHANNEL_LINKS; i++)
+	{
+		if (m_channels[i].conn_handle == conn_handle)
+		{
+			return &m_channels[i];
+		}
+	}
+	return NULL;
+}
+
+static void channel_evt_send(l2cap_channel_evt_type_t evt_type, uint16_t conn_handle, uint8_t const * p_data, uint16_t length)
+{
+	l2cap_channel_evt_t evt;
+
+	if (m_evt_handler == NULL)
+	{
+		return;
+	}
+
+	evt.evt_type    = evt_type;
+	evt.conn_handle = conn_handle;
+	evt.p_data      = p_data;
+	evt.length      = length;
+	m_evt_handler(&evt);
+}
+
+/*@brief Free the entry of a connection, telling the application if its channel was open
+*/
+static void channel_close(uint16_t conn_handle)
+{
+	l2cap_channel_t * p_channel = channel_find(conn_handle);
+	bool              open;
+
+	if ((conn_handle == BLE_CONN_HANDLE_INVALID) || (p_channel == NULL))
+	{
+		return;
+	}
+
+	CRITICAL_REGION_ENTER();
+	open                   = p_channel->open;
+	p_channel->open        = false;
+	p_channel->conn_handle = BLE_CONN_HANDLE_INVALID;
+	CRITICAL_REGION_EXIT();
+
+	if (open)
+	{
+		m_stats.open--;
+		channel_evt_send(L2CAP_CHANNEL_EVT_CLOSED, conn_handle, NULL, 0);
+	}
+}
+
+/*@brief Accept a channel on our PSM, one per connection, with the receive buffer of its entry
+*/
+static void on_setup_request(ble_l2cap_evt_t const * p_evt)
+{
+	ble_l2cap_ch_setup_params_t params;
+	l2cap_channel_t *           p_channel = NULL;
+	uint16_t                    cid       = p_evt->local_cid;
+	ret_code_t                  err_code;
+
+	memset(&params, 0, sizeof(params));
+	params.le_psm = p_evt->params.ch_setup_request.le_psm;
+
+	if (params.le_psm != L2CAP_CHANNEL_PSM)
+	{
+		params.status = BLE_L2CAP_CH_STATUS_CODE_LE_PSM_NOT_SUPPORTED;
+	}
+	else if ((channel_find(p_evt->conn_handle) != NULL) || ((p_channel = channel_find(BLE_CONN_HANDLE_INVALID)) == NULL))
+	{
+		p_channel     = NULL;
+		params.status = BLE_L2CAP_CH_STATUS_CODE_NO_RESOURCES;
+	}
+	else
+	{
+		params.status                   = BLE_L2CAP_CH_STATUS_CODE_SUCCESS;
+		params.rx_params.rx_mtu         = L2CAP_CHANNEL_SDU_MAX;
+		params.rx_params.rx_mps         = L2CAP_CHANNEL_MPS;
+		params.rx_params.sdu_buf.p_data = p_channel->rx_buf;
+		params.rx_params.sdu_buf.len    = sizeof(p_channel->rx_buf);
+	}
+
+	err_code = sd_ble_l2cap_ch_setup(p_evt->conn_handle, &cid, &params);
+	if ((err_code != NRF_SUCCESS) || (p_channel == NULL))
+	{
+		NRF_LOG_INFO("L2CAP channel on PSM 0x%04x refused, status 0x%04x error %u", params.le_psm, params.status, err_code);
+		return;
+	}
+
+	p_channel->cid         = cid;
+	p_channel->open        = false;
+	p_channel->tx_mtu      = MIN(p_evt->params.ch_setup_request.tx_params.tx_mtu, L2CAP_CHANNEL_SDU_MAX);
+	p_channel->tx_head     = 0;
+	p_channel->tx_tail     = 0;
+	p_channel->conn_handle = p_evt->conn_handle;
+}
+
+static void on_setup(ble_l2cap_evt_t const * p_evt)
+{
+	l2cap_channel_t * p_channel = channel_find(p_evt->conn_handle);
+	ret_code_t        err_code;
+
+	if ((p_channel == NULL) || (p_channel->cid != p_evt->local_cid))
+	{
+		return;
+	}
+
+	// credits for a whole SDU, the central does not stall on every K-frame
+	err_code = sd_ble_l2cap_ch_flow_control(p_evt->conn_handle, p_evt->local_cid, L2CAP_CHANNEL_CREDITS, NULL);
+	if (err_code != NRF_SUCCESS)
+	{
+		NRF_LOG_WARNING("L2CAP credits not raised, error %u", err_code);
+	}
+
+	p_channel->tx_mtu = MIN(p_evt->params.ch_setup.tx_params.tx_mtu, L2CAP_CHANNEL_SDU_MAX);
+	p_channel->open   = true;
+	m_stats.open++;
+
+	NRF_LOG_INFO("L2CAP channel 0x%04x open, tx mtu %u mps %u", p_evt->local_cid, p_channel->tx_mtu, p_evt->params.ch_setup.tx_params.tx_mps);
+	channel_evt_send(L2CAP_CHANNEL_EVT_OPENED, p_evt->conn_handle, NULL, 0);
+}
+
+/*@brief Hand the SDU to the application, then the buffer back to the SoftDevice for the next one
+*/
+static void on_rx(ble_l2cap_evt_t const * p_evt)
+{
+	l2cap_channel_t * p_channel = channel_find(p_evt->conn_handle);
+	ble_data_t        sdu_buf;
+	ret_code_t        err_code;
+
+	if ((p_channel == NULL) || !p_channel->open)
+	{
+		return;
+	}
+
+	m_stats.bytes_received += p_evt->params.rx.sdu_len;
+	channel_evt_send(L2CAP_CHANNEL_EVT_RX, p_evt->conn_handle, p_evt->params.rx.sdu_buf.p_data, p_evt->params.rx.sdu_len);
+
+	sdu_buf.p_data = p_channel->rx_buf;
+	sdu_buf.len    = sizeof(p_channel->rx_buf);
+	err_code = sd_ble_l2cap_ch_rx(p_evt->conn_handle, p_channel->cid, &sdu_buf);
+	if (err_code != NRF_SUCCESS)
+	{
+		NRF_LOG_WARNING("L2CAP receive buffer not given back, error %u", err_code);
+	}
+}
+
+static void on_tx(ble_l2cap_evt_t const * p_evt)
+{
+	l2cap_channel_t * p_channel = channel_find(p_evt->conn_handle);
+
+	if ((p_channel == NULL) || (p_channel->tx_tail == p_channel->tx_head))
+	{
+		return;
+	}
+
+	// the SoftDevice sends the SDUs of a channel in order
+	p_channel->tx_tail++;
+	m_stats.sdus_sent++;
+	m_stats.bytes_sent += p_evt->params.tx.sdu_buf.len;
+	channel_evt_send(L2CAP_CHANNEL_EVT_TX_DONE, p_evt->conn_handle, NULL, (uint16_t)p_evt->params.tx.sdu_buf.len);
+}
+
+void l2cap_channel_init(l2cap_channel_evt_handler_t evt_handler)
+{
+	uint32_t i;
+
+	for (i = 0; i < L2CAP_CHANNEL_LINKS; i++)
+	{
+		m_channels[i].conn_handle = BLE_CONN_HANDLE_INVALID;
+		m_channels[i].open        = false;
+	}
+	memset(&m_stats, 0, sizeof(m_stats));
+	m_evt_handler = evt_handler;
+}
+
+uint16_t l2cap_channel_sdu_max_get(uint16_t conn_handle)
+{
+	l2cap_channel_t * p_channel = channel_find(conn_handle);
+
+	if ((conn_handle == BLE_CONN_HANDLE_INVALID) || (p_channel == NULL) || !p_channel->open)
+	{
+		return 0;
+	}
+	return p_channel->tx_mtu;
+}
+
+ret_code_t l2cap_channel_send(uint16_t conn_handle, uint8_t const * p_data, uint16_t length)
+{
+	l2cap_channel_t * p_channel;
+	ble_data_t        sdu_buf;
+	ret_code_t        err_code;
+
+	if (conn_handle == BLE_CONN_HANDLE_INVALID)
+	{
+		return NRF_ERROR_INVALID_STATE;
+	}
+
+	CRITICAL_REGION_ENTER();
+
+	p_channel = channel_find(conn_handle);
+	if ((p_channel == NULL) || !p_channel->open)
+	{
+		err_code = NRF_ERROR_INVALID_STATE;
+	}
+	else if ((length == 0) || (length > p_channel->tx_mtu))
+	{
+		err_code = NRF_ERROR_INVALID_LENGTH;
+	}
+	else if ((p_channel->tx_head - p_channel->tx_tail) >= L2CAP_CHANNEL_TX_SDUS)
+	{
+		m_stats.tx_busy++;
+		err_code = NRF_ERROR_RESOURCES;
+	}
+	else
+	{
+		uint32_t slot = p_channel->tx_head & L2CAP_CHANNEL_TX_MASK;
+
+		// the SoftDevice reads the SDU from our buffer until BLE_L2CAP_EVT_CH_TX
+		memcpy(p_channel->tx_buf[slot], p_data, length);
+		sdu_buf.p_data = p_channel->tx_buf[slot];
+		sdu_buf.len    = length;
+
+		err_code = sd_ble_l2cap_ch_tx(conn_handle, p_channel->cid, &sdu_buf);
+		if (err_code == NRF_SUCCESS)
+		{
+			p_channel->tx_head++;
+		}
+		else if (err_code == NRF_ERROR_RESOURCES)
+		{
+			m_stats.tx_busy++;
+		}
+	}
+
+	CRITICAL_REGION_EXIT();
+	return err_code;
+}
+
+void l2cap_channel_stats_get(l2cap_channel_stats_t * p_stats)
+{
+	*p_stats = m_stats;
+}
+
+void l2cap_channel_on_ble_evt(ble_evt_t const * p_ble_evt, void * p_context)
+{
+	UNUSED_PARAMETER(p_context);
+
+	switch (p_ble_evt->header.evt_id)
+	{
+	case BLE_L2CAP_EVT_CH_SETUP_REQUEST:
+		on_setup_request(&p_ble_evt->evt.l2cap_evt);
+		break;
+
+	case BLE_L2CAP_EVT_CH_SETUP:
+		on_setup(&p_ble_evt->evt.l2cap_evt);
+		break;
+
+	case BLE_L2CAP_EVT_CH_RX:
+		on_rx(&p_ble_evt->evt.l2cap_evt);
+		break;
+
+	case BLE_L2CAP_EVT_CH_TX:
+		on_tx(&p_ble_evt->evt.l2cap_evt);
+		break;
+
+	case BLE_L2CAP_EVT_CH_RELEASED:
+		channel_close(p_ble_evt->evt.l2cap_evt.conn_handle);
+		break;
+
+	case BLE_GAP_EVT_DISCONNECTED:
+		channel_close(p_ble_evt->evt.gap_evt.conn_handle);
+		break;
+
+	default:
+		break;
+	}
+}
@@ -19,7 +19,7 @@
 
 
 NRF_BLE_GATT_DEF(m_gatt);                                                       /**< GATT module instance. */
-NRF_BLE_QWR_DEF(m_qwr);                                                         /**< Context for the Queued Write module.*/
+NRF_BLE_QWRS_DEF(m_qwr, NRF_SDH_BLE_PERIPHERAL_LINK_COUNT);                   /**< Context for the Queued Write module, one per link.*/
 
  /**< Context for the Queued Write module.*/
 BLE_CUS_DEF(m_cus);
@@ -28,6 +28,53 @@ BLE_ADVERTISING_DEF(m_advertising);
 
 /*Temperature timer*/
 APP_TIMER_DEF(m_ecelerometr_timer_id);
+/*Gesture sample timer*/
+APP_TIMER_DEF(m_gesture_timer_id);
+
+static volatile bool     m_gesture_due;                                         /**< Gesture sample period elapsed, read in the main loop. */
+static volatile uint32_t m_gesture_tick;                                        /**< RTC ticks when the sample period elapsed. */
+static uint32_t          m_gesture_latency_max;                                 /**< Worst sample period to action latency, us. */
+static uint32_t          m_gesture_latency_misses;                              /**< Samples acted on later than one sample period, or skipped. */
+static uint32_t          m_gesture_rules_run;
+
+static uint32_t          m_device_ticks;                                        /**< RTC ticks since boot, the 24-bit counter extended to 32 bits, see device_time_update(). */
+static uint32_t          m_device_rtc;                                          /**< RTC counter at the last update of m_device_ticks. */
+
+static uint8_t           m_acel_frame[ACEL_VALUE_CHAR_MAX_LEN];                 /**< Stream frame header and the samples packed for the next accelerometer notification. */
+static uint16_t          m_acel_frame_len;
+static uint16_t          m_acel_frame_count;                                    /**< Samples in a packed frame. */
+static uint8_t           m_acel_format = ACEL_FORMAT_RAW;
+static accel_codec_t     m_acel_codec;                                          /**< Encoder of the ACEL_FORMAT_DELTA frames, on m_acel_frame. */
+static uint32_t          m_acel_encode_cycles;                                  /**< DWT cycles spent encoding, and the samples they encoded. */
+static uint32_t          m_acel_encode_samples;
+static uint32_t          m_acel_encode_cycles_max;
+static uint16_t          m_acel_frame_samples;                                  /**< Samples in the last frame queued. */
+static stream_frame_tx_t m_acel_stream;                                         /**< Sequence of the accelerometer notifications. */
+static uint32_t          m_acel_frame_time;                                     /**< Stream time of the first sample of the frame being packed. */
+static bool              m_acel_frame_open;                                     /**< The frame being packed holds a sample. */
+static bool              m_acel_acquiring;                                      /**< BMA280 awake and sampled at GESTURE_SAMPLE_RATE. */
+static uint8_t           m_acel_wake_skip;                                      /**< Samples left to drop after waking the BMA280. */
+static link_ctx_t        m_links[NRF_SDH_BLE_PERIPHERAL_LINK_COUNT];            /**< Context of every connection, see link_ctx_t. */
+static uint16_t          m_stream_conn_handle = BLE_CONN_HANDLE_INVALID;        /**< Connection that opened the audio stream. */
+static bool              m_adv_on;                                              /**< Connectable advertising running, to take one more link. */
+static uint8_t           m_burst_sdu[L2CAP_CHANNEL_SDU_MAX];                    /**< Stream frame header and the raw samples packed for the next L2CAP SDU. */
+static uint16_t          m_burst_len;                                           /**< Bytes of samples after the header. */
+static uint32_t          m_burst_time;                                          /**< Stream time of the first sample of the SDU being packed. */
+static stream_frame_tx_t m_burst_stream;                                        /**< Sequence of the burst SDUs. */
+static uint16_t          m_burst_conn_handle = BLE_CONN_HANDLE_INVALID;         /**< Connection whose L2CAP channel takes the burst. */
+static volatile uint32_t m_burst_remaining;                                     /**< Samples of CMD_ACEL_BURST left to send. */
+static link_bench_t      m_bench = { .conn_handle = BLE_CONN_HANDLE_INVALID };
+static uint8_t           m_bench_data[L2CAP_CHANNEL_SDU_MAX];                   /**< Test pattern of the bench, as long as the longest SDU. */
+static volatile bool     m_beacon_on;                                           /**< Sensor summary asked for in the advertising data. */
+static bool              m_beacon_shown;                                        /**< Sensor summary in the advertising data now. */
+static volatile bool     m_beacon_due;                                          /**< Summary to update, read in the main loop. */
+static volatile bool     m_broadcast_on;                                        /**< Extended advertising broadcast asked for, it holds the advertising set. */
+
+static uint16_t          m_acel_frame_max = BLE_GATT_ATT_MTU_DEFAULT - 3 - STREAM_FRAME_HEADER_LEN; /**< Room for samples after the header of one notification at the smallest MTU of the subscribed links. */
+
+STATIC_ASSERT(NOTIFY_QUEUE_LINKS >= NRF_SDH_BLE_PERIPHERAL_LINK_COUNT);
+STATIC_ASSERT((STREAM_FRAME_TICK_HZ % APP_TIMER_TICKS(1000)) == 0);
+STATIC_ASSERT(BLE_GATT_ATT_MTU_DEFAULT - 3 - STREAM_FRAME_HEADER_LEN >= ACCEL_CODEC_KEY_LEN + 2);
 
 uint8_t m_custom_value = 0;
 
@@ -68,6 +115,118 @@ static void pm_evt_handler(pm_evt_t const * p_evt)
 	}
 }
 
+/**@brief Function for finding the context of a connection.
+ *
+ * @param[in] conn_handle  Connection, BLE_CONN_HANDLE_INVALID finds a free entry.
+ *
+ * @return    The entry, NULL if there is none.
+ */
+static link_ctx_t * link_find(uint16_t conn_handle)
+{
+	uint8_t i;
+
+	for (i = 0; i < NRF_SDH_BLE_PERIPHERAL_LINK_COUNT; i++)
+	{
+		if (m_links[i].conn_handle == conn_handle)
+		{
+			return &m_links[i];
+		}
+	}
+	return NULL;
+}
+
+/**@brief Function for telling whether a connected client listens to the accelerometer.
+ */
+static bool acel_listened(void)
+{
+	uint8_t i;
+
+	for (i = 0; i < NRF_SDH_BLE_PERIPHERAL_LINK_COUNT; i++)
+	{
+		if ((m_links[i].conn_handle != BLE_CONN_HANDLE_INVALID) && m_links[i].acel_notify)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/**@brief Function for switching a connection between the idle and the streaming profile.
+ *
+ * @details Streaming while the client listens to the accelerometer, has the L2CAP channel open or
+ *          has opened the audio stream.
+ *          The parameters go through the Connection Parameters module, so it negotiates the
+ *          profile asked for and not the idle one of the PPCP. A request refused as busy is
+ *          retried on the next call.
+ *
+ * @param[in] p_link  Connection.
+ */
+static void conn_profile_update(link_ctx_t * p_link)
+{
+	ret_code_t            err_code;
+	ble_gap_conn_params_t params;
+	sound_stream_stats_t  stream;
+	conn_profile_t        profile;
+	bool                  streaming;
+
+	if (p_link->conn_handle == BLE_CONN_HANDLE_INVALID)
+	{
+		return;
+	}
+
+	sound_stream_stats_get(&stream);
+	streaming = p_link->acel_notify || p_link->l2cap_open ||
+	            ((stream.state != SOUND_STREAM_CLOSED) && (m_stream_conn_handle == p_link->conn_handle));
+	profile   = streaming ? CONN_PROFILE_STREAMING : CONN_PROFILE_IDLE;
+	if ((profile == p_link->profile) && !p_link->profile_pending)
+	{
+		return;
+	}
+
+	if (profile == CONN_PROFILE_STREAMING)
+	{
+		ble_gap_phys_t const phys =
+		{
+			.rx_phys = BLE_GAP_PHY_2MBPS,
+			.tx_phys = BLE_GAP_PHY_2MBPS,
+		};
+
+		params.min_conn_interval = STREAM_MIN_CONN_INTERVAL;
+		params.max_conn_interval = STREAM_MAX_CONN_INTERVAL;
+		params.slave_latency     = STREAM_SLAVE_LATENCY;
+		params.conn_sup_timeout  = CONN_SUP_TIMEOUT;
+		err_code = ble_conn_params_change_conn_params(p_link->conn_handle, &params);
+
+		// the central may keep 1M, the profile works on either
+		(void)sd_ble_gap_phy_update(p_link->conn_handle, &phys);
+	}
+	else
+	{
+		// back to the PPCP of gap_params_init()
+		err_code = ble_conn_params_change_conn_params(p_link->conn_handle, NULL);
+	}
+
+	p_link->profile         = profile;
+	p_link->profile_pending = (err_code == NRF_ERROR_BUSY);
+	if ((err_code != NRF_SUCCESS) && (err_code != NRF_ERROR_BUSY) && (err_code != NRF_ERROR_INVALID_STATE))
+	{
+		APP_ERROR_CHECK(err_code);
+	}
+	NRF_LOG_INFO("Connection 0x%x profile %s.", p_link->conn_handle, (profile == CONN_PROFILE_STREAMING) ? "streaming" : "idle");
+}
+
+/**@brief Function for updating the profile of every connection.
+ */
+static void conn_profiles_update(void)
+{
+	uint8_t i;
+
+	for (i = 0; i < NRF_SDH_BLE_PERIPHERAL_LINK_COUNT; i++)
+	{
+		conn_profile_update(&m_links[i]);
+	}
+}
+
 /**@brief Function for handling the Battery measurement timer timeout.
  *
  * @details This function will be called each time the battery level measurement timer expires.
@@ -77,27 +236,342 @@ static void pm_evt_handler(pm_evt_t const * p_evt)
  */
 static void acelerometr_level_meas_timeout_handler(void* p_context)
 {
-	ret_code_t err_code;
-	int32_t  raw_temperature = 0;     // signed 32 bit
-	int8_t   temperature = 0;     // signed 8 bit
-
 	UNUSED_PARAMETER(p_context);
 
-	BMA280_Get_Data(resultBMA, acelerometer);
-	
-//	sd_temp_get(&raw_temperature);
-//	// temperature is in 0.25C° units. watch out for negative values!
-//	temperature = raw_temperature / 4;
-//	uint32_encode(raw_temperature, encoded_temperature);
-
-	
-	// Only send the battery level update if we are connected
-	if(m_conn_handle != BLE_CONN_HANDLE_INVALID)
+	// the samples are read and sent from the main loop, see acel_sample_put()
+	m_beacon_due = true;
+	if (ble_conn_state_peripheral_conn_count() > 0)
 	{
 		bsp_board_led_invert(BSP_LED_INDICATE_USER_LED2);	
-			err_code = acelerometer_value_update(&m_acel_cus, acelerometer, sizeof(acelerometer));
-				APP_ERROR_CHECK(err_code);
+
+		// an audio stream closes by itself once its last frame has played
+		conn_profiles_update();
+	}
+}
+
+/**@brief Function for sending one accelerometer frame from the notification queue, on one connection.
+ */
+static uint32_t acel_frame_send(uint16_t conn_handle, uint8_t * p_data, uint16_t length)
+{
+	return acelerometer_value_update(&m_acel_cus, conn_handle, p_data, length);
+}
+
+/**@brief Function for dropping the frame being packed, on a new MTU or format.
+ *
+ * @details The next frame is flagged STREAM_FRAME_FLAG_RESUMED: its first sample does not follow
+ *          the last one sent.
+ */
+static void acel_frame_reset(void)
+{
+	m_acel_frame_len   = 0;
+	m_acel_frame_count = 0;
+	m_acel_frame_open  = false;
+	accel_codec_init(&m_acel_codec, &m_acel_frame[STREAM_FRAME_HEADER_LEN], m_acel_frame_max);
+	stream_frame_tx_resume(&m_acel_stream);
+}
+
+/**@brief Function for sizing the frames to the subscribed link with the smallest MTU.
+ *
+ * @details One frame goes to every subscribed link unchanged, so it has to fit the smallest
+ *          payload. The frame being packed is dropped when the size changes.
+ */
+static void acel_frame_max_update(void)
+{
+	uint16_t payload = ACEL_VALUE_CHAR_MAX_LEN;
+	uint16_t frame_max;
+	uint8_t  i;
+
+	if (!acel_listened())
+	{
+		payload = BLE_GATT_ATT_MTU_DEFAULT - 3;
+	}
+
+	for (i = 0; i < NRF_SDH_BLE_PERIPHERAL_LINK_COUNT; i++)
+	{
+		if ((m_links[i].conn_handle != BLE_CONN_HANDLE_INVALID) && m_links[i].acel_notify)
+		{
+			payload = MIN(payload, m_links[i].payload);
+		}
+	}
+
+	frame_max = payload - STREAM_FRAME_HEADER_LEN;
+	if (frame_max != m_acel_frame_max)
+	{
+		m_acel_frame_max = frame_max;
+		acel_frame_reset();
+		NRF_LOG_INFO("%u samples per notification.", m_acel_frame_max / ACEL_SAMPLE_LEN);
+	}
+}
+
+/**@brief Function for taking a new connection into the link table.
+ *
+ * @details Called from the service events, which come before the application BLE events. Each
+ *          service instance reports the connection, the second report finds the entry taken.
+ *
+ * @param[in] conn_handle  Connection.
+ *
+ * @return    The entry, NULL if the table is full.
+ */
+static link_ctx_t * link_open(uint16_t conn_handle)
+{
+	link_ctx_t * p_link = link_find(conn_handle);
+
+	if (p_link != NULL)
+	{
+		return p_link;
+	}
+
+	p_link = link_find(BLE_CONN_HANDLE_INVALID);
+	if (p_link != NULL)
+	{
+		p_link->conn_handle     = conn_handle;
+		p_link->acel_notify     = false;
+		p_link->payload         = BLE_GATT_ATT_MTU_DEFAULT - 3;
+		p_link->tx_phy          = BLE_GAP_PHY_1MBPS;
+		p_link->profile         = CONN_PROFILE_IDLE;
+		p_link->profile_pending = false;
+		p_link->l2cap_open      = false;
+	}
+	return p_link;
+}
+
+/**@brief Function for freeing the entry of a closed connection.
+ *
+ * @param[in] conn_handle  Connection.
+ */
+static void link_close(uint16_t conn_handle)
+{
+	link_ctx_t * p_link = link_find(conn_handle);
+
+	if (p_link == NULL)
+	{
+		return;
+	}
+
+	notify_queue_link_remove(conn_handle);
+	if (m_stream_conn_handle == conn_handle)
+	{
+		m_stream_conn_handle = BLE_CONN_HANDLE_INVALID;
+	}
+	if (m_burst_conn_handle == conn_handle)
+	{
+		m_burst_remaining = 0;
+	}
+	if (m_bench.conn_handle == conn_handle)
+	{
+		m_bench.conn_handle = BLE_CONN_HANDLE_INVALID;
+	}
+	p_link->conn_handle = BLE_CONN_HANDLE_INVALID;
+	p_link->acel_notify = false;
+	p_link->l2cap_open  = false;
+	acel_frame_max_update();
+}
+
+/**@brief Function for encoding a sample in ACEL_SAMPLE_LEN bytes, left aligned as in the BMA280 registers.
+ */
+static void acel_raw_encode(int16_t const * p_accel, uint8_t * p_out)
+{
+	uint8_t i;
+
+	for (i = 0; i < 3; i++)
+	{
+		(void)uint16_encode((uint16_t)p_accel[i] << 2, &p_out[2 * i]);
+	}
+}
+
+/**@brief Function for putting the stream frame header on the packed frame and queueing it.
+ *
+ * @param[in] length  Bytes of samples after the header.
+ * @param[in] count   Samples in the frame.
+ */
+static void acel_frame_queue(uint16_t length, uint16_t count)
+{
+	stream_frame_header_put(&m_acel_stream, m_acel_format, m_acel_frame_time, count, m_acel_frame);
+	m_acel_frame_samples = count;
+	m_acel_frame_open    = false;
+	if (!notify_queue_put(m_acel_frame, STREAM_FRAME_HEADER_LEN + length))
+	{
+		m_acel_stream.dropped++;
+	}
+}
+
+/**@brief Function for packing an accelerometer sample into the next notification.
+ *
+ * @details The samples of one notification are as many as fit the MTU negotiated with the client,
+ *          after the stream frame header: raw, 38 at an MTU of 247 and 1 with the default MTU of 23,
+ *          43 packed in 14 bits, delta coded about three times the raw count on a sensor in hand.
+ *          A full frame goes to the notification queue, which keeps the SoftDevice TX slots filled
+ *          and counts what it has to drop. It is encoded once for all the subscribed links, at the
+ *          smallest of their MTUs.
+ *
+ * @param[in] p_accel  x, y and z as signed 14-bit counts.
+ * @param[in] time     Stream time of the sample, STREAM_FRAME_TICK_HZ ticks.
+ */
+static void acel_sample_put(int16_t const * p_accel, uint32_t time)
+{
+	if (!acel_listened())
+	{
+		acel_frame_reset();
+		return;
+	}
+
+	if (!m_acel_frame_open)
+	{
+		m_acel_frame_time = time;
+		m_acel_frame_open = true;
+	}
+
+	if (m_acel_format == ACEL_FORMAT_DELTA)
+	{
+		uint32_t start  = DWT->CYCCNT;
+		bool     full   = accel_codec_put(&m_acel_codec, p_accel);
+		uint32_t cycles = DWT->CYCCNT - start;
+
+		m_acel_encode_cycles    += cycles;
+		m_acel_encode_samples++;
+		m_acel_encode_cycles_max = MAX(m_acel_encode_cycles_max, cycles);
+
+		if (full)
+		{
+			acel_frame_queue(m_acel_codec.length, m_acel_codec.count);
+			accel_codec_next(&m_acel_codec);
+			if (m_acel_codec.count > 0)
+			{
+				// the samples that did not fit start the next frame, this one the latest of them
+				uint16_t waiting = m_acel_codec.count + m_acel_codec.group_count;
+
+				m_acel_frame_time = time - (waiting - 1) * (GESTURE_SAMPLE_INTERVAL * ACEL_STREAM_TICK_SCALE);
+				m_acel_frame_open = true;
+			}
+		}
+		return;
+	}
+
+	if ((m_acel_format == ACEL_FORMAT_PACKED14) || (m_acel_format == ACEL_FORMAT_PACKED12))
+	{
+		uint8_t bits = (m_acel_format == ACEL_FORMAT_PACKED14) ? 14 : 12;
+
+		m_acel_frame_len = accel_codec_pack(p_accel, bits, &m_acel_frame[STREAM_FRAME_HEADER_LEN], m_acel_frame_count);
+		m_acel_frame_count++;
+
+		if ((uint32_t)(m_acel_frame_count + 1) * 3 * bits > (uint32_t)m_acel_frame_max * 8)
+		{
+			acel_frame_queue(m_acel_frame_len, m_acel_frame_count);
+			m_acel_frame_len   = 0;
+			m_acel_frame_count = 0;
+		}
+		return;
+	}
+
+	// same left aligned register layout as the single sample values before
+	acel_raw_encode(p_accel, &m_acel_frame[STREAM_FRAME_HEADER_LEN + m_acel_frame_len]);
+	m_acel_frame_len += ACEL_SAMPLE_LEN;
+
+	if (m_acel_frame_len + ACEL_SAMPLE_LEN > m_acel_frame_max)
+	{
+		acel_frame_queue(m_acel_frame_len, m_acel_frame_len / ACEL_SAMPLE_LEN);
+		m_acel_frame_len = 0;
+	}
+}
+
+/**@brief Function for packing an accelerometer sample into the next SDU of a CMD_ACEL_BURST.
+ *
+ * @details Raw samples after the stream frame header, as many as fit the SDU size of the channel:
+ *          169 at the largest SDU against 38 in a notification. A burst ends early when its channel
+ *          closes, an SDU the channel has no buffer for is counted in m_burst_stream and in the
+ *          channel statistics.
+ *
+ * @param[in] p_accel  x, y and z as signed 14-bit counts.
+ * @param[in] time     Stream time of the sample, STREAM_FRAME_TICK_HZ ticks.
+ */
+static void acel_burst_put(int16_t const * p_accel, uint32_t time)
+{
+	uint16_t sdu_max;
+
+	if (m_burst_remaining == 0)
+	{
+		return;
+	}
+
+	sdu_max = l2cap_channel_sdu_max_get(m_burst_conn_handle);
+	if (sdu_max < STREAM_FRAME_HEADER_LEN + ACEL_SAMPLE_LEN)
+	{
+		m_burst_remaining = 0;
+		m_burst_len       = 0;
+		return;
+	}
+	sdu_max = (sdu_max - STREAM_FRAME_HEADER_LEN) / ACEL_SAMPLE_LEN * ACEL_SAMPLE_LEN;
+
+	if (m_burst_len == 0)
+	{
+		m_burst_time = time;
+	}
+	acel_raw_encode(p_accel, &m_burst_sdu[STREAM_FRAME_HEADER_LEN + m_burst_len]);
+	m_burst_len += ACEL_SAMPLE_LEN;
+	m_burst_remaining--;
+
+	if ((m_burst_len + ACEL_SAMPLE_LEN > sdu_max) || (m_burst_remaining == 0))
+	{
+		stream_frame_header_put(&m_burst_stream, STREAM_FRAME_ENCODING_RAW, m_burst_time,
+		                        m_burst_len / ACEL_SAMPLE_LEN, m_burst_sdu);
+		if (l2cap_channel_send(m_burst_conn_handle, m_burst_sdu, STREAM_FRAME_HEADER_LEN + m_burst_len) != NRF_SUCCESS)
+		{
+			m_burst_stream.dropped++;
+		}
+		m_burst_len = 0;
+	}
+}
+
+/**@brief Function for extending the 24-bit RTC counter to m_device_ticks.
+ *
+ * @details Called from the main loop, which the one second timer wakes well within the counter
+ *          period of 1024 s at the app_timer prescaler.
+ */
+static void device_time_update(void)
+{
+	uint32_t rtc = app_timer_cnt_get();
+
+	m_device_ticks += app_timer_cnt_diff_compute(rtc, m_device_rtc);
+	m_device_rtc    = rtc;
+}
+
+/**@brief Function for getting the device time of an RTC counter value read near the last update.
+ *
+ * @param[in] rtc  RTC counter value, less than half the counter period before or after the update.
+ *
+ * @return    RTC ticks since boot, 32 bits.
+ */
+static uint32_t device_ticks_at(uint32_t rtc)
+{
+	uint32_t ahead = app_timer_cnt_diff_compute(rtc, m_device_rtc);
+
+	// read in a timer interrupt just before the update
+	if (ahead >= (1UL << 23))
+	{
+		return m_device_ticks - app_timer_cnt_diff_compute(m_device_rtc, rtc);
+	}
+	return m_device_ticks + ahead;
+}
+
+/**@brief Function for handling the gesture sample timer timeout.
+ *
+ * @details The BMA280 is read in the main loop: the TWI driver interrupt has the same priority as
+ *          the timer, a blocking transfer here would never finish.
+ *
+ * @param[in] p_context  Not used.
+ */
+static void gesture_timeout_handler(void* p_context)
+{
+	UNUSED_PARAMETER(p_context);
+
+	if (m_gesture_due)
+	{
+		// the main loop did not get to the previous sample
+		m_gesture_latency_misses++;
 	}
+
+	m_gesture_tick = app_timer_cnt_get();
+	m_gesture_due  = true;
 }
 
 /**@brief Function for the Timer initialization.
@@ -112,94 +586,906 @@ static void timers_init(void)
 
 	// Create timers.
 
-	err_code = app_timer_create(&m_ecelerometr_timer_id, 
-		APP_TIMER_MODE_REPEATED, 
-		acelerometr_level_meas_timeout_handler);
+	err_code = app_timer_create(&m_ecelerometr_timer_id, 
+		APP_TIMER_MODE_REPEATED, 
+		acelerometr_level_meas_timeout_handler);
+
+	APP_ERROR_CHECK(err_code);
+
+	err_code = app_timer_create(&m_gesture_timer_id,
+		APP_TIMER_MODE_REPEATED,
+		gesture_timeout_handler);
+
+	APP_ERROR_CHECK(err_code);
+
+	/* YOUR_JOB: Create any timers to be used by the application.
+	             Below is an example of how to create a timer.
+	             For every new timer needed, increase the value of the macro APP_TIMER_MAX_TIMERS by
+	             one.
+	      ret_code_t err_code;
+	      err_code = app_timer_create(&m_app_timer_id, APP_TIMER_MODE_REPEATED, timer_timeout_handler);
+	      APP_ERROR_CHECK(err_code); */
+}
+
+
+/**@brief Function for the GAP initialization.
+ *
+ * @details This function sets up all the necessary GAP (Generic Access Profile) parameters of the
+ *          device including the device name, appearance, and the preferred connection parameters.
+ */
+static void gap_params_init(void)
+{
+	ret_code_t              err_code;
+	ble_gap_conn_params_t   gap_conn_params;
+	ble_gap_conn_sec_mode_t sec_mode;
+
+	BLE_GAP_CONN_SEC_MODE_SET_OPEN(&sec_mode);
+
+	err_code = sd_ble_gap_device_name_set(&sec_mode,
+		(const uint8_t *)DEVICE_NAME,
+		strlen(DEVICE_NAME));
+	APP_ERROR_CHECK(err_code);
+
+	/* YOUR_JOB: Use an appearance value matching the application's use case.
+	   err_code = sd_ble_gap_appearance_set(BLE_APPEARANCE_);
+	   APP_ERROR_CHECK(err_code); */
+
+	memset(&gap_conn_params, 0, sizeof(gap_conn_params));
+
+	gap_conn_params.min_conn_interval = MIN_CONN_INTERVAL;
+	gap_conn_params.max_conn_interval = MAX_CONN_INTERVAL;
+	gap_conn_params.slave_latency     = SLAVE_LATENCY;
+	gap_conn_params.conn_sup_timeout  = CONN_SUP_TIMEOUT;
+
+	err_code = sd_ble_gap_ppcp_set(&gap_conn_params);
+	APP_ERROR_CHECK(err_code);
+}
+
+
+/**@brief Function for handling the GATT module events.
+ *
+ * @param[in] p_gatt  GATT module instance.
+ * @param[in] p_evt   MTU or data length negotiated on a connection.
+ */
+static void gatt_evt_handler(nrf_ble_gatt_t * p_gatt, nrf_ble_gatt_evt_t const * p_evt)
+{
+	link_ctx_t * p_link = link_find(p_evt->conn_handle);
+
+	switch (p_evt->evt_id)
+	{
+	case NRF_BLE_GATT_EVT_ATT_MTU_UPDATED:
+		NRF_LOG_INFO("Connection 0x%x ATT MTU %u.", p_evt->conn_handle, p_evt->params.att_mtu_effective);
+		if (p_link != NULL)
+		{
+			// a notification carries MTU - 3 bytes, filled with whole samples only
+			p_link->payload = MIN(p_evt->params.att_mtu_effective - 3, ACEL_VALUE_CHAR_MAX_LEN);
+			acel_frame_max_update();
+		}
+		break;
+
+	case NRF_BLE_GATT_EVT_DATA_LENGTH_UPDATED:
+		NRF_LOG_INFO("Data length %u.", p_evt->params.data_length);
+		break;
+
+	default:
+		break;
+	}
+}
+
+/**@brief Function for initializing the GATT module.
+ *
+ * @details The MTU exchange and the data length update are requested on every connection, so a
+ *          full notification goes in one link layer packet.
+ */
+static void gatt_init(void)
+{
+	ret_code_t err_code = nrf_ble_gatt_init(&m_gatt, gatt_evt_handler);
+	APP_ERROR_CHECK(err_code);
+
+	err_code = nrf_ble_gatt_att_mtu_periph_set(&m_gatt, NRF_SDH_BLE_GATT_MAX_MTU_SIZE);
+	APP_ERROR_CHECK(err_code);
+
+	err_code = nrf_ble_gatt_data_length_set(&m_gatt, BLE_CONN_HANDLE_INVALID, NRF_SDH_BLE_GAP_DATA_LENGTH);
+	APP_ERROR_CHECK(err_code);
+}
+
+
+/**@brief Function for handling Queued Write Module errors.
+ *
+ * @details A pointer to this function will be passed to each service which may need to inform the
+ *          application about an error.
+ *
+ * @param[in]   nrf_error   Error code containing information about what went wrong.
+ */
+static void nrf_qwr_error_handler(uint32_t nrf_error)
+{
+	APP_ERROR_HANDLER(nrf_error);
+}
+
+/**@brief Function for sending one frame on the sound status characteristic.
+ *
+ * @param[in]   p_status   SOUND_STATUS_CHAR_LEN bytes.
+ */
+static void sound_status_send(uint8_t * p_status)
+{
+	ret_code_t err_code;
+
+	err_code = sound_status_update(&m_acel_cus, p_status, SOUND_STATUS_CHAR_LEN);
+	if ((err_code != NRF_ERROR_INVALID_STATE) &&
+	    (err_code != NRF_ERROR_RESOURCES) &&
+	    (err_code != BLE_ERROR_GATTS_SYS_ATTR_MISSING))
+	{
+		APP_ERROR_CHECK(err_code);
+	}
+}
+
+/**@brief Function for sending the audio stream jitter buffer statistics on the sound status characteristic.
+ */
+static void sound_stream_stats_send(void)
+{
+	sound_stream_stats_t stats;
+	uint8_t              status[SOUND_STATUS_CHAR_LEN] = { SOUND_STATUS_STREAM };
+
+	sound_stream_stats_get(&stats);
+	status[1] = stats.state;
+	uint16_encode(stats.target, &status[2]);
+	uint16_encode(stats.depth, &status[4]);
+	uint16_encode(stats.jitter, &status[6]);
+	uint16_encode(stats.underruns, &status[8]);
+	uint16_encode(stats.late_frames, &status[10]);
+	uint16_encode(stats.lost_frames, &status[12]);
+	uint16_encode(stats.overflows, &status[14]);
+	sound_status_send(status);
+}
+
+/**@brief Function for sending the render, trigger latency, output stage and gesture statistics on the sound status characteristic.
+ */
+static void sound_stats_send(void)
+{
+	sound_stats_t stats;
+	uint8_t       status[SOUND_STATUS_CHAR_LEN] = { SOUND_STATUS_STATS };
+	uint8_t       latency[SOUND_STATUS_CHAR_LEN] = { SOUND_STATUS_LATENCY };
+	uint8_t       dsp[SOUND_STATUS_CHAR_LEN] = { SOUND_STATUS_DSP };
+	uint8_t       gesture[SOUND_STATUS_CHAR_LEN] = { SOUND_STATUS_GESTURE_STATS };
+	uint8_t       power[SOUND_STATUS_CHAR_LEN] = { SOUND_STATUS_POWER };
+	uint8_t       notify[SOUND_STATUS_CHAR_LEN] = { SOUND_STATUS_NOTIFY };
+	uint8_t       acel[SOUND_STATUS_CHAR_LEN] = { SOUND_STATUS_ACEL };
+	uint8_t       l2cap[SOUND_STATUS_CHAR_LEN] = { SOUND_STATUS_L2CAP };
+	uint8_t       broadcast[SOUND_STATUS_CHAR_LEN] = { SOUND_STATUS_BROADCAST };
+	uint8_t       frames[SOUND_STATUS_CHAR_LEN] = { SOUND_STATUS_STREAM_FRAMES };
+	notify_queue_stats_t queue;
+	l2cap_channel_stats_t channels;
+	broadcast_stats_t     batches;
+
+	sound_stats_get(&stats);
+	uint32_encode(stats.render_cycles_max, &status[4]);
+	uint32_encode(stats.synth_cycles_max, &status[8]);
+	uint32_encode(stats.synth_budget_overruns, &status[12]);
+	sound_status_send(status);
+
+	uint32_encode(stats.trigger_latency_last, &latency[4]);
+	uint32_encode(stats.trigger_latency_max, &latency[8]);
+	uint32_encode(stats.trigger_latency_misses, &latency[12]);
+	sound_status_send(latency);
+
+	dsp[1] = output_dsp_stages_get();
+	uint32_encode(stats.dsp_cycles_max, &dsp[4]);
+	uint32_encode(stats.dsp_budget_overruns, &dsp[8]);
+	uint32_encode(output_dsp_gain_min_get(), &dsp[12]);
+	sound_status_send(dsp);
+
+	sound_stream_stats_send();
+
+	uint32_encode(m_gesture_latency_max, &gesture[4]);
+	uint32_encode(m_gesture_latency_misses, &gesture[8]);
+	uint32_encode(m_gesture_rules_run, &gesture[12]);
+	sound_status_send(gesture);
+
+	power[1] = sound_state_get();
+	uint32_encode(stats.power_ups, &power[4]);
+	uint32_encode(stats.cold_latency_max, &power[8]);
+	uint32_encode(I2S_DRAIN_MS, &power[12]);
+	sound_status_send(power);
+
+	notify_queue_stats_get(&queue);
+	notify[1] = queue.depth;
+	notify[2] = queue.high_water;
+	notify[3] = queue.links;
+	uint32_encode(queue.queued, &notify[4]);
+	uint32_encode(queue.sent, &notify[8]);
+	uint32_encode(queue.dropped, &notify[12]);
+	sound_status_send(notify);
+
+	acel[1] = m_acel_format;
+	(void)uint16_encode(m_acel_frame_samples, &acel[2]);
+	uint32_encode((m_acel_encode_samples > 0) ? m_acel_encode_cycles / m_acel_encode_samples : 0, &acel[4]);
+	uint32_encode(m_acel_encode_cycles_max, &acel[8]);
+	uint32_encode(m_acel_encode_samples, &acel[12]);
+	sound_status_send(acel);
+
+	l2cap_channel_stats_get(&channels);
+	l2cap[1] = channels.open;
+	(void)uint16_encode((uint16_t)MIN(channels.tx_busy, UINT16_MAX), &l2cap[2]);
+	uint32_encode(channels.sdus_sent, &l2cap[4]);
+	uint32_encode(channels.bytes_sent, &l2cap[8]);
+	uint32_encode(channels.bytes_received, &l2cap[12]);
+	sound_status_send(l2cap);
+
+	broadcast_stats_get(&batches);
+	broadcast[1] = batches.on;
+	uint32_encode(batches.batches, &broadcast[4]);
+	uint32_encode(batches.samples, &broadcast[8]);
+	uint32_encode(batches.refused, &broadcast[12]);
+	sound_status_send(broadcast);
+
+	// notifications dropped under backpressure on one link are in the notification queue frame
+	(void)uint16_encode((uint16_t)MIN(m_acel_stream.dropped, UINT16_MAX), &frames[2]);
+	uint32_encode(m_acel_stream.frames, &frames[4]);
+	uint32_encode(m_burst_stream.frames, &frames[8]);
+	uint32_encode(m_burst_stream.dropped, &frames[12]);
+	sound_status_send(frames);
+}
+
+/**@brief Function for running CMD_SOUND_CONDITION: [condition], see set_play_sound_condition().
+ */
+static command_result_t cmd_sound_condition(uint16_t conn_handle, uint8_t const * p_value, uint8_t length)
+{
+	set_play_sound_condition(p_value[0]);
+	return COMMAND_RESULT_OK;
+}
+
+/**@brief Function for running CMD_SOUND_MASTER_GAIN: [gain LSB, gain MSB].
+ */
+static command_result_t cmd_sound_master_gain(uint16_t conn_handle, uint8_t const * p_value, uint8_t length)
+{
+	sound_master_gain_set(uint16_decode(&p_value[0]));
+	return COMMAND_RESULT_OK;
+}
+
+/**@brief Function for running CMD_SOUND_VOICE_GAIN: [voice, gain LSB, gain MSB].
+ */
+static command_result_t cmd_sound_voice_gain(uint16_t conn_handle, uint8_t const * p_value, uint8_t length)
+{
+	sound_voice_gain_set(p_value[0], uint16_decode(&p_value[1]));
+	return COMMAND_RESULT_OK;
+}
+
+/**@brief Function for running CMD_SOUND_STATS.
+ */
+static command_result_t cmd_sound_stats(uint16_t conn_handle, uint8_t const * p_value, uint8_t length)
+{
+	sound_stats_send();
+	return COMMAND_RESULT_OK;
+}
+
+/**@brief Function for running CMD_SOUND_PLAY: [clip (, priority)].
+ */
+static command_result_t cmd_sound_play(uint16_t conn_handle, uint8_t const * p_value, uint8_t length)
+{
+	if (length >= 2)
+	{
+		sound_play_priority(p_value[0], p_value[1]);
+	}
+	else
+	{
+		sound_play(p_value[0]);
+	}
+	return COMMAND_RESULT_OK;
+}
+
+/**@brief Function for running CMD_SOUND_RELEASE.
+ */
+static command_result_t cmd_sound_release(uint16_t conn_handle, uint8_t const * p_value, uint8_t length)
+{
+	sound_release();
+	return COMMAND_RESULT_OK;
+}
+
+/**@brief Function for running CMD_SOUND_PREARM: [enable].
+ */
+static command_result_t cmd_sound_prearm(uint16_t conn_handle, uint8_t const * p_value, uint8_t length)
+{
+	sound_prearm_set(p_value[0] != 0);
+	return COMMAND_RESULT_OK;
+}
+
+/**@brief Function for running CMD_SOUND_EQ: [stage, post shift, b0, b1, b2, a1, a2], [stage] ends the cascade.
+ */
+static command_result_t cmd_sound_eq(uint16_t conn_handle, uint8_t const * p_value, uint8_t length)
+{
+	output_dsp_biquad_t biquad;
+
+	if (length == 1)
+	{
+		(void)sound_eq_set(p_value[0], NULL);
+		return COMMAND_RESULT_OK;
+	}
+
+	if (length < 12)
+	{
+		return COMMAND_RESULT_LENGTH;
+	}
+
+	biquad.post_shift = p_value[1];
+	biquad.coeffs[0]  = (int16_t)uint16_decode(&p_value[2]);
+	biquad.coeffs[1]  = 0;
+	biquad.coeffs[2]  = (int16_t)uint16_decode(&p_value[4]);
+	biquad.coeffs[3]  = (int16_t)uint16_decode(&p_value[6]);
+	biquad.coeffs[4]  = (int16_t)uint16_decode(&p_value[8]);
+	biquad.coeffs[5]  = (int16_t)uint16_decode(&p_value[10]);
+	if (!sound_eq_set(p_value[0], &biquad))
+	{
+		NRF_LOG_INFO("EQ stage %d refused", p_value[0]);
+		return COMMAND_RESULT_REFUSED;
+	}
+	return COMMAND_RESULT_OK;
+}
+
+/**@brief Function for running CMD_SOUND_LIMITER: [enable, threshold, release ms].
+ */
+static command_result_t cmd_sound_limiter(uint16_t conn_handle, uint8_t const * p_value, uint8_t length)
+{
+	output_dsp_limiter_t limiter;
+
+	limiter.enabled    = (p_value[0] != 0);
+	limiter.threshold  = uint16_decode(&p_value[1]);
+	limiter.release_ms = uint16_decode(&p_value[3]);
+	sound_limiter_set(&limiter);
+	return COMMAND_RESULT_OK;
+}
+
+/**@brief Function for running CMD_GESTURE_RULE: [slot, event, match, level, action, clip, gain].
+ */
+static command_result_t cmd_gesture_rule(uint16_t conn_handle, uint8_t const * p_value, uint8_t length)
+{
+	gesture_rule_t rule;
+
+	rule.event   = p_value[1];
+	rule.match   = p_value[2];
+	rule.level   = (int16_t)uint16_decode(&p_value[3]);
+	rule.action  = p_value[5];
+	rule.clip_id = p_value[6];
+	rule.gain    = uint16_decode(&p_value[7]);
+	if (!gesture_rule_set(p_value[0], &rule))
+	{
+		NRF_LOG_INFO("Gesture rule %d refused", p_value[0]);
+		return COMMAND_RESULT_REFUSED;
+	}
+	return COMMAND_RESULT_OK;
+}
+
+/**@brief Function for running CMD_GESTURE_CONFIG: [tap threshold, tap shock ms, double tap ms, orientation ms].
+ */
+static command_result_t cmd_gesture_config(uint16_t conn_handle, uint8_t const * p_value, uint8_t length)
+{
+	gesture_config_t config;
+
+	config.tap_threshold  = uint16_decode(&p_value[0]);
+	config.tap_shock_ms   = uint16_decode(&p_value[2]);
+	config.double_tap_ms  = uint16_decode(&p_value[4]);
+	config.orientation_ms = uint16_decode(&p_value[6]);
+	gesture_config_set(&config);
+	return COMMAND_RESULT_OK;
+}
+
+/**@brief Function for running CMD_ACEL_FORMAT: [format].
+ */
+static command_result_t cmd_acel_format(uint16_t conn_handle, uint8_t const * p_value, uint8_t length)
+{
+	if (p_value[0] > ACEL_FORMAT_PACKED12)
+	{
+		return COMMAND_RESULT_REFUSED;
+	}
+
+	m_acel_format = p_value[0];
+	acel_frame_reset();
+	return COMMAND_RESULT_OK;
+}
+
+/**@brief Function for running CMD_ACEL_BURST: [samples LSB, samples MSB].
+ */
+static command_result_t cmd_acel_burst(uint16_t conn_handle, uint8_t const * p_value, uint8_t length)
+{
+	uint16_t samples = uint16_decode(&p_value[0]);
+
+	if ((samples > 0) && (l2cap_channel_sdu_max_get(conn_handle) == 0))
+	{
+		NRF_LOG_INFO("Burst refused, no L2CAP channel");
+		return COMMAND_RESULT_REFUSED;
+	}
+
+	m_burst_len         = 0;
+	m_burst_conn_handle = conn_handle;
+	m_burst_remaining   = samples;
+	stream_frame_tx_resume(&m_burst_stream);
+	return COMMAND_RESULT_OK;
+}
+
+/**@brief Function for running CMD_LINK_BENCH: [path, seconds], see link_bench_process().
+ */
+static command_result_t cmd_link_bench(uint16_t conn_handle, uint8_t const * p_value, uint8_t length)
+{
+	link_ctx_t * p_link = link_find(conn_handle);
+	bool         ready;
+	uint16_t     i;
+
+	if ((p_link == NULL) || (p_value[1] == 0) || (p_value[1] > LINK_BENCH_SECONDS_MAX) ||
+	    (m_bench.conn_handle != BLE_CONN_HANDLE_INVALID))
+	{
+		return COMMAND_RESULT_REFUSED;
+	}
+
+	switch (p_value[0])
+	{
+	case LINK_BENCH_PATH_NOTIFY:
+		ready = p_link->acel_notify;
+		break;
+
+	case LINK_BENCH_PATH_L2CAP:
+		ready = p_link->l2cap_open;
+		break;
+
+	default:
+		ready = false;
+		break;
+	}
+	if (!ready)
+	{
+		NRF_LOG_INFO("Bench path %d not open", p_value[0]);
+		return COMMAND_RESULT_REFUSED;
+	}
+
+	for (i = 0; i < sizeof(m_bench_data); i++)
+	{
+		m_bench_data[i] = (uint8_t)i;
+	}
+	m_bench.path        = p_value[0];
+	m_bench.duration    = APP_TIMER_TICKS(1000 * (uint32_t)p_value[1]);
+	m_bench.bytes       = 0;
+	m_bench.cycles      = 0;
+	m_bench.start       = app_timer_cnt_get();
+	m_bench.conn_handle = conn_handle;
+	return COMMAND_RESULT_OK;
+}
+
+/**@brief Function for running CMD_BEACON: [enable], see beacon_process().
+ */
+static command_result_t cmd_beacon(uint16_t conn_handle, uint8_t const * p_value, uint8_t length)
+{
+	m_beacon_on  = (p_value[0] != 0);
+	m_beacon_due = true;
+	return COMMAND_RESULT_OK;
+}
+
+/**@brief Function for running CMD_BROADCAST: [enable], see broadcast_process().
+ */
+static command_result_t cmd_broadcast(uint16_t conn_handle, uint8_t const * p_value, uint8_t length)
+{
+	m_broadcast_on = (p_value[0] != 0);
+	return COMMAND_RESULT_OK;
+}
+
+/**@brief Function for running CMD_SOUND_TONE: [waveform, frequency, duration, attack, decay, sustain, release].
+ */
+static command_result_t cmd_sound_tone(uint16_t conn_handle, uint8_t const * p_value, uint8_t length)
+{
+	synth_params_t tone;
+
+	tone.waveform    = p_value[0];
+	tone.frequency   = uint16_decode(&p_value[1]);
+	tone.duration_ms = uint16_decode(&p_value[3]);
+	tone.attack_ms   = uint16_decode(&p_value[5]);
+	tone.decay_ms    = uint16_decode(&p_value[7]);
+	tone.sustain     = uint16_decode(&p_value[9]);
+	tone.release_ms  = uint16_decode(&p_value[11]);
+	sound_tone(&tone);
+	return COMMAND_RESULT_OK;
+}
+
+/**@brief Function for running CMD_SOUND_PATTERN: [loops, tick ms, steps...].
+ */
+static command_result_t cmd_sound_pattern(uint16_t conn_handle, uint8_t const * p_value, uint8_t length)
+{
+	if (!sound_pattern_play(p_value, length))
+	{
+		NRF_LOG_INFO("Malformed pattern");
+		return COMMAND_RESULT_REFUSED;
+	}
+	return COMMAND_RESULT_OK;
+}
+
+/**@brief Function for running CMD_SOUND_STREAM: [rate LSB, rate MSB].
+ */
+static command_result_t cmd_sound_stream(uint16_t conn_handle, uint8_t const * p_value, uint8_t length)
+{
+	command_result_t result = COMMAND_RESULT_OK;
+	uint16_t         rate   = uint16_decode(&p_value[0]);
+
+	if (rate == 0)
+	{
+		sound_stream_close();
+	}
+	else if (!sound_stream_play(rate))
+	{
+		NRF_LOG_INFO("Stream rate %d not supported", rate);
+		result = COMMAND_RESULT_REFUSED;
+	}
+	// a refused rate leaves no stream open either, the old one gave up its voice
+	m_stream_conn_handle = ((rate == 0) || (result != COMMAND_RESULT_OK)) ? BLE_CONN_HANDLE_INVALID : conn_handle;
+	conn_profiles_update();
+	return result;
+}
+
+/**@brief Function for running CMD_CLIP_BEGIN: [clip, rate, size, crc (, priority (, loop start, loop end))].
+ */
+static command_result_t cmd_clip_begin(uint16_t conn_handle, uint8_t const * p_value, uint8_t length)
+{
+	ret_code_t        err_code;
+	clip_store_info_t info;
+
+	// without the loop fields the clip plays once at the player default priority
+	info.sample_rate = uint16_decode(&p_value[1]);
+	info.priority    = (length >= 10) ? p_value[9] : 0xFF;
+	info.loop_start  = (length >= 18) ? uint32_decode(&p_value[10]) : 0;
+	info.loop_end    = (length >= 18) ? uint32_decode(&p_value[14]) : 0;
+
+	err_code = clip_store_begin(p_value[0], &info, uint32_decode(&p_value[3]), uint16_decode(&p_value[7]));
+	if (err_code != NRF_SUCCESS)
+	{
+		NRF_LOG_INFO("Clip upload refused: %d", err_code);
+		return COMMAND_RESULT_REFUSED;
+	}
+	// the identifier is being replaced, a voice still playing the old clip is cut like on an erase
+	sound_store_cut(p_value[0]);
+	return COMMAND_RESULT_OK;
+}
+
+/**@brief Function for running CMD_CLIP_END.
+ */
+static command_result_t cmd_clip_end(uint16_t conn_handle, uint8_t const * p_value, uint8_t length)
+{
+	// no event follows when no upload is under way
+	return (clip_store_end() == NRF_SUCCESS) ? COMMAND_RESULT_OK : COMMAND_RESULT_REFUSED;
+}
+
+/**@brief Function for running CMD_CLIP_ERASE.
+ */
+static command_result_t cmd_clip_erase(uint16_t conn_handle, uint8_t const * p_value, uint8_t length)
+{
+	ret_code_t err_code;
+
+	// uploaded clips play straight from flash: the store forgets them and their voices are cut with
+	// the player interrupt masked, so no buffer is rendered from a page being erased
+	CRITICAL_REGION_ENTER();
+	err_code = clip_store_erase();
+	if (err_code == NRF_SUCCESS)
+	{
+		sound_store_cut(SOUND_CLIP_NONE);
+	}
+	CRITICAL_REGION_EXIT();
+
+	return (err_code == NRF_SUCCESS) ? COMMAND_RESULT_OK : COMMAND_RESULT_REFUSED;
+}
+
+/**@brief Command dispatch table, the value lengths leave out the opcode.
+ */
+static const command_t m_commands[] =
+{
+	{ CMD_SOUND_MASTER_GAIN, 2,  cmd_sound_master_gain },
+	{ CMD_SOUND_VOICE_GAIN,  3,  cmd_sound_voice_gain  },
+	{ CMD_SOUND_STATS,       0,  cmd_sound_stats       },
+	{ CMD_SOUND_PLAY,        1,  cmd_sound_play        },
+	{ CMD_SOUND_EQ,          1,  cmd_sound_eq          },
+	{ CMD_SOUND_LIMITER,     5,  cmd_sound_limiter     },
+	{ CMD_SOUND_RELEASE,     0,  cmd_sound_release     },
+	{ CMD_SOUND_PREARM,      1,  cmd_sound_prearm      },
+	{ CMD_SOUND_CONDITION,   1,  cmd_sound_condition   },
+	{ CMD_SOUND_TONE,        13, cmd_sound_tone        },
+	{ CMD_SOUND_PATTERN,     0,  cmd_sound_pattern     },
+	{ CMD_SOUND_STREAM,      2,  cmd_sound_stream      },
+	{ CMD_CLIP_BEGIN,        9,  cmd_clip_begin        },
+	{ CMD_CLIP_END,          0,  cmd_clip_end          },
+	{ CMD_CLIP_ERASE,        0,  cmd_clip_erase        },
+	{ CMD_GESTURE_RULE,      9,  cmd_gesture_rule      },
+	{ CMD_GESTURE_CONFIG,    8,  cmd_gesture_config    },
+	{ CMD_ACEL_FORMAT,       1,  cmd_acel_format       },
+	{ CMD_ACEL_BURST,        2,  cmd_acel_burst        },
+	{ CMD_LINK_BENCH,        2,  cmd_link_bench        },
+	{ CMD_BEACON,            1,  cmd_beacon            },
+	{ CMD_BROADCAST,         1,  cmd_broadcast         },
+};
+
+/**@brief Function for sending the acknowledgement of a command frame, to the client that wrote it.
+ *
+ * @param[in]   conn_handle   Client.
+ * @param[in]   p_ack         Acknowledgement.
+ */
+static void command_ack_send(uint16_t conn_handle, command_ack_t const * p_ack)
+{
+	ret_code_t err_code;
+	uint8_t    status[SOUND_STATUS_CHAR_LEN] = { SOUND_STATUS_COMMAND };
+
+	status[1] = p_ack->sequence;
+	status[2] = p_ack->count;
+	status[3] = p_ack->failed;
+	memcpy(&status[4], p_ack->results, COMMAND_ACK_RESULTS);
+
+	err_code = sound_status_reply(&m_acel_cus, conn_handle, status, SOUND_STATUS_CHAR_LEN);
+	if ((err_code != NRF_ERROR_INVALID_STATE) &&
+	    (err_code != NRF_ERROR_RESOURCES) &&
+	    (err_code != BLE_ERROR_GATTS_SYS_ATTR_MISSING))
+	{
+		APP_ERROR_CHECK(err_code);
+	}
+}
+
+/**@brief Function for handling the clip store events.
+ *
+ * @details Called from the SoftDevice event context, every event is sent on the sound status
+ *          characteristic so the client can resend from the offset the store expects.
+ *
+ * @param[in]   p_evt   Clip store event.
+ */
+static void on_clip_store_evt(clip_store_evt_t const * p_evt)
+{
+	uint8_t    status[SOUND_STATUS_CHAR_LEN] = { SOUND_STATUS_CLIP };
+
+	status[1] = p_evt->evt_type;
+	status[2] = p_evt->clip_id;
+	uint32_encode(p_evt->offset, &status[4]);
+	uint32_encode(p_evt->error, &status[8]);
+	uint32_encode(p_evt->free, &status[12]);
+	sound_status_send(status);
+}
+
+/**@brief Function for handling the L2CAP channel events.
+ *
+ * @details Called from the SoftDevice event context. An open channel puts its connection in the
+ *          streaming profile. SDUs from the central are clip upload blocks, as on the command
+ *          characteristic but up to L2CAP_CHANNEL_SDU_MAX long, answered on the sound status
+ *          characteristic.
+ *
+ * @param[in]   p_evt   Channel event.
+ */
+static void on_l2cap_evt(l2cap_channel_evt_t const * p_evt)
+{
+	link_ctx_t * p_link = link_find(p_evt->conn_handle);
+
+	switch (p_evt->evt_type)
+	{
+	case L2CAP_CHANNEL_EVT_OPENED:
+	case L2CAP_CHANNEL_EVT_CLOSED:
+		if (p_link != NULL)
+		{
+			p_link->l2cap_open = (p_evt->evt_type == L2CAP_CHANNEL_EVT_OPENED);
+			conn_profile_update(p_link);
+		}
+		break;
+
+	case L2CAP_CHANNEL_EVT_RX:
+		(void)clip_store_block_put(p_evt->p_data, p_evt->length);
+		break;
+
+	default:
+		break;
+	}
+}
+
+/**@brief Function for handling a gesture rule match.
+ *
+ * @details Called from the main loop through gesture_process(). The sound is started first, the
+ *          client is told afterwards.
+ *
+ * @param[in]   index    Rule slot.
+ * @param[in]   p_rule   Rule.
+ * @param[in]   gain     Gain for the action, q15.
+ */
+static void on_gesture(uint8_t index, gesture_rule_t const * p_rule, uint16_t gain)
+{
+	uint8_t    status[SOUND_STATUS_CHAR_LEN] = { SOUND_STATUS_GESTURE };
+
+	switch (p_rule->action)
+	{
+	case GESTURE_ACTION_PLAY:
+		sound_play(p_rule->clip_id);
+		break;
+
+	case GESTURE_ACTION_HIT:
+		sound_hit(p_rule->clip_id, gain);
+		break;
+
+	case GESTURE_ACTION_STOP:
+		sound_stop();
+		break;
+
+	default:
+		break;
+	}
+
+	m_gesture_rules_run++;
+
+	status[1] = p_rule->event;
+	status[2] = index;
+	status[3] = p_rule->clip_id;
+	uint16_encode(gain, &status[4]);
+	status[6] = p_rule->action;
+	uint32_encode(app_timer_cnt_get(), &status[8]);
+	sound_status_send(status);
+}
+
+/**@brief Function for reading one accelerometer sample and running the gesture rules on it.
+ *
+ * @details Called from the main loop, which the gesture timer wakes up.
+ */
+static void gesture_sample_process(void)
+{
+	int16_t  accel[3];
+	uint32_t latency;
+	uint32_t time;
+
+	if (!m_gesture_due)
+	{
+		return;
+	}
+	m_gesture_due = false;
+
+	BMA280_Get_Accel(accel);
+	if (m_acel_wake_skip > 0)
+	{
+		m_acel_wake_skip--;
+		return;
+	}
+	time = device_ticks_at(m_gesture_tick) * ACEL_STREAM_TICK_SCALE;
+	gesture_process(accel);
+	acel_sample_put(accel, time);
+	acel_burst_put(accel, time);
+	beacon_sample_put(accel);
+	broadcast_sample_put(accel);
+
+	latency = (uint32_t)(((uint64_t)app_timer_cnt_diff_compute(app_timer_cnt_get(), m_gesture_tick) * 1000000) / APP_TIMER_CLOCK_FREQ);
+	m_gesture_latency_max = MAX(m_gesture_latency_max, latency);
+	if (latency > GESTURE_SAMPLE_PERIOD_US)
+	{
+		m_gesture_latency_misses++;
+	}
+}
+
+/**@brief Function for starting and stopping the accelerometer with its consumers.
+ *
+ * @details The BMA280 is sampled while a gesture rule is set, the client listens to the
+ *          accelerometer, a burst is under way, the beacon or the broadcast is on. Without any of
+ *          them it is suspended and its timer stopped, so the device does no sensor, encoding or
+ *          radio work for samples nobody uses. Runs in the main loop, where the TWI can be used,
+ *          and picks up subscriptions as soon as the BLE event has woken it.
+ */
+static void acel_acquisition_process(void)
+{
+	ret_code_t err_code;
+	bool       wanted = gesture_rules_active() || acel_listened() || (m_burst_remaining > 0) || m_beacon_on || m_broadcast_on;
 
-	APP_ERROR_CHECK(err_code);
+	if (wanted == m_acel_acquiring)
+	{
+		return;
+	}
+	m_acel_acquiring = wanted;
 
-	/* YOUR_JOB: Create any timers to be used by the application.
-	             Below is an example of how to create a timer.
-	             For every new timer needed, increase the value of the macro APP_TIMER_MAX_TIMERS by
-	             one.
-	      ret_code_t err_code;
-	      err_code = app_timer_create(&m_app_timer_id, APP_TIMER_MODE_REPEATED, timer_timeout_handler);
-	      APP_ERROR_CHECK(err_code); */
+	if (wanted)
+	{
+		BMA280_Wake();
+		m_acel_wake_skip = ACEL_WAKE_SAMPLES;
+		gesture_resume();
+		err_code = app_timer_start(m_gesture_timer_id, GESTURE_SAMPLE_INTERVAL, NULL);
+		APP_ERROR_CHECK(err_code);
+	}
+	else
+	{
+		err_code = app_timer_stop(m_gesture_timer_id);
+		APP_ERROR_CHECK(err_code);
+		m_gesture_due = false;
+		BMA280_Turn_Off();
+		acel_frame_reset();
+	}
+	NRF_LOG_INFO("Accelerometer %s.", wanted ? "sampling" : "suspended");
 }
 
-
-/**@brief Function for the GAP initialization.
+/**@brief Function for running the link bench, see link_bench_t.
  *
- * @details This function sets up all the necessary GAP (Generic Access Profile) parameters of the
- *          device including the device name, appearance, and the preferred connection parameters.
+ * @details Called from the main loop. Sends until the stack has no room left, the TX complete
+ *          event wakes the loop up for more. The result goes to the writer of CMD_LINK_BENCH, also
+ *          when the path closed before the end.
  */
-static void gap_params_init(void)
+static void link_bench_process(void)
 {
-	ret_code_t              err_code;
-	ble_gap_conn_params_t   gap_conn_params;
-	ble_gap_conn_sec_mode_t sec_mode;
-
-	BLE_GAP_CONN_SEC_MODE_SET_OPEN(&sec_mode);
+	uint16_t     conn_handle = m_bench.conn_handle;
+	link_ctx_t * p_link;
+	ret_code_t   err_code = NRF_SUCCESS;
+	uint32_t     elapsed;
+	uint8_t      status[SOUND_STATUS_CHAR_LEN] = { SOUND_STATUS_BENCH };
 
-	err_code = sd_ble_gap_device_name_set(&sec_mode,
-		(const uint8_t *)DEVICE_NAME,
-		strlen(DEVICE_NAME));
-	APP_ERROR_CHECK(err_code);
+	if (conn_handle == BLE_CONN_HANDLE_INVALID)
+	{
+		return;
+	}
 
-	/* YOUR_JOB: Use an appearance value matching the application's use case.
-	   err_code = sd_ble_gap_appearance_set(BLE_APPEARANCE_);
-	   APP_ERROR_CHECK(err_code); */
+	p_link  = link_find(conn_handle);
+	elapsed = app_timer_cnt_diff_compute(app_timer_cnt_get(), m_bench.start);
+	while ((p_link != NULL) && (err_code == NRF_SUCCESS) && (elapsed < m_bench.duration))
+	{
+		uint32_t start = DWT->CYCCNT;
+		uint16_t length;
 
-	memset(&gap_conn_params, 0, sizeof(gap_conn_params));
+		if (m_bench.path == LINK_BENCH_PATH_L2CAP)
+		{
+			length   = l2cap_channel_sdu_max_get(conn_handle);
+			err_code = l2cap_channel_send(conn_handle, m_bench_data, length);
+		}
+		else
+		{
+			length   = p_link->payload;
+			err_code = acelerometer_value_update(&m_acel_cus, conn_handle, m_bench_data, length);
+		}
+		m_bench.cycles += DWT->CYCCNT - start;
 
-	gap_conn_params.min_conn_interval = MIN_CONN_INTERVAL;
-	gap_conn_params.max_conn_interval = MAX_CONN_INTERVAL;
-	gap_conn_params.slave_latency     = SLAVE_LATENCY;
-	gap_conn_params.conn_sup_timeout  = CONN_SUP_TIMEOUT;
+		if (err_code == NRF_SUCCESS)
+		{
+			m_bench.bytes += length;
+		}
+		elapsed = app_timer_cnt_diff_compute(app_timer_cnt_get(), m_bench.start);
+	}
 
-	err_code = sd_ble_gap_ppcp_set(&gap_conn_params);
-	APP_ERROR_CHECK(err_code);
-}
+	if ((err_code == NRF_ERROR_RESOURCES) && (elapsed < m_bench.duration))
+	{
+		return;
+	}
 
+	status[1] = m_bench.path;
+	uint32_encode(m_bench.bytes, &status[4]);
+	uint32_encode((uint32_t)(((uint64_t)elapsed * 1000) / APP_TIMER_CLOCK_FREQ), &status[8]);
+	uint32_encode((m_bench.bytes > 0) ? (uint32_t)(((uint64_t)m_bench.cycles * 1024) / m_bench.bytes) : 0, &status[12]);
+	m_bench.conn_handle = BLE_CONN_HANDLE_INVALID;
 
-/**@brief Function for initializing the GATT module.
- */
-static void gatt_init(void)
-{
-	ret_code_t err_code = nrf_ble_gatt_init(&m_gatt, NULL);
-	APP_ERROR_CHECK(err_code);
+	err_code = sound_status_reply(&m_acel_cus, conn_handle, status, SOUND_STATUS_CHAR_LEN);
+	if ((err_code != NRF_ERROR_INVALID_STATE) &&
+	    (err_code != NRF_ERROR_RESOURCES) &&
+	    (err_code != BLE_ERROR_GATTS_SYS_ATTR_MISSING))
+	{
+		APP_ERROR_CHECK(err_code);
+	}
+	NRF_LOG_INFO("Bench path %d: %u bytes in %u ms.", status[1], m_bench.bytes, uint32_decode(&status[8]));
 }
 
-
-/**@brief Function for handling Queued Write Module errors.
+/**@brief Function for handling the sound player events.
  *
- * @details A pointer to this function will be passed to each service which may need to inform the
- *          application about an error.
+ * @details Called from the main loop through sound_process(). Every event is sent on the sound
+ *          status characteristic so the client knows when a clip started, finished or underran.
  *
- * @param[in]   nrf_error   Error code containing information about what went wrong.
+ * @param[in]   p_evt   Player event.
  */
-static void nrf_qwr_error_handler(uint32_t nrf_error)
+static void on_sound_evt(sound_evt_t const * p_evt)
 {
-	APP_ERROR_HANDLER(nrf_error);
-}
+	uint8_t    status[SOUND_STATUS_CHAR_LEN];
 
-/** @ brief Function for handling the commands on the Neopixel controller service ..
- *
- * @ param[in]   commands   Array of data sent by the Neocontroller mobile app to update the Neopixel state.
- * @ param[in]   lenght     The lenght of that array in bytes.
- */
-static void command_handler(uint8_t const * commands, uint16_t  lenght)
-{
-	ret_code_t   err_code;
+	status[0] = p_evt->evt_type;
+	status[1] = p_evt->state;
+	status[2] = p_evt->clip_id;
+	status[3] = p_evt->voice;
+	uint32_encode(p_evt->sample_time, &status[4]);
+	uint32_encode(p_evt->duration, &status[8]);
+	uint32_encode(p_evt->timestamp, &status[12]);
 
-#if UART_PRINTING_ENABLED
-	for (uint8_t i = 0; i < lenght; i++)
+	if ((p_evt->evt_type == SOUND_EVT_FINISHED) || (p_evt->evt_type == SOUND_EVT_STOPPED))
 	{
-		NRF_LOG_INFO("commands[%d] = %d;", i, commands[i]);
-	}  
-#endif
+		if (p_evt->clip_id == SOUND_CLIP_CUICA)
+		{
+			bsp_board_led_off(BSP_BOARD_LED_2);
+		}
+		else if (p_evt->clip_id == SOUND_CLIP_CLAVES)
+		{
+			bsp_board_led_off(BSP_BOARD_LED_3);
+		}
+	}
 
-	// you can excute functions based on the command you receive here.
+	sound_status_send(status);
 }
 
 /**@brief Function for handling the Neocontroller Service events.
@@ -214,20 +1500,60 @@ static void command_handler(uint8_t const * commands, uint16_t  lenght)
 static void on_cus_evt(ble_cus_t  * p_cus_service, ble_cus_evt_t * p_evt)
 {
 	ret_code_t   err_code;
+	link_ctx_t * p_link;
 
 	switch (p_evt->evt_type)
 	{
 	case BLE_CUS_EVT_CONNECTED:
+		(void)link_open(p_evt->conn_handle);
 		break;
 
 	case BLE_CUS_EVT_DISCONNECTED:
+		link_close(p_evt->conn_handle);
+		break;
+
+	case BLE_TEMP_NOTIFICATION_ENABLED:
+	case BLE_TEMP_NOTIFICATION_DISABLED:
+		p_link = link_find(p_evt->conn_handle);
+		if (p_link == NULL)
+		{
+			break;
+		}
+
+		// the link sends the frames encoded from now on, at the smallest MTU of the subscribed links
+		p_link->acel_notify = (p_evt->evt_type == BLE_TEMP_NOTIFICATION_ENABLED);
+		if (p_link->acel_notify)
+		{
+			(void)notify_queue_link_add(p_link->conn_handle);
+		}
+		else
+		{
+			notify_queue_link_remove(p_link->conn_handle);
+		}
+		acel_frame_max_update();
+		conn_profile_update(p_link);
 		break;
 
 	case BLE_CUS_EVT_COMMAND_RX:
 #if UART_PRINTING_ENABLED
 		NRF_LOG_INFO("command rerceived!");
 #endif
-		command_handler(p_evt->params_command.command_data.p_data, p_evt->params_command.command_data.length);
+		// the one byte sound trigger of the first app, see set_play_sound_condition()
+		if ((p_evt->params_command.command_data.length == 1) &&
+		    (p_evt->params_command.command_data.p_data[0] <= 0x02))
+		{
+			set_play_sound_condition(p_evt->params_command.command_data.p_data[0]);
+			break;
+		}
+		command_write(p_evt->conn_handle, p_evt->params_command.command_data.p_data, p_evt->params_command.command_data.length);
+		break;
+
+	case BLE_CUS_EVT_AUDIO_RX:
+		(void)sound_stream_frame_put(p_evt->params_command.command_data.p_data, p_evt->params_command.command_data.length);
+		break;
+
+	case BLE_CUS_EVT_CLIP_RX:
+		(void)clip_store_block_put(p_evt->params_command.command_data.p_data, p_evt->params_command.command_data.length);
 		break;
 
 	default:
@@ -316,12 +1642,16 @@ static void services_init(void)
 {
 	ret_code_t         err_code;
 	nrf_ble_qwr_init_t qwr_init = { 0 };
+	uint8_t            i;
 
-	// Initialize Queued Write Module.
+	// Initialize Queued Write Module, an instance per link.
 	qwr_init.error_handler = nrf_qwr_error_handler;
 
-	err_code = nrf_ble_qwr_init(&m_qwr, &qwr_init);
-	APP_ERROR_CHECK(err_code);
+	for (i = 0; i < NRF_SDH_BLE_PERIPHERAL_LINK_COUNT; i++)
+	{
+		err_code = nrf_ble_qwr_init(&m_qwr[i], &qwr_init);
+		APP_ERROR_CHECK(err_code);
+	}
 
 	cus_service_init();
 
@@ -379,7 +1709,15 @@ static void on_conn_params_evt(ble_conn_params_evt_t * p_evt)
 
 	if (p_evt->evt_type == BLE_CONN_PARAMS_EVT_FAILED)
 	{
-		err_code = sd_ble_gap_disconnect(m_conn_handle, BLE_HCI_CONN_INTERVAL_UNACCEPTABLE);
+		link_ctx_t * p_link = link_find(p_evt->conn_handle);
+
+		// a central that will not stream at 15 ms streams at what it gave
+		if ((p_link != NULL) && (p_link->profile == CONN_PROFILE_STREAMING))
+		{
+			NRF_LOG_INFO("Streaming connection interval refused.");
+			return;
+		}
+		err_code = sd_ble_gap_disconnect(p_evt->conn_handle, BLE_HCI_CONN_INTERVAL_UNACCEPTABLE);
 		APP_ERROR_CHECK(err_code);
 	}
 }
@@ -454,12 +1792,21 @@ static void on_adv_evt(ble_adv_evt_t ble_adv_evt)
 #if UART_PRINTING_ENABLED
 		NRF_LOG_INFO("Fast advertising started.");
 #endif
-		err_code = bsp_indication_set(BSP_INDICATE_ADVERTISING);
-		APP_ERROR_CHECK(err_code);
+		m_adv_on = true;
+		if (ble_conn_state_peripheral_conn_count() == 0)
+		{
+			err_code = bsp_indication_set(BSP_INDICATE_ADVERTISING);
+			APP_ERROR_CHECK(err_code);
+		}
 		break;
 
 	case BLE_ADV_EVT_IDLE:
-		sleep_mode_enter();
+		// the clients connected keep the device up, a disconnection advertises again
+		m_adv_on = false;
+		if (ble_conn_state_peripheral_conn_count() == 0)
+		{
+			sleep_mode_enter();
+		}
 		break;
 
 	default:
@@ -468,6 +1815,28 @@ static void on_adv_evt(ble_adv_evt_t ble_adv_evt)
 }
 
 
+/**@brief Function for advertising again while a peripheral link is free.
+ *
+ * @details Called on connection and disconnection, the Advertising module itself only restarts on
+ *          the disconnection of the last link it connected. Not while the broadcast holds the set.
+ */
+static void advertising_resume(void)
+{
+	ret_code_t err_code;
+
+	if (m_adv_on || m_broadcast_on || (ble_conn_state_peripheral_conn_count() >= NRF_SDH_BLE_PERIPHERAL_LINK_COUNT))
+	{
+		return;
+	}
+
+	err_code = ble_advertising_start(&m_advertising, BLE_ADV_MODE_FAST);
+	if (err_code != NRF_ERROR_INVALID_STATE)
+	{
+		APP_ERROR_CHECK(err_code);
+	}
+}
+
+
 /**@brief Function for starting timers.
  */
 static void application_timers_start(void)
@@ -477,6 +1846,9 @@ static void application_timers_start(void)
 	//Start application timers
 
 	err_code = app_timer_start(m_ecelerometr_timer_id, ACELEROMETR_MEAS_INTERVAL, NULL);
+	APP_ERROR_CHECK(err_code);
+
+	// the gesture sample timer runs with the accelerometer, see acel_acquisition_process()
 	/* YOUR_JOB: Start your timers. below is an example of how to start a timer.
 	   ret_code_t err_code;
 	   err_code = app_timer_start(m_app_timer_id, TIMER_INTERVAL, NULL);
@@ -492,22 +1864,40 @@ static void application_timers_start(void)
  */
 static void ble_evt_handler(ble_evt_t const * p_ble_evt, void * p_context)
 {
-	ret_code_t err_code = NRF_SUCCESS;
+	ret_code_t   err_code = NRF_SUCCESS;
+	link_ctx_t * p_link;
 
 	switch (p_ble_evt->header.evt_id)
 	{
 	case BLE_GAP_EVT_DISCONNECTED:
-		NRF_LOG_INFO("Disconnected.");
+		NRF_LOG_INFO("Disconnected 0x%x.", p_ble_evt->evt.gap_evt.conn_handle);
+		// the link table entry was freed on the service event, see link_close()
 		// LED indication will be changed when advertising starts.
+		advertising_resume();
 		break;
 
 	case BLE_GAP_EVT_CONNECTED:
-		NRF_LOG_INFO("Connected.");
+		NRF_LOG_INFO("Connected 0x%x.", p_ble_evt->evt.gap_evt.conn_handle);
 		err_code = bsp_indication_set(BSP_INDICATE_CONNECTED);
 		APP_ERROR_CHECK(err_code);
-		m_conn_handle = p_ble_evt->evt.gap_evt.conn_handle;
-		err_code = nrf_ble_qwr_conn_handle_assign(&m_qwr, m_conn_handle);
-		APP_ERROR_CHECK(err_code);
+		p_link = link_open(p_ble_evt->evt.gap_evt.conn_handle);
+		if (p_link != NULL)
+		{
+			err_code = nrf_ble_qwr_conn_handle_assign(&m_qwr[p_link - m_links], p_link->conn_handle);
+			APP_ERROR_CHECK(err_code);
+		}
+		// a connection ends connectable advertising, go on while links are free
+		m_adv_on = false;
+		advertising_resume();
+		break;
+
+	case BLE_GAP_EVT_PHY_UPDATE:
+		p_link = link_find(p_ble_evt->evt.gap_evt.conn_handle);
+		if ((p_link != NULL) && (p_ble_evt->evt.gap_evt.params.phy_update.status == BLE_HCI_STATUS_CODE_SUCCESS))
+		{
+			p_link->tx_phy = p_ble_evt->evt.gap_evt.params.phy_update.tx_phy;
+			NRF_LOG_INFO("Connection 0x%x PHY %u.", p_link->conn_handle, p_link->tx_phy);
+		}
 		break;
 
 	case BLE_GAP_EVT_PHY_UPDATE_REQUEST:
@@ -538,6 +1928,19 @@ static void ble_evt_handler(ble_evt_t const * p_ble_evt, void * p_context)
 		APP_ERROR_CHECK(err_code);
 		break;
 
+	case BLE_GAP_EVT_CONN_PARAM_UPDATE:
+		p_link = link_find(p_ble_evt->evt.gap_evt.conn_handle);
+		if ((p_link != NULL) && p_link->profile_pending)
+		{
+			conn_profile_update(p_link);
+		}
+		break;
+
+	case BLE_GATTS_EVT_HVN_TX_COMPLETE:
+		// the packets of the connection event are out, refill the slots of that connection
+		notify_queue_send(p_ble_evt->evt.gatts_evt.conn_handle);
+		break;
+
 //	case BLE_GATTS_EVT_WRITE:
 //		break;
 	default:
@@ -564,10 +1967,36 @@ static void ble_stack_init(void)
 	err_code = nrf_sdh_ble_default_cfg_set(APP_BLE_CONN_CFG_TAG, &ram_start);
 	APP_ERROR_CHECK(err_code);
 
+	// Room for several notifications per connection event instead of the default one.
+	ble_cfg_t ble_cfg;
+	memset(&ble_cfg, 0, sizeof(ble_cfg));
+	ble_cfg.conn_cfg.conn_cfg_tag                            = APP_BLE_CONN_CFG_TAG;
+	ble_cfg.conn_cfg.params.gatts_conn_cfg.hvn_tx_queue_size = APP_HVN_TX_QUEUE_SIZE;
+	err_code = sd_ble_cfg_set(BLE_CONN_CFG_GATTS, &ble_cfg, ram_start);
+	APP_ERROR_CHECK(err_code);
+
+	// One L2CAP channel per connection for the bulk transfers, see l2cap_channel.h.
+	memset(&ble_cfg, 0, sizeof(ble_cfg));
+	ble_cfg.conn_cfg.conn_cfg_tag                        = APP_BLE_CONN_CFG_TAG;
+	ble_cfg.conn_cfg.params.l2cap_conn_cfg.rx_mps        = L2CAP_CHANNEL_MPS;
+	ble_cfg.conn_cfg.params.l2cap_conn_cfg.tx_mps        = L2CAP_CHANNEL_MPS;
+	ble_cfg.conn_cfg.params.l2cap_conn_cfg.rx_queue_size = 1;
+	ble_cfg.conn_cfg.params.l2cap_conn_cfg.tx_queue_size = L2CAP_CHANNEL_TX_SDUS;
+	ble_cfg.conn_cfg.params.l2cap_conn_cfg.ch_count      = 1;
+	err_code = sd_ble_cfg_set(BLE_CONN_CFG_L2CAP, &ble_cfg, ram_start);
+	APP_ERROR_CHECK(err_code);
+
 	// Enable BLE stack.
 	err_code = nrf_sdh_ble_enable(&ram_start);
 	APP_ERROR_CHECK(err_code);
 
+	// Let a connection event run on while there is data, up to the event length.
+	ble_opt_t ble_opt;
+	memset(&ble_opt, 0, sizeof(ble_opt));
+	ble_opt.common_opt.conn_evt_ext.enable = 1;
+	err_code = sd_ble_opt_set(BLE_COMMON_OPT_CONN_EVT_EXT, &ble_opt);
+	APP_ERROR_CHECK(err_code);
+
 	// Register a handler for BLE events.
 	NRF_SDH_BLE_OBSERVER(m_ble_observer, APP_BLE_OBSERVER_PRIO, ble_evt_handler, NULL);
 }
@@ -635,16 +2064,11 @@ static void bsp_event_handler(bsp_event_t event)
 		break; // BSP_EVENT_SLEEP
 
 case BSP_EVENT_DISCONNECT :
-    err_code = sd_ble_gap_disconnect(m_conn_handle,
-			BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION);
-		if (err_code != NRF_ERROR_INVALID_STATE)
-		{
-			APP_ERROR_CHECK(err_code);
-		}
+    disconnect();
 		break; // BSP_EVENT_DISCONNECT
 
 case BSP_EVENT_WHITELIST_OFF :
-    if(m_conn_handle == BLE_CONN_HANDLE_INVALID)
+    if(ble_conn_state_peripheral_conn_count() < NRF_SDH_BLE_PERIPHERAL_LINK_COUNT)
 		{
 			err_code = ble_advertising_restart_without_whitelist(&m_advertising);
 			if (err_code != NRF_ERROR_INVALID_STATE)
@@ -660,6 +2084,52 @@ default :
 }
 
 
+/**@brief Function for building the advertising and scan response data.
+ *
+ * @details The beacon summary takes the room of the name in the advertising packet, 30 of the 31
+ *          bytes, the name goes to the scan response then.
+ *
+ * @param[out]  p_advdata   Advertising data.
+ * @param[out]  p_srdata    Scan response data.
+ * @param[in]   p_manuf     Beacon summary, NULL without.
+ */
+static void advdata_build(ble_advdata_t * p_advdata, ble_advdata_t * p_srdata, ble_advdata_manuf_data_t * p_manuf)
+{
+	memset(p_advdata, 0, sizeof(*p_advdata));
+	memset(p_srdata, 0, sizeof(*p_srdata));
+
+	p_advdata->include_appearance      = true;
+	p_advdata->flags                   = BLE_GAP_ADV_FLAGS_LE_ONLY_GENERAL_DISC_MODE;
+	p_advdata->uuids_complete.uuid_cnt = sizeof(m_adv_uuids) / sizeof(m_adv_uuids[0]);
+	p_advdata->uuids_complete.p_uuids  = m_adv_uuids;
+
+	if (p_manuf == NULL)
+	{
+		p_advdata->name_type = BLE_ADVDATA_FULL_NAME;
+		return;
+	}
+
+	p_advdata->p_manuf_specific_data = p_manuf;
+	p_srdata->name_type              = BLE_ADVDATA_FULL_NAME;
+}
+
+/**@brief Function for the advertising modes, fast advertising only.
+ *
+ * @param[out]  p_config   Modes.
+ * @param[in]   beacon     Without timeout, for the scanners of the beacon.
+ */
+static void adv_modes_config_get(ble_adv_modes_config_t * p_config, bool beacon)
+{
+	memset(p_config, 0, sizeof(*p_config));
+
+	p_config->ble_adv_fast_enabled  = true;
+	p_config->ble_adv_fast_interval = APP_ADV_INTERVAL;
+	p_config->ble_adv_fast_timeout  = beacon ? 0 : APP_ADV_DURATION;
+
+	// restarted by advertising_resume() while a link is free
+	p_config->ble_adv_on_disconnect_disabled = true;
+}
+
 /**@brief Function for initializing the Advertising functionality.
  */
 static void advertising_init(void)
@@ -669,15 +2139,8 @@ static void advertising_init(void)
 
 	memset(&init, 0, sizeof(init));
 
-	init.advdata.name_type               = BLE_ADVDATA_FULL_NAME;
-	init.advdata.include_appearance      = true;
-	init.advdata.flags                   = BLE_GAP_ADV_FLAGS_LE_ONLY_GENERAL_DISC_MODE;
-	init.advdata.uuids_complete.uuid_cnt = sizeof(m_adv_uuids) / sizeof(m_adv_uuids[0]);
-	init.advdata.uuids_complete.p_uuids  = m_adv_uuids;
-
-	init.config.ble_adv_fast_enabled  = true;
-	init.config.ble_adv_fast_interval = APP_ADV_INTERVAL;
-	init.config.ble_adv_fast_timeout  = APP_ADV_DURATION;
+	advdata_build(&init.advdata, &init.srdata, NULL);
+	adv_modes_config_get(&init.config, false);
 
 	init.evt_handler = on_adv_evt;
 
@@ -687,16 +2150,142 @@ static void advertising_init(void)
 	ble_advertising_conn_cfg_tag_set(&m_advertising, APP_BLE_CONN_CFG_TAG);
 }
 
-/** @ brief Function for disconnecting.
+/**@brief Function for putting the sensor summary in the advertising data, see beacon.h.
+ *
+ * @details Called from the main loop, every second and when the beacon is switched. The data goes to
+ *          the advertising set through the other encoding buffer of the Advertising module, so the
+ *          advertising runs on without a restart. Switching the beacon restarts it once, with or
+ *          without the timeout.
+ */
+static void beacon_process(void)
+{
+	ble_adv_modes_config_t   config;
+	ble_advdata_t            advdata;
+	ble_advdata_t            srdata;
+	ble_advdata_manuf_data_t manuf;
+	uint8_t                  data[BEACON_DATA_LEN];
+	uint8_t                  flags  = 0;
+	bool                     beacon = m_beacon_on;
+	ret_code_t               err_code;
+
+	if (!m_beacon_due)
+	{
+		return;
+	}
+	m_beacon_due = false;
+
+	if ((!beacon && !m_beacon_shown) || m_broadcast_on)
+	{
+		// the broadcast holds the advertising set, the beacon comes back after it
+		return;
+	}
+
+	if (beacon)
+	{
+		if (sound_state_get() != SOUND_STATE_IDLE)
+		{
+			flags |= BEACON_FLAG_SOUND;
+		}
+		if (ble_conn_state_peripheral_conn_count() < NRF_SDH_BLE_PERIPHERAL_LINK_COUNT)
+		{
+			flags |= BEACON_FLAG_CONNECTABLE;
+		}
+		beacon_encode(flags, data);
+
+		manuf.company_identifier = BEACON_COMPANY_ID;
+		manuf.data.p_data        = data;
+		manuf.data.size          = BEACON_DATA_LEN;
+	}
+
+	advdata_build(&advdata, &srdata, beacon ? &manuf : NULL);
+	err_code = ble_advertising_advdata_update(&m_advertising, &advdata, &srdata);
+	if (err_code != NRF_ERROR_INVALID_STATE)
+	{
+		APP_ERROR_CHECK(err_code);
+	}
+
+	if (beacon == m_beacon_shown)
+	{
+		return;
+	}
+	m_beacon_shown = beacon;
+
+	adv_modes_config_get(&config, beacon);
+	ble_advertising_modes_config_set(&m_advertising, &config);
+	if (m_adv_on)
+	{
+		// the timeout of the running advertising was set when it started
+		(void)sd_ble_gap_adv_stop(m_advertising.adv_handle);
+		m_adv_on = false;
+	}
+	advertising_resume();
+	NRF_LOG_INFO("Beacon %s.", beacon ? "on" : "off");
+}
+
+/**@brief Function for switching the advertising set between the connectable advertising and the broadcast.
+ *
+ * @details Called from the main loop. The S140 has a single advertising set: the broadcast stops the
+ *          connectable advertising and configures the set for extended advertising, the Advertising
+ *          module configures it back on its next start. The connected clients stay connected.
+ */
+static void broadcast_process(void)
+{
+	broadcast_stats_t stats;
+	bool              on = m_broadcast_on;
+	ret_code_t        err_code;
+
+	broadcast_stats_get(&stats);
+	if (on == stats.on)
+	{
+		return;
+	}
+
+	if (on)
+	{
+		if (m_adv_on)
+		{
+			(void)sd_ble_gap_adv_stop(m_advertising.adv_handle);
+			m_adv_on = false;
+		}
+
+		err_code = broadcast_start(&m_advertising.adv_handle);
+		if (err_code == NRF_SUCCESS)
+		{
+			NRF_LOG_INFO("Broadcasting, %u samples per batch.", BROADCAST_SAMPLES);
+			return;
+		}
+		NRF_LOG_WARNING("Broadcast not started, error %u", err_code);
+		m_broadcast_on = false;
+	}
+	else
+	{
+		broadcast_stop();
+		NRF_LOG_INFO("Broadcast stopped.");
+	}
+
+	m_beacon_due = true;
+	advertising_resume();
+}
+
+/** @ brief Function for disconnecting every client.
 */
 static void disconnect()
 {
 	ret_code_t  err_code;
+	uint8_t     i;
 
-	err_code = sd_ble_gap_disconnect(m_conn_handle, BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION);
-	if (err_code != NRF_ERROR_INVALID_STATE)
+	for (i = 0; i < NRF_SDH_BLE_PERIPHERAL_LINK_COUNT; i++)
 	{
-		APP_ERROR_CHECK(err_code);
+		if (m_links[i].conn_handle == BLE_CONN_HANDLE_INVALID)
+		{
+			continue;
+		}
+
+		err_code = sd_ble_gap_disconnect(m_links[i].conn_handle, BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION);
+		if (err_code != NRF_ERROR_INVALID_STATE)
+		{
+			APP_ERROR_CHECK(err_code);
+		}
 	}
 }
 
@@ -706,7 +2295,7 @@ static void adv_restart_without_whitelist()
 {
 	ret_code_t  err_code;
 
-	if (m_conn_handle == BLE_CONN_HANDLE_INVALID)
+	if (!m_broadcast_on && (ble_conn_state_peripheral_conn_count() < NRF_SDH_BLE_PERIPHERAL_LINK_COUNT))
 	{
 		err_code = ble_advertising_restart_without_whitelist(&m_advertising);
 		if (err_code != NRF_ERROR_INVALID_STATE)
@@ -773,7 +2362,7 @@ static void button_event_handler(uint8_t pin_no, uint8_t button_action)
 #endif
 			//			err_code = sd_ble_gatts_hvx();
 
-			if (m_conn_handle != BLE_CONN_HANDLE_INVALID)
+			if (ble_conn_state_peripheral_conn_count() > 0)
 			{
 //				err_code = acelerometer_value_update(&m_cus, encoded_temperature, sizeof(encoded_temperature));
 //				APP_ERROR_CHECK(err_code);
@@ -800,13 +2389,12 @@ static void button_event_handler(uint8_t pin_no, uint8_t button_action)
 			if (bsp_board_led_state_get(BSP_BOARD_LED_2))
 			{
 				bsp_board_led_off(BSP_BOARD_LED_2);
-				NRF_I2S->TASKS_STOP = 1;
+				sound_stop();
 			}
 			else
 			{
-				NRF_I2S->TASKS_STOP = 1;
-				bsp_board_led_on(BSP_BOARD_LED_2);	
 				sound_cuica_start();						
+				bsp_board_led_on(BSP_BOARD_LED_2);	
 			} 
 		}
 		else if (button_action == APP_BUTTON_RELEASE) 
@@ -823,13 +2411,12 @@ static void button_event_handler(uint8_t pin_no, uint8_t button_action)
 			if (bsp_board_led_state_get(BSP_BOARD_LED_3))
 			{
 				bsp_board_led_off(BSP_BOARD_LED_3);
-				NRF_I2S->TASKS_STOP = 1;
+				sound_stop();
 			}
 			else
 			{
-				NRF_I2S->TASKS_STOP = 1;
+				sound_claves_start();		
 				bsp_board_led_on(BSP_BOARD_LED_3);
-					sound_claves_start();		
 			} 
 #ifdef UART_PRINTING_ENABLED
 			NRF_LOG_INFO("button4 pressed.");
@@ -989,6 +2576,19 @@ static void idle_state_handle(void)
 }
 
 
+/**@brief Function for freeing every entry of the link table.
+ */
+static void links_init(void)
+{
+	uint8_t i;
+
+	for (i = 0; i < NRF_SDH_BLE_PERIPHERAL_LINK_COUNT; i++)
+	{
+		m_links[i].conn_handle = BLE_CONN_HANDLE_INVALID;
+		m_links[i].acel_notify = false;
+	}
+}
+
 /**@brief Function for starting advertising.
  */
 static void advertising_start(bool erase_bonds)
@@ -1010,21 +2610,21 @@ static void advertising_start(bool erase_bonds)
 	*/
 void set_play_sound_condition(uint8_t data)
 {
-	bsp_board_leds_off();
 	switch (data)
 		{
 		case 0x00:
-			NRF_I2S->TASKS_STOP = 1;
+			bsp_board_leds_off();
+			sound_stop();
 			break;
 		case 0x01:
-			NRF_I2S->TASKS_STOP = 1;
-			bsp_board_led_on(BSP_BOARD_LED_2);	
 			sound_cuica_start();						
+			bsp_board_leds_off();
+			bsp_board_led_on(BSP_BOARD_LED_2);	
 			break;
 		case 0x02:
-			NRF_I2S->TASKS_STOP = 1;
-			bsp_board_led_on(BSP_BOARD_LED_3);
 			sound_claves_start();		
+			bsp_board_leds_off();
+			bsp_board_led_on(BSP_BOARD_LED_3);
 			break;
 		default:
 			break;
@@ -1035,7 +2635,8 @@ void set_play_sound_condition(uint8_t data)
  */
 int main(void)
 {
-	bool erase_bonds;
+	bool       erase_bonds;
+	ret_code_t err_code;
 
 	// Initialize.
 	log_init();
@@ -1048,9 +2649,21 @@ int main(void)
 	gap_params_init();
 	gatt_init();
 	services_init();
+	links_init();
+	command_init(m_commands, ARRAY_SIZE(m_commands), command_ack_send);
+	notify_queue_init(acel_frame_send);
+	l2cap_channel_init(on_l2cap_evt);
+	beacon_init();
+	broadcast_init();
+	stream_frame_tx_init(&m_acel_stream, STREAM_ID_ACEL_NOTIFY);
+	stream_frame_tx_init(&m_burst_stream, STREAM_ID_ACEL_BURST);
+	acel_frame_reset();
 	advertising_init();
 	conn_params_init();
 	peer_manager_init();
+
+	err_code = clip_store_init(on_clip_store_evt);
+	APP_ERROR_CHECK(err_code);
  
  // I2C Init
  	I2C_init();
@@ -1060,7 +2673,11 @@ int main(void)
 		nrf_delay_ms(500);
 			BMA280_Calibrate();
 				nrf_delay_ms(500);
-	I2S_init();
+	// suspended until a gesture rule or a client needs the samples
+	BMA280_Turn_Off();
+	// the I2S powers up on the first sound and down again I2S_DRAIN_MS after the last one
+	I2S_init(on_sound_evt);
+	gesture_init(on_gesture);
 
 	// Start execution.
 	NRF_LOG_INFO("Template example started.");
@@ -1071,6 +2688,13 @@ int main(void)
 	// Enter main loop.
 	for(;  ;)
 	{
+		device_time_update();
+		acel_acquisition_process();
+		gesture_sample_process();
+		link_bench_process();
+		broadcast_process();
+		beacon_process();
+		sound_process();
 		idle_state_handle();
 	}
 }
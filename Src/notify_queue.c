@@ -0,0 +1,271 @@
+#include <string.h>
+#include "notify_queue.h"
+#include "nordic_common.h"
+#include "sdk_errors.h"
+#include "app_util_platform.h"
+
+#define NOTIFY_QUEUE_MASK         (NOTIFY_QUEUE_FRAMES - 1)
+#define NOTIFY_QUEUE_LINK_FREE    0xFFFF                    // BLE_CONN_HANDLE_INVALID
+
+#if (NOTIFY_QUEUE_FRAMES & NOTIFY_QUEUE_MASK) != 0
+#error "NOTIFY_QUEUE_FRAMES must be a power of two"
+#endif
+
+typedef struct
+{
+	uint16_t  length;
+	uint8_t   data[NOTIFY_QUEUE_FRAME_MAX];
+} notify_frame_t;
+
+typedef struct
+{
+	uint16_t           conn_handle;                     // NOTIFY_QUEUE_LINK_FREE for a free entry
+	volatile uint32_t  tail;                            // frames sent or dropped on this connection
+	volatile bool      sending;                         // a context is in link_send() for this connection
+	volatile bool      again;                           // another context wanted to send meanwhile
+} notify_link_t;
+
+static notify_frame_t      m_frames[NOTIFY_QUEUE_FRAMES];
+static volatile uint32_t   m_head;                          // frames put
+static notify_link_t       m_links[NOTIFY_QUEUE_LINKS];
+static notify_queue_send_t m_send;
+static notify_queue_stats_t m_stats;
+
+static notify_link_t * link_find(uint16_t conn_handle)
+{
+	uint32_t i;
+
+	for (i = 0; i < NOTIFY_QUEUE_LINKS; i++)
+	{
+		if (m_links[i].conn_handle == conn_handle)
+		{
+			return &m_links[i];
+		}
+	}
+	return NULL;
+}
+
+/*@brief Send the waiting frames of one connection until its TX slots are full
+ *
+ * The critical regions only guard the cursors, the SoftDevice calls run outside them so the I2S
+ * refill is not held up. A context that finds the connection being sent on leaves its frames to
+ * that sender, which goes on after a full TX queue if a TX complete came meanwhile.
+*/
+static void link_send(notify_link_t * p_link)
+{
+	notify_frame_t * p_frame;
+	uint32_t         err_code = NRF_SUCCESS;
+	uint32_t         tail;
+	uint16_t         conn_handle;
+	bool             owner;
+
+	CRITICAL_REGION_ENTER();
+
+	owner           = !p_link->sending;
+	p_link->sending = true;
+	p_link->again   = !owner;
+
+	CRITICAL_REGION_EXIT();
+
+	while (owner)
+	{
+		CRITICAL_REGION_ENTER();
+
+		if ((p_link->tail == m_head) || (p_link->conn_handle == NOTIFY_QUEUE_LINK_FREE) ||
+		    ((err_code == NRF_ERROR_RESOURCES) && !p_link->again))
+		{
+			p_link->sending = false;
+			owner           = false;
+		}
+		tail          = p_link->tail;
+		conn_handle   = p_link->conn_handle;
+		p_link->again = false;
+
+		CRITICAL_REGION_EXIT();
+
+		if (!owner)
+		{
+			break;
+		}
+
+		p_frame  = &m_frames[tail & NOTIFY_QUEUE_MASK];
+		err_code = m_send(conn_handle, p_frame->data, p_frame->length);
+
+		CRITICAL_REGION_ENTER();
+
+		// done with the frame, unless the connection went or was added afresh meanwhile
+		if ((err_code != NRF_ERROR_RESOURCES) && (p_link->tail == tail))
+		{
+			if (err_code == NRF_SUCCESS)
+			{
+				m_stats.sent++;
+			}
+			else
+			{
+				m_stats.dropped++;
+			}
+			p_link->tail++;
+		}
+
+		CRITICAL_REGION_EXIT();
+	}
+}
+
+void notify_queue_init(notify_queue_send_t send)
+{
+	uint32_t i;
+
+	m_send = send;
+	m_head = 0;
+	for (i = 0; i < NOTIFY_QUEUE_LINKS; i++)
+	{
+		m_links[i].conn_handle = NOTIFY_QUEUE_LINK_FREE;
+		m_links[i].tail        = 0;
+		m_links[i].sending     = false;
+		m_links[i].again       = false;
+	}
+	memset(&m_stats, 0, sizeof(m_stats));
+}
+
+bool notify_queue_link_add(uint16_t conn_handle)
+{
+	notify_link_t * p_link;
+	bool            added = true;
+
+	CRITICAL_REGION_ENTER();
+
+	if (link_find(conn_handle) == NULL)
+	{
+		p_link = link_find(NOTIFY_QUEUE_LINK_FREE);
+		if (p_link != NULL)
+		{
+			p_link->tail        = m_head;
+			p_link->conn_handle = conn_handle;
+		}
+		else
+		{
+			added = false;
+		}
+	}
+
+	CRITICAL_REGION_EXIT();
+	return added;
+}
+
+void notify_queue_link_remove(uint16_t conn_handle)
+{
+	notify_link_t * p_link;
+
+	CRITICAL_REGION_ENTER();
+
+	p_link = link_find(conn_handle);
+	if (p_link != NULL)
+	{
+		m_stats.dropped    += m_head - p_link->tail;
+		p_link->conn_handle = NOTIFY_QUEUE_LINK_FREE;
+	}
+
+	CRITICAL_REGION_EXIT();
+}
+
+bool notify_queue_put(uint8_t const * p_data, uint16_t length)
+{
+	uint32_t depth = 0;
+	uint32_t links = 0;
+	uint32_t i;
+
+	if (length > NOTIFY_QUEUE_FRAME_MAX)
+	{
+		m_stats.dropped++;
+		return false;
+	}
+
+	// the slot at the head is free once every connection is less than a queue behind, the
+	// TX complete handler only moves the tails forward
+	CRITICAL_REGION_ENTER();
+
+	for (i = 0; i < NOTIFY_QUEUE_LINKS; i++)
+	{
+		notify_link_t * p_link = &m_links[i];
+
+		if (p_link->conn_handle == NOTIFY_QUEUE_LINK_FREE)
+		{
+			continue;
+		}
+		links++;
+
+		if (m_head - p_link->tail >= NOTIFY_QUEUE_FRAMES)
+		{
+			p_link->tail++;
+			m_stats.dropped++;
+		}
+		depth = MAX(depth, m_head - p_link->tail + 1);
+	}
+
+	CRITICAL_REGION_EXIT();
+
+	if (links == 0)
+	{
+		return false;
+	}
+
+	m_frames[m_head & NOTIFY_QUEUE_MASK].length = length;
+	memcpy(m_frames[m_head & NOTIFY_QUEUE_MASK].data, p_data, length);
+	m_head++;
+
+	m_stats.queued++;
+	m_stats.high_water = MAX(m_stats.high_water, (uint8_t)depth);
+
+	// one copy, sent on every connection, one connection at a time
+	for (i = 0; i < NOTIFY_QUEUE_LINKS; i++)
+	{
+		if ((m_send != NULL) && (m_links[i].conn_handle != NOTIFY_QUEUE_LINK_FREE))
+		{
+			link_send(&m_links[i]);
+		}
+	}
+	return true;
+}
+
+void notify_queue_send(uint16_t conn_handle)
+{
+	notify_link_t * p_link;
+
+	if (m_send == NULL)
+	{
+		return;
+	}
+
+	// the main loop and the BLE event handler both send, link_send() takes turns
+	CRITICAL_REGION_ENTER();
+
+	p_link = link_find(conn_handle);
+
+	CRITICAL_REGION_EXIT();
+
+	if (p_link != NULL)
+	{
+		link_send(p_link);
+	}
+}
+
+void notify_queue_stats_get(notify_queue_stats_t * p_stats)
+{
+	uint32_t i;
+
+	CRITICAL_REGION_ENTER();
+
+	*p_stats       = m_stats;
+	p_stats->depth = 0;
+	p_stats->links = 0;
+	for (i = 0; i < NOTIFY_QUEUE_LINKS; i++)
+	{
+		if (m_links[i].conn_handle != NOTIFY_QUEUE_LINK_FREE)
+		{
+			p_stats->depth = MAX(p_stats->depth, (uint8_t)(m_head - m_links[i].tail));
+			p_stats->links++;
+		}
+	}
+
+	CRITICAL_REGION_EXIT();
+}
@@ -0,0 +1,280 @@
+#include <string.h>
+#include "output_dsp.h"
+
+#define OUTPUT_DSP_LOOKAHEAD_MASK   (OUTPUT_DSP_LOOKAHEAD - 1)
+#define OUTPUT_DSP_LOOKAHEAD_SHIFT  5                          // log2(OUTPUT_DSP_LOOKAHEAD)
+#define OUTPUT_DSP_POST_SHIFT_MAX   3
+
+/*@brief Biquad stage with its direct form I delay line
+*/
+typedef struct
+{
+	int32_t   b0, b1, b2, a1, a2;
+	uint32_t  shift;                                       // 15 - post_shift
+	int32_t   x1, x2, y1, y2;
+} biquad_t;
+
+/*@brief Look-ahead limiter
+ *
+ * @details Every sample asks for the gain that brings it to the threshold when it enters the delay
+ *          line. The gain reaches it by the time the sample leaves, holds while louder samples are
+ *          in the delay line, then recovers exponentially.
+*/
+typedef struct
+{
+	int32_t   delay[OUTPUT_DSP_LOOKAHEAD];
+	uint32_t  index;
+	uint32_t  threshold;
+	uint32_t  gain;                                        // q16, applied to the sample leaving the delay line
+	uint32_t  target;                                      // q16, lowest gain asked for by the samples in the delay line
+	uint32_t  step;                                        // gain decrease per sample while attacking
+	uint32_t  hold;                                        // samples before the target is released
+	uint32_t  release;                                     // q16 share of the distance to the target recovered per sample
+	uint32_t  gain_min;
+	bool      enabled;
+} limiter_t;
+
+/* 2nd order Butterworth high-pass at 180 Hz for I2S_SAMPLE_RATE (23810 Hz), keeps the bass a small
+ * speaker cannot move out of the amplifier.
+ */
+static const output_dsp_biquad_t m_default_highpass =
+{
+	.coeffs     = { 15843, 0, -31686, 15843, 31668, -15320 },
+	.post_shift = 1,
+};
+
+static biquad_t  m_biquads[OUTPUT_DSP_STAGES_MAX];
+static uint8_t   m_stages;
+static limiter_t m_limiter;
+static uint32_t  m_sample_rate;
+
+void output_dsp_init(uint32_t sample_rate)
+{
+	output_dsp_limiter_t limiter =
+	{
+		.enabled    = true,
+		.threshold  = 32112,                               // -0.2 dBFS
+		.release_ms = 80,
+	};
+
+	m_sample_rate = sample_rate;
+	m_stages      = 0;
+
+	memset(&m_limiter, 0, sizeof(m_limiter));
+	m_limiter.gain     = OUTPUT_DSP_GAIN_UNITY;
+	m_limiter.target   = OUTPUT_DSP_GAIN_UNITY;
+	m_limiter.gain_min = OUTPUT_DSP_GAIN_UNITY;
+
+	(void)output_dsp_biquad_set(0, &m_default_highpass);
+	output_dsp_limiter_set(&limiter);
+}
+
+bool output_dsp_biquad_set(uint8_t stage, output_dsp_biquad_t const * p_biquad)
+{
+	biquad_t * p_stage;
+
+	if ((stage >= OUTPUT_DSP_STAGES_MAX) || (stage > m_stages))
+	{
+		return false;
+	}
+
+	if (p_biquad == NULL)
+	{
+		m_stages = stage;
+		return true;
+	}
+
+	if (p_biquad->post_shift > OUTPUT_DSP_POST_SHIFT_MAX)
+	{
+		return false;
+	}
+
+	p_stage = &m_biquads[stage];
+	memset(p_stage, 0, sizeof(*p_stage));
+	p_stage->b0    = p_biquad->coeffs[0];
+	p_stage->b1    = p_biquad->coeffs[2];
+	p_stage->b2    = p_biquad->coeffs[3];
+	p_stage->a1    = p_biquad->coeffs[4];
+	p_stage->a2    = p_biquad->coeffs[5];
+	p_stage->shift = 15 - p_biquad->post_shift;
+
+	if (stage == m_stages)
+	{
+		m_stages++;
+	}
+
+	return true;
+}
+
+void output_dsp_limiter_set(output_dsp_limiter_t const * p_limiter)
+{
+	uint32_t samples = ((uint32_t)p_limiter->release_ms * m_sample_rate) / 1000;
+
+	m_limiter.enabled   = p_limiter->enabled && (p_limiter->threshold > 0);
+	m_limiter.threshold = (p_limiter->threshold > 0x7FFF) ? 0x7FFF : p_limiter->threshold;
+	m_limiter.release   = OUTPUT_DSP_GAIN_UNITY / ((samples == 0) ? 1 : samples);
+	if (m_limiter.release == 0)
+	{
+		m_limiter.release = 1;
+	}
+}
+
+/*@brief Run one biquad stage over a buffer, the delay line stays in registers
+*/
+static void biquad_process(biquad_t * p_stage, int32_t * p_samples, uint32_t count)
+{
+	int32_t  b0 = p_stage->b0, b1 = p_stage->b1, b2 = p_stage->b2;
+	int32_t  a1 = p_stage->a1, a2 = p_stage->a2;
+	int32_t  x1 = p_stage->x1, x2 = p_stage->x2;
+	int32_t  y1 = p_stage->y1, y2 = p_stage->y2;
+	uint32_t shift = p_stage->shift;
+	uint32_t i;
+
+	for (i = 0; i < count; i++)
+	{
+		int32_t x = p_samples[i];
+
+		// 64-bit accumulator (SMLAL), 17 bits of mix headroom times q15 coefficients
+		int64_t acc = (int64_t)b0 * x + (int64_t)b1 * x1 + (int64_t)b2 * x2 +
+		              (int64_t)a1 * y1 + (int64_t)a2 * y2;
+		int32_t y   = (int32_t)(acc >> shift);
+
+		x2 = x1;
+		x1 = x;
+		y2 = y1;
+		y1 = y;
+		p_samples[i] = y;
+	}
+
+	p_stage->x1 = x1;
+	p_stage->x2 = x2;
+	p_stage->y1 = y1;
+	p_stage->y2 = y2;
+}
+
+/*@brief Limit one buffer, the output is delayed by OUTPUT_DSP_LOOKAHEAD samples
+*/
+static void limiter_process(limiter_t * p_lim, int32_t * p_samples, uint32_t count)
+{
+	uint32_t threshold = p_lim->threshold;
+	uint32_t gain      = p_lim->gain;
+	uint32_t target    = p_lim->target;
+	uint32_t step      = p_lim->step;
+	uint32_t hold      = p_lim->hold;
+	uint32_t index     = p_lim->index;
+	uint32_t gain_min  = p_lim->gain_min;
+	uint32_t i;
+
+	for (i = 0; i < count; i++)
+	{
+		int32_t  x   = p_samples[i];
+		uint32_t mag = (uint32_t)((x < 0) ? -x : x);
+		int32_t  out;
+
+		if (mag > threshold)
+		{
+			// this sample leaves the delay line in OUTPUT_DSP_LOOKAHEAD samples, keep the gain down until then
+			hold = OUTPUT_DSP_LOOKAHEAD;
+
+			if ((uint64_t)mag * target > ((uint64_t)threshold << 16))
+			{
+				uint32_t need = (threshold << 16) / mag;
+
+				target = need;
+				if (gain > need)
+				{
+					uint32_t attack = (gain - need + OUTPUT_DSP_LOOKAHEAD_MASK) >> OUTPUT_DSP_LOOKAHEAD_SHIFT;
+
+					step = (attack > step) ? attack : step;
+				}
+			}
+		}
+		else if (hold > 0)
+		{
+			hold--;
+		}
+		else
+		{
+			target = OUTPUT_DSP_GAIN_UNITY;
+		}
+
+		if (gain > target)
+		{
+			gain = (gain - target > step) ? (gain - step) : target;
+		}
+		else
+		{
+			step  = 0;
+			gain += (((target - gain) * (uint64_t)p_lim->release) >> 16) + 1;
+			if (gain > target)
+			{
+				gain = target;
+			}
+		}
+
+		if (gain < gain_min)
+		{
+			gain_min = gain;
+		}
+
+		out = p_lim->delay[index];
+		p_lim->delay[index] = x;
+		index = (index + 1) & OUTPUT_DSP_LOOKAHEAD_MASK;
+
+		out = (int32_t)(((int64_t)out * gain) >> 16);
+		p_samples[i] = (out > 0x7FFF) ? 0x7FFF : ((out < -0x8000) ? -0x8000 : out);
+	}
+
+	p_lim->gain     = gain;
+	p_lim->target   = target;
+	p_lim->step     = step;
+	p_lim->hold     = hold;
+	p_lim->index    = index;
+	p_lim->gain_min = gain_min;
+}
+
+void output_dsp_process(int32_t * p_samples, uint32_t count)
+{
+	uint32_t i;
+
+	for (i = 0; i < m_stages; i++)
+	{
+		biquad_process(&m_biquads[i], p_samples, count);
+	}
+
+	if (m_limiter.enabled)
+	{
+		limiter_process(&m_limiter, p_samples, count);
+	}
+}
+
+uint32_t output_dsp_gain_get(void)
+{
+	return m_limiter.enabled ? m_limiter.gain : OUTPUT_DSP_GAIN_UNITY;
+}
+
+uint32_t output_dsp_gain_min_get(void)
+{
+	uint32_t gain_min = m_limiter.gain_min;
+
+	m_limiter.gain_min = OUTPUT_DSP_GAIN_UNITY;
+
+	return gain_min;
+}
+
+uint8_t output_dsp_stages_get(void)
+{
+	return m_stages;
+}
+
+uint32_t output_dsp_cycles_budget(uint32_t count)
+{
+	uint32_t per_sample = m_stages * OUTPUT_DSP_BIQUAD_CYCLES_PER_SAMPLE;
+
+	if (m_limiter.enabled)
+	{
+		per_sample += OUTPUT_DSP_LIMITER_CYCLES_PER_SAMPLE;
+	}
+
+	return per_sample * count;
+}
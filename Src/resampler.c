@@ -0,0 +1,197 @@
+#include "resampler.h"
+#include "resampler_taps.h"
+
+#if defined(__ARM_FEATURE_DSP)
+#include "nrf.h"
+#endif
+
+#define RESAMPLER_FRAC_BITS     16
+#define RESAMPLER_PHASE_SHIFT   (RESAMPLER_FRAC_BITS - 7)  // 128 phases
+
+#if (1 << (RESAMPLER_FRAC_BITS - RESAMPLER_PHASE_SHIFT)) != RESAMPLER_PHASES
+#error "RESAMPLER_PHASE_SHIFT does not match RESAMPLER_PHASES"
+#endif
+
+bool resampler_init(resampler_t * p_rs, uint32_t rate_in, uint32_t rate_out)
+{
+	if ((rate_out == 0) || (rate_in > rate_out * RESAMPLER_RATIO_MAX))
+	{
+		return false;
+	}
+
+	p_rs->index    = 0;
+	p_rs->frac     = 0;
+	p_rs->step     = (uint32_t)((((uint64_t)rate_in << RESAMPLER_FRAC_BITS) + rate_out / 2) / rate_out);
+	p_rs->p_taps   = (rate_in <= rate_out) ? &resampler_taps_up[0][0] : &resampler_taps_down2[0][0];
+
+	return true;
+}
+
+/*@brief One output sample, all taps inside the input
+*/
+static inline int32_t fir(int16_t const * p_x, int16_t const * p_h)
+{
+	int32_t  acc = 0;
+	uint32_t j;
+
+#if defined(__ARM_FEATURE_DSP)
+	// two taps per SMLAD, the input pointer may be on an odd sample
+	for (j = 0; j < RESAMPLER_TAPS; j += 2)
+	{
+		acc = (int32_t)__SMLAD(__UNALIGNED_UINT32_READ(&p_x[j]), __UNALIGNED_UINT32_READ(&p_h[j]), (uint32_t)acc);
+	}
+#else
+	for (j = 0; j < RESAMPLER_TAPS; j++)
+	{
+		acc += (int32_t)p_x[j] * p_h[j];
+	}
+#endif
+
+	return acc;
+}
+
+/*@brief One output sample near the ends of the input, missing samples are silence
+*/
+static int32_t fir_edge(int16_t const * p_in, uint32_t length, int32_t first, int16_t const * p_h)
+{
+	int32_t  acc = 0;
+	uint32_t j;
+
+	for (j = 0; j < RESAMPLER_TAPS; j++)
+	{
+		int32_t n = first + (int32_t)j;
+
+		if ((n >= 0) && (n < (int32_t)length))
+		{
+			acc += (int32_t)p_in[n] * p_h[j];
+		}
+	}
+
+	return acc;
+}
+
+uint32_t resampler_process(resampler_t * p_rs, int16_t const * p_in, uint32_t length, int16_t * p_out, uint32_t count)
+{
+	uint32_t base = p_rs->index;
+	uint32_t frac = p_rs->frac;
+	uint32_t i;
+
+	for (i = 0; i < count; i++)
+	{
+		if (base >= length)
+		{
+			break;
+		}
+
+		// nearest phase, row RESAMPLER_PHASES is row 0 one sample later
+		uint32_t        phase = (frac + (1 << (RESAMPLER_PHASE_SHIFT - 1))) >> RESAMPLER_PHASE_SHIFT;
+		int16_t const * p_h   = &p_rs->p_taps[phase * RESAMPLER_TAPS];
+		int32_t         first = (int32_t)base - RESAMPLER_HISTORY;
+		int32_t         acc;
+
+		if ((first >= 0) && (first + RESAMPLER_TAPS <= (int32_t)length))
+		{
+			acc = fir(&p_in[first], p_h);
+		}
+		else
+		{
+			acc = fir_edge(p_in, length, first, p_h);
+		}
+
+		acc >>= RESAMPLER_COEF_SHIFT;
+		p_out[i] = (int16_t)((acc > INT16_MAX) ? INT16_MAX : ((acc < INT16_MIN) ? INT16_MIN : acc));
+
+		frac += p_rs->step;
+		base += frac >> RESAMPLER_FRAC_BITS;
+		frac &= (1 << RESAMPLER_FRAC_BITS) - 1;
+	}
+
+	p_rs->index = base;
+	p_rs->frac  = frac;
+
+	return i;
+}
+
+/*@brief One output sample reading across the loop point, samples past the loop end come from the loop start
+*/
+static int32_t fir_loop(int16_t const * p_in, uint32_t loop_start, uint32_t loop_end, int32_t first, int16_t const * p_h)
+{
+	int32_t  span = (int32_t)(loop_end - loop_start);
+	int32_t  acc  = 0;
+	uint32_t j;
+
+	for (j = 0; j < RESAMPLER_TAPS; j++)
+	{
+		int32_t n = first + (int32_t)j;
+
+		while (n >= (int32_t)loop_end)
+		{
+			n -= span;
+		}
+		if (n >= 0)
+		{
+			acc += (int32_t)p_in[n] * p_h[j];
+		}
+	}
+
+	return acc;
+}
+
+void resampler_process_loop(resampler_t * p_rs, int16_t const * p_in, uint32_t loop_start, uint32_t loop_end,
+                            int16_t * p_out, uint32_t count)
+{
+	uint32_t base = p_rs->index;
+	uint32_t frac = p_rs->frac;
+	uint32_t i;
+
+	for (i = 0; i < count; i++)
+	{
+		while (base >= loop_end)
+		{
+			base -= loop_end - loop_start;
+		}
+
+		uint32_t        phase = (frac + (1 << (RESAMPLER_PHASE_SHIFT - 1))) >> RESAMPLER_PHASE_SHIFT;
+		int16_t const * p_h   = &p_rs->p_taps[phase * RESAMPLER_TAPS];
+		int32_t         first = (int32_t)base - RESAMPLER_HISTORY;
+		int32_t         acc;
+
+		if ((first >= 0) && (first + RESAMPLER_TAPS <= (int32_t)loop_end))
+		{
+			acc = fir(&p_in[first], p_h);
+		}
+		else
+		{
+			acc = fir_loop(p_in, loop_start, loop_end, first, p_h);
+		}
+
+		acc >>= RESAMPLER_COEF_SHIFT;
+		p_out[i] = (int16_t)((acc > INT16_MAX) ? INT16_MAX : ((acc < INT16_MIN) ? INT16_MIN : acc));
+
+		frac += p_rs->step;
+		base += frac >> RESAMPLER_FRAC_BITS;
+		frac &= (1 << RESAMPLER_FRAC_BITS) - 1;
+	}
+
+	p_rs->index = base;
+	p_rs->frac  = frac;
+}
+
+uint32_t resampler_output_available(resampler_t const * p_rs, uint32_t length)
+{
+	uint32_t span;
+
+	if (length <= RESAMPLER_LOOKAHEAD)
+	{
+		return 0;
+	}
+
+	// output k reads up to index + ((frac + k * step) >> 16) + RESAMPLER_LOOKAHEAD
+	span = (length - RESAMPLER_LOOKAHEAD - 1) << RESAMPLER_FRAC_BITS;
+	if (span < p_rs->frac)
+	{
+		return 0;
+	}
+
+	return (span - p_rs->frac) / p_rs->step + 1;
+}
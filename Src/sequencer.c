@@ -0,0 +1,112 @@
+#include <string.h>
+#include "sequencer.h"
+
+#define SEQUENCER_HEADER_LEN    3
+#define SEQUENCER_STEP_LEN      2
+
+static sequencer_step_t m_steps[SEQUENCER_MAX_STEPS];
+static uint8_t          m_count;
+static uint8_t          m_index;                            // next step to start
+static uint32_t         m_period;                           // samples per loop
+static uint32_t         m_loop_start;                       // output timeline position of the current loop
+static uint8_t          m_loops_left;                       // 0 loops forever
+static bool             m_active;
+
+bool sequencer_load(uint8_t const * p_data, uint16_t length, uint32_t sample_rate, uint32_t start)
+{
+	sequencer_step_t steps[SEQUENCER_MAX_STEPS];
+	uint32_t         ticks = 0;
+	uint32_t         tick_ms;
+	uint8_t          count = 0;
+	uint16_t         i;
+
+	if ((length < SEQUENCER_HEADER_LEN + SEQUENCER_STEP_LEN) ||
+	    (((length - SEQUENCER_HEADER_LEN) % SEQUENCER_STEP_LEN) != 0))
+	{
+		return false;
+	}
+
+	tick_ms = p_data[1] | ((uint32_t)p_data[2] << 8);
+
+	for (i = SEQUENCER_HEADER_LEN; i < length; i += SEQUENCER_STEP_LEN)
+	{
+		uint8_t clip_id  = p_data[i + 1] >> 4;
+		uint8_t velocity = p_data[i + 1] & 0x0F;
+
+		ticks += p_data[i];
+
+		if (clip_id == 0)
+		{
+			continue;
+		}
+
+		if (count == SEQUENCER_MAX_STEPS)
+		{
+			return false;
+		}
+
+		// from the absolute time so rounding never accumulates over the pattern
+		steps[count].offset  = (uint32_t)(((uint64_t)ticks * tick_ms * sample_rate) / 1000);
+		steps[count].gain    = (uint16_t)(((uint32_t)velocity * 0x7FFF) / 15);
+		steps[count].clip_id = clip_id;
+		count++;
+	}
+
+	uint32_t period = (uint32_t)(((uint64_t)ticks * tick_ms * sample_rate) / 1000);
+
+	if ((count == 0) || (period == 0))
+	{
+		return false;
+	}
+
+	memcpy(m_steps, steps, count * sizeof(steps[0]));
+	m_count      = count;
+	m_index      = 0;
+	m_period     = period;
+	m_loop_start = start;
+	m_loops_left = p_data[0];
+	m_active     = true;
+
+	return true;
+}
+
+void sequencer_stop(void)
+{
+	m_active = false;
+}
+
+bool sequencer_active(void)
+{
+	return m_active;
+}
+
+bool sequencer_process(uint32_t timeline, uint32_t count, sequencer_trigger_t trigger)
+{
+	while (m_active)
+	{
+		sequencer_step_t const * p_step = &m_steps[m_index];
+		int32_t                  delay  = (int32_t)(m_loop_start + p_step->offset - timeline);
+
+		if (delay >= (int32_t)count)
+		{
+			break;
+		}
+
+		// a step can only be late if it was loaded behind the render position
+		trigger(p_step->clip_id, p_step->gain, (delay > 0) ? (uint32_t)delay : 0);
+
+		if (++m_index == m_count)
+		{
+			m_index       = 0;
+			m_loop_start += m_period;
+
+			if ((m_loops_left != SEQUENCER_LOOP_FOREVER) && (--m_loops_left == 0))
+			{
+				m_active = false;
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
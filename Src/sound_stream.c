@@ -0,0 +1,285 @@
+#include <string.h>
+#include "sound_stream.h"
+#include "nordic_common.h"
+#include "adpcm.h"
+#include "resampler.h"
+#include "app_util_platform.h"
+#include "app_timer.h"
+
+#define SOUND_STREAM_MASK         (SOUND_STREAM_BUFFER_SAMPLES - 1)
+#define SOUND_STREAM_FRAME_MAX    512                       // samples in one frame, 244 byte ADPCM payload
+#define SOUND_STREAM_CHUNK        128                       // output samples converted at once
+#define SOUND_STREAM_WINDOW       (SOUND_STREAM_CHUNK * RESAMPLER_RATIO_MAX + RESAMPLER_TAPS + 1)
+#define SOUND_STREAM_MARGIN_STEP  128                       // depth added after an underrun, samples
+
+#if (SOUND_STREAM_BUFFER_SAMPLES & SOUND_STREAM_MASK) != 0
+#error "SOUND_STREAM_BUFFER_SAMPLES must be a power of two"
+#endif
+
+static int16_t           m_ring[SOUND_STREAM_BUFFER_SAMPLES];
+static volatile uint32_t m_head;                            // samples written
+static volatile uint32_t m_tail;                            // base sample of the next output, RESAMPLER_HISTORY kept before it
+static resampler_t       m_rs;
+static volatile sound_stream_state_t m_state = SOUND_STREAM_CLOSED;
+
+static int16_t           m_frame[SOUND_STREAM_FRAME_MAX];   // decoded frame, producer side
+static int16_t           m_window[SOUND_STREAM_WINDOW];     // linear copy for the resampler, consumer side
+
+static uint32_t          m_rate;
+static uint8_t           m_seq_next;
+static bool              m_seq_valid;
+static volatile bool     m_dry;                             // ran out while playing, the next frame is late
+static uint32_t          m_last_ticks;
+static uint32_t          m_elapsed_ticks;                   // RTC ticks since the first frame
+static uint32_t          m_received;                        // samples received since the first frame
+static int32_t           m_offset_min;                      // earliest arrival seen, samples
+static uint32_t          m_jitter;                          // decaying peak of the arrival lateness, samples
+static uint32_t          m_margin;                          // depth added by underruns, samples
+static uint32_t          m_target;
+static sound_stream_stats_t m_stats;
+
+bool sound_stream_open(uint32_t sample_rate, uint32_t output_rate)
+{
+	resampler_t rs;
+
+	if (!resampler_init(&rs, sample_rate, output_rate))
+	{
+		return false;
+	}
+
+	CRITICAL_REGION_ENTER();
+
+	// the first outputs read silence as history
+	memset(m_ring, 0, sizeof(m_ring));
+	m_head        = RESAMPLER_HISTORY;
+	m_tail        = RESAMPLER_HISTORY;
+	m_rs          = rs;
+	m_rate        = sample_rate;
+	m_seq_valid   = false;
+	m_dry         = false;
+	m_received    = 0;
+	m_jitter      = 0;
+	m_margin      = 0;
+	m_target      = SOUND_STREAM_DEPTH_MIN;
+	memset(&m_stats, 0, sizeof(m_stats));
+	m_state       = SOUND_STREAM_BUFFERING;
+
+	CRITICAL_REGION_EXIT();
+
+	return true;
+}
+
+void sound_stream_close(void)
+{
+	m_state = SOUND_STREAM_CLOSED;
+}
+
+/*@brief Playout depth from the arrival jitter of this frame
+ *
+ * @details A frame is late by how much its arrival trails the earliest arrival seen, both relative
+ *          to the stream's own sample clock. BLE delivers frames in bursts once per connection
+ *          interval, so the peak lateness is close to the interval and decays slowly when it shrinks.
+*/
+static void target_update(uint32_t samples)
+{
+	uint32_t now = app_timer_cnt_get();
+	int32_t  offset;
+	uint32_t late;
+
+	if (m_received == 0)
+	{
+		m_elapsed_ticks = 0;
+	}
+	else
+	{
+		m_elapsed_ticks += app_timer_cnt_diff_compute(now, m_last_ticks);
+	}
+	m_last_ticks = now;
+
+	offset = (int32_t)(((uint64_t)m_elapsed_ticks * m_rate) / APP_TIMER_CLOCK_FREQ) - (int32_t)m_received;
+	if ((m_received == 0) || (offset < m_offset_min))
+	{
+		m_offset_min = offset;
+	}
+	m_received += samples;
+
+	late     = (uint32_t)(offset - m_offset_min);
+	m_jitter = (late > m_jitter) ? late : (m_jitter - (m_jitter >> 6));
+	m_margin = m_margin - (m_margin >> 8);
+
+	m_target = SOUND_STREAM_DEPTH_MIN + m_jitter + m_margin;
+	m_target = MIN(m_target, SOUND_STREAM_BUFFER_SAMPLES / 2);
+}
+
+bool sound_stream_frame_put(uint8_t const * p_frame, uint16_t length)
+{
+	uint8_t  seq   = p_frame[0];
+	uint8_t  flags = p_frame[1];
+	uint32_t samples;
+	uint32_t space;
+	uint32_t head;
+	uint32_t i;
+
+	if ((m_state == SOUND_STREAM_CLOSED) || (length < SOUND_STREAM_HEADER_LEN))
+	{
+		return false;
+	}
+
+	if (m_seq_valid)
+	{
+		int8_t gap = (int8_t)(seq - m_seq_next);
+
+		if (gap < 0)
+		{
+			m_stats.late_frames++;
+			return false;
+		}
+		m_stats.lost_frames += gap;
+	}
+	m_seq_next  = seq + 1;
+	m_seq_valid = true;
+
+	length -= SOUND_STREAM_HEADER_LEN;
+	p_frame += SOUND_STREAM_HEADER_LEN;
+
+	if (flags & SOUND_STREAM_FLAG_PCM)
+	{
+		samples = MIN(length / 2, SOUND_STREAM_FRAME_MAX);
+		for (i = 0; i < samples; i++)
+		{
+			m_frame[i] = (int16_t)(p_frame[2 * i] | (p_frame[2 * i + 1] << 8));
+		}
+	}
+	else
+	{
+		adpcm_state_t state;
+
+		state.predictor  = (int16_t)(p_frame[-3] | (p_frame[-2] << 8));
+		state.step_index = p_frame[-1];
+		length           = MIN(length, SOUND_STREAM_FRAME_MAX / 2);
+		samples          = 2 * length;
+		adpcm_decode(&state, p_frame, length, m_frame);
+	}
+
+	head  = m_head;
+	space = SOUND_STREAM_BUFFER_SAMPLES - (head - m_tail + RESAMPLER_HISTORY);
+	if (samples > space)
+	{
+		m_stats.overflows++;
+		return false;
+	}
+
+	if (m_dry)
+	{
+		// its samples were due while the buffer was empty
+		m_dry = false;
+		m_stats.late_frames++;
+	}
+
+	for (i = 0; i < samples; i++)
+	{
+		m_ring[(head + i) & SOUND_STREAM_MASK] = m_frame[i];
+	}
+
+	// samples in place before the reader can see them
+	__sync_synchronize();
+	m_head = head + samples;
+
+	target_update(samples);
+
+	if (flags & SOUND_STREAM_FLAG_END)
+	{
+		CRITICAL_REGION_ENTER();
+		if (m_state != SOUND_STREAM_CLOSED)
+		{
+			m_state = SOUND_STREAM_DRAINING;
+		}
+		CRITICAL_REGION_EXIT();
+	}
+
+	return true;
+}
+
+/*@brief Convert up to SOUND_STREAM_CHUNK outputs from the ring
+ *
+ * @return Outputs written, short when the buffer runs out.
+*/
+static uint32_t chunk_read(int16_t * p_out, uint32_t count, bool draining)
+{
+	uint32_t tail      = m_tail;
+	uint32_t available = m_head - tail;
+	uint32_t length    = MIN(available, SOUND_STREAM_WINDOW - RESAMPLER_HISTORY);
+	uint32_t produced;
+	uint32_t i;
+
+	// the end of a draining stream is followed by silence, no look-ahead to wait for
+	if (!draining || (length < available))
+	{
+		count = MIN(count, resampler_output_available(&m_rs, length));
+	}
+
+	for (i = 0; i < RESAMPLER_HISTORY + length; i++)
+	{
+		m_window[i] = m_ring[(tail - RESAMPLER_HISTORY + i) & SOUND_STREAM_MASK];
+	}
+
+	m_rs.index = RESAMPLER_HISTORY;
+	produced   = resampler_process(&m_rs, m_window, RESAMPLER_HISTORY + length, p_out, count);
+	m_tail     = tail + (m_rs.index - RESAMPLER_HISTORY);
+
+	return produced;
+}
+
+bool sound_stream_read(int16_t * p_out, uint32_t count)
+{
+	uint32_t done = 0;
+
+	if (m_state == SOUND_STREAM_BUFFERING)
+	{
+		if ((m_head - m_tail) >= m_target)
+		{
+			m_state = SOUND_STREAM_PLAYING;
+		}
+	}
+
+	while ((done < count) && ((m_state == SOUND_STREAM_PLAYING) || (m_state == SOUND_STREAM_DRAINING)))
+	{
+		uint32_t chunk    = MIN(count - done, SOUND_STREAM_CHUNK);
+		uint32_t produced = chunk_read(&p_out[done], chunk, (m_state == SOUND_STREAM_DRAINING));
+
+		done += produced;
+
+		if (produced < chunk)
+		{
+			if (m_state == SOUND_STREAM_DRAINING)
+			{
+				m_state = SOUND_STREAM_CLOSED;
+			}
+			else
+			{
+				// buffer ran dry, wait for a deeper buffer before playing again
+				m_stats.underruns++;
+				m_margin += SOUND_STREAM_MARGIN_STEP;
+				m_dry     = true;
+				m_state   = SOUND_STREAM_BUFFERING;
+			}
+		}
+	}
+
+	memset(&p_out[done], 0, (count - done) * sizeof(p_out[0]));
+
+	return (done > 0) || (m_state != SOUND_STREAM_CLOSED);
+}
+
+void sound_stream_stats_get(sound_stream_stats_t * p_stats)
+{
+	CRITICAL_REGION_ENTER();
+
+	m_stats.state  = m_state;
+	m_stats.depth  = (uint16_t)(m_head - m_tail);
+	m_stats.target = (uint16_t)m_target;
+	m_stats.jitter = (uint16_t)m_jitter;
+	*p_stats       = m_stats;
+
+	CRITICAL_REGION_EXIT();
+}
@@ -0,0 +1,124 @@
+#include <string.h>
+#include "stream_frame.h"
+
+void stream_frame_tx_init(stream_frame_tx_t * p_tx, uint8_t stream_id)
+{
+	memset(p_tx, 0, sizeof(*p_tx));
+	p_tx->stream_id = stream_id;
+	p_tx->resumed   = STREAM_FRAME_FLAG_RESUMED;
+}
+
+void stream_frame_tx_resume(stream_frame_tx_t * p_tx)
+{
+	p_tx->resumed = STREAM_FRAME_FLAG_RESUMED;
+}
+
+void stream_frame_header_put(stream_frame_tx_t * p_tx, uint8_t encoding, uint32_t timestamp, uint16_t count, uint8_t * p_frame)
+{
+	p_frame[0] = p_tx->stream_id;
+	p_frame[1] = (uint8_t)((encoding & STREAM_FRAME_ENCODING_MASK) | p_tx->resumed);
+	p_frame[2] = (uint8_t)p_tx->sequence;
+	p_frame[3] = (uint8_t)(p_tx->sequence >> 8);
+	p_frame[4] = (uint8_t)timestamp;
+	p_frame[5] = (uint8_t)(timestamp >> 8);
+	p_frame[6] = (uint8_t)(timestamp >> 16);
+	p_frame[7] = (uint8_t)(timestamp >> 24);
+	p_frame[8] = (uint8_t)count;
+	p_frame[9] = (uint8_t)(count >> 8);
+
+	p_tx->sequence++;
+	p_tx->frames++;
+	p_tx->resumed = 0;
+}
+
+bool stream_frame_header_get(uint8_t const * p_frame, uint16_t length, stream_frame_header_t * p_header)
+{
+	if (length < STREAM_FRAME_HEADER_LEN)
+	{
+		return false;
+	}
+
+	p_header->stream_id = p_frame[0];
+	p_header->flags     = p_frame[1];
+	p_header->sequence  = (uint16_t)(p_frame[2] | (p_frame[3] << 8));
+	p_header->timestamp = (uint32_t)p_frame[4] | ((uint32_t)p_frame[5] << 8) | ((uint32_t)p_frame[6] << 16) | ((uint32_t)p_frame[7] << 24);
+	p_header->count     = (uint16_t)(p_frame[8] | (p_frame[9] << 8));
+	return true;
+}
+
+void stream_frame_rx_init(stream_frame_rx_t * p_rx)
+{
+	memset(p_rx, 0, sizeof(*p_rx));
+}
+
+stream_frame_rx_result_t stream_frame_rx_put(stream_frame_rx_t * p_rx, uint16_t sequence, uint16_t * p_missed)
+{
+	int16_t  ahead = (int16_t)(sequence - p_rx->newest);
+	uint32_t bit;
+
+	if (p_missed != NULL)
+	{
+		*p_missed = 0;
+	}
+
+	if (!p_rx->started || (ahead < -STREAM_FRAME_WINDOW))
+	{
+		stream_frame_rx_result_t result = p_rx->started ? STREAM_FRAME_RESYNC : STREAM_FRAME_NEXT;
+
+		// nothing before the first frame is missing
+		p_rx->resyncs += p_rx->started ? 1 : 0;
+		p_rx->started  = true;
+		p_rx->newest   = sequence;
+		p_rx->window   = 0xFFFFFFFF;
+		p_rx->frames++;
+		return result;
+	}
+
+	if (ahead > 0)
+	{
+		// the window moves on by ahead frames, the newest before goes into it as received
+		uint32_t missed = (uint32_t)ahead - 1;
+
+		if (ahead < STREAM_FRAME_WINDOW)
+		{
+			p_rx->window = (p_rx->window << ahead) | (1UL << (ahead - 1));
+		}
+		else
+		{
+			p_rx->window = (ahead == STREAM_FRAME_WINDOW) ? (1UL << (STREAM_FRAME_WINDOW - 1)) : 0;
+		}
+		p_rx->newest = sequence;
+		p_rx->frames++;
+
+		if (missed == 0)
+		{
+			return STREAM_FRAME_NEXT;
+		}
+		p_rx->lost += missed;
+		p_rx->gaps++;
+		if (p_missed != NULL)
+		{
+			*p_missed = (uint16_t)missed;
+		}
+		return STREAM_FRAME_GAP;
+	}
+
+	if (ahead == 0)
+	{
+		p_rx->duplicates++;
+		return STREAM_FRAME_DUPLICATE;
+	}
+
+	bit = 1UL << (-ahead - 1);
+	if (p_rx->window & bit)
+	{
+		p_rx->duplicates++;
+		return STREAM_FRAME_DUPLICATE;
+	}
+
+	p_rx->window |= bit;
+	p_rx->lost--;
+	p_rx->late++;
+	p_rx->frames++;
+	return STREAM_FRAME_LATE;
+}
@@ -0,0 +1,196 @@
+#include "synth.h"
+
+/* Sine table, one turn in 256 steps plus the wrap-around point for the interpolation */
+static const int16_t m_sine[257] =
+{
+         0,    804,   1608,   2410,   3212,   4011,   4808,   5602,
+      6393,   7179,   7962,   8739,   9512,  10278,  11039,  11793,
+     12539,  13279,  14010,  14732,  15446,  16151,  16846,  17530,
+     18204,  18868,  19519,  20159,  20787,  21403,  22005,  22594,
+     23170,  23731,  24279,  24811,  25329,  25832,  26319,  26790,
+     27245,  27683,  28105,  28510,  28898,  29268,  29621,  29956,
+     30273,  30571,  30852,  31113,  31356,  31580,  31785,  31971,
+     32137,  32285,  32412,  32521,  32609,  32678,  32728,  32757,
+     32767,  32757,  32728,  32678,  32609,  32521,  32412,  32285,
+     32137,  31971,  31785,  31580,  31356,  31113,  30852,  30571,
+     30273,  29956,  29621,  29268,  28898,  28510,  28105,  27683,
+     27245,  26790,  26319,  25832,  25329,  24811,  24279,  23731,
+     23170,  22594,  22005,  21403,  20787,  20159,  19519,  18868,
+     18204,  17530,  16846,  16151,  15446,  14732,  14010,  13279,
+     12539,  11793,  11039,  10278,   9512,   8739,   7962,   7179,
+      6393,   5602,   4808,   4011,   3212,   2410,   1608,    804,
+         0,   -804,  -1608,  -2410,  -3212,  -4011,  -4808,  -5602,
+     -6393,  -7179,  -7962,  -8739,  -9512, -10278, -11039, -11793,
+    -12539, -13279, -14010, -14732, -15446, -16151, -16846, -17530,
+    -18204, -18868, -19519, -20159, -20787, -21403, -22005, -22594,
+    -23170, -23731, -24279, -24811, -25329, -25832, -26319, -26790,
+    -27245, -27683, -28105, -28510, -28898, -29268, -29621, -29956,
+    -30273, -30571, -30852, -31113, -31356, -31580, -31785, -31971,
+    -32137, -32285, -32412, -32521, -32609, -32678, -32728, -32757,
+    -32767, -32757, -32728, -32678, -32609, -32521, -32412, -32285,
+    -32137, -31971, -31785, -31580, -31356, -31113, -30852, -30571,
+    -30273, -29956, -29621, -29268, -28898, -28510, -28105, -27683,
+    -27245, -26790, -26319, -25832, -25329, -24811, -24279, -23731,
+    -23170, -22594, -22005, -21403, -20787, -20159, -19519, -18868,
+    -18204, -17530, -16846, -16151, -15446, -14732, -14010, -13279,
+    -12539, -11793, -11039, -10278,  -9512,  -8739,  -7962,  -7179,
+     -6393,  -5602,  -4808,  -4011,  -3212,  -2410,  -1608,   -804,
+         0
+};
+
+/*@brief Convert milliseconds to envelope steps (sample pairs), at least one
+*/
+static uint32_t ms_to_pairs(uint32_t ms, uint32_t sample_rate)
+{
+	uint32_t pairs = (ms * sample_rate) / 2000;
+
+	return (pairs == 0) ? 1 : pairs;
+}
+
+/*@brief One oscillator sample for the given phase, q15
+*/
+static inline int32_t osc_sample(uint32_t phase, uint8_t waveform)
+{
+	int32_t x;
+
+	switch (waveform)
+	{
+	case SYNTH_WAVE_SQUARE:
+		return (phase & 0x80000000u) ? -16384 : 16384;
+
+	case SYNTH_WAVE_SAW:
+		return (int32_t)phase >> 17;
+
+	case SYNTH_WAVE_TRIANGLE:
+		x = (int32_t)(phase >> 16);
+		return (x < 32768) ? (x * 2 - 32768) : (98303 - x * 2);
+
+	default:
+		{
+			uint32_t index = phase >> 24;
+			int32_t  frac  = (int32_t)((phase >> 8) & 0xFFFF);
+			int32_t  a     = m_sine[index];
+
+			return a + (((m_sine[index + 1] - a) * frac) >> 16);
+		}
+	}
+}
+
+/*@brief Advance the envelope by one sample pair
+*/
+static inline void env_step(synth_voice_t * p_voice)
+{
+	switch (p_voice->stage)
+	{
+	case SYNTH_ENV_ATTACK:
+		p_voice->env += p_voice->attack_inc;
+		if (p_voice->env >= SYNTH_ENV_MAX)
+		{
+			p_voice->env   = SYNTH_ENV_MAX;
+			p_voice->stage = SYNTH_ENV_DECAY;
+		}
+		break;
+
+	case SYNTH_ENV_DECAY:
+		p_voice->env -= p_voice->decay_dec;
+		if (p_voice->env <= p_voice->sustain_level)
+		{
+			p_voice->env   = p_voice->sustain_level;
+			p_voice->stage = SYNTH_ENV_SUSTAIN;
+		}
+		break;
+
+	case SYNTH_ENV_SUSTAIN:
+		if (p_voice->hold != SYNTH_HOLD_FOREVER)
+		{
+			if (--p_voice->hold == 0)
+			{
+				p_voice->stage = SYNTH_ENV_RELEASE;
+			}
+		}
+		break;
+
+	case SYNTH_ENV_RELEASE:
+		p_voice->env -= p_voice->release_dec;
+		if (p_voice->env <= 0)
+		{
+			p_voice->env   = 0;
+			p_voice->stage = SYNTH_ENV_OFF;
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+void synth_voice_init(synth_voice_t * p_voice, synth_params_t const * p_params, uint32_t sample_rate)
+{
+	uint32_t attack  = ms_to_pairs(p_params->attack_ms, sample_rate);
+	uint32_t decay   = ms_to_pairs(p_params->decay_ms, sample_rate);
+	uint32_t release = ms_to_pairs(p_params->release_ms, sample_rate);
+	int32_t  sustain = ((int32_t)p_params->sustain << 8);
+
+	if (sustain > SYNTH_ENV_MAX)
+	{
+		sustain = SYNTH_ENV_MAX;
+	}
+
+	p_voice->phase         = 0;
+	p_voice->phase_inc     = (uint32_t)(((uint64_t)p_params->frequency << 32) / sample_rate);
+	p_voice->waveform      = (p_params->waveform < SYNTH_WAVE_COUNT) ? p_params->waveform : SYNTH_WAVE_SINE;
+	p_voice->stage         = SYNTH_ENV_ATTACK;
+	p_voice->env           = 0;
+	p_voice->attack_inc    = SYNTH_ENV_MAX / attack;
+	p_voice->decay_dec     = ((SYNTH_ENV_MAX - sustain) / decay) + 1;
+	p_voice->sustain_level = sustain;
+	p_voice->release_dec   = (SYNTH_ENV_MAX / release) + 1;
+
+	if (p_params->duration_ms == 0)
+	{
+		p_voice->hold = SYNTH_HOLD_FOREVER;
+	}
+	else
+	{
+		uint32_t total = ms_to_pairs(p_params->duration_ms, sample_rate);
+		p_voice->hold  = (total > attack + decay) ? (total - attack - decay) : 1;
+	}
+}
+
+void synth_voice_release(synth_voice_t * p_voice)
+{
+	if (p_voice->stage != SYNTH_ENV_OFF)
+	{
+		p_voice->stage = SYNTH_ENV_RELEASE;
+	}
+}
+
+bool synth_voice_mix(synth_voice_t * p_voice, int32_t * p_acc, uint32_t count, int32_t gain)
+{
+	uint32_t phase     = p_voice->phase;
+	uint32_t phase_inc = p_voice->phase_inc;
+	uint8_t  waveform  = p_voice->waveform;
+	uint32_t i;
+
+	for (i = 0; i < count; i += 2)
+	{
+		if (p_voice->stage == SYNTH_ENV_OFF)
+		{
+			break;
+		}
+
+		env_step(p_voice);
+
+		// envelope (q23 -> q15) times voice gain, once per pair
+		int32_t level = ((p_voice->env >> 8) * gain) >> 15;
+
+		p_acc[i]     += (osc_sample(phase, waveform) * level) >> 15;
+		phase        += phase_inc;
+		p_acc[i + 1] += (osc_sample(phase, waveform) * level) >> 15;
+		phase        += phase_inc;
+	}
+
+	p_voice->phase = phase;
+
+	return (p_voice->stage != SYNTH_ENV_OFF);
+}